@@ -1,5 +1,6 @@
 import UIKit
 import WebKit
+import SDWebImage
 
 class PostMessageCell: TextMessageCell {
     
@@ -10,6 +11,8 @@ class PostMessageCell: TextMessageCell {
     let expandImageView = UIImageView(image: R.image.conversation.ic_message_expand())
     let trailingInfoBackgroundView = TrailingInfoBackgroundView()
     
+    private var imageLoadingOperations: [SDWebImageCombinedOperation] = []
+    
     override func prepare() {
         messageContentView.addSubview(webView)
         messageContentView.addSubview(trailingInfoBackgroundView)
@@ -38,6 +41,8 @@ class PostMessageCell: TextMessageCell {
     override func prepareForReuse() {
         super.prepareForReuse()
         webView.evaluateJavaScript("document.body.remove()")
+        imageLoadingOperations.forEach { $0.cancel() }
+        imageLoadingOperations = []
     }
     
     override func render(viewModel: MessageViewModel) {
@@ -54,6 +59,7 @@ class PostMessageCell: TextMessageCell {
         if let viewModel = viewModel as? PostMessageViewModel {
             webView.frame = viewModel.webViewFrame
             webView.loadHTMLString(viewModel.html, baseURL: Bundle.main.bundleURL)
+            imageLoadingOperations = viewModel.loadImages(priority: .visible)
             trailingInfoBackgroundView.frame = viewModel.trailingInfoBackgroundFrame
             #if DEBUG_POST_LAYOUT
             textView.frame = viewModel.webViewFrame
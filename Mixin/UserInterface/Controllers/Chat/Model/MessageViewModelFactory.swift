@@ -27,17 +27,27 @@ class MessageViewModelFactory {
         }
         dates = cataloguedMessages.keys.sorted(by: <)
         
-        var viewModels = [String: [MessageViewModel]]()
+        // Posts are measured with TextKit, prepare all of them concurrently before laying out in order
+        var styledViewModels = [(date: String, viewModel: MessageViewModel, style: MessageViewModel.Style)]()
         for date in dates {
             let messages = cataloguedMessages[date] ?? []
             for (row, message) in messages.enumerated() {
                 let style = self.style(forIndex: row, messages: messages)
-                let viewModel = self.viewModel(withMessage: message, style: style, fits: layoutWidth)
-                if viewModels[date] != nil {
-                    viewModels[date]!.append(viewModel)
-                } else {
-                    viewModels[date] = [viewModel]
+                let viewModel = self.viewModel(withMessage: message)
+                if let viewModel = viewModel as? PostMessageViewModel {
+                    viewModel.prepareLayout(width: layoutWidth)
                 }
+                styledViewModels.append((date: date, viewModel: viewModel, style: style))
+            }
+        }
+        
+        var viewModels = [String: [MessageViewModel]]()
+        for (date, viewModel, style) in styledViewModels {
+            layout(viewModel, style: style, fits: layoutWidth)
+            if viewModels[date] != nil {
+                viewModels[date]!.append(viewModel)
+            } else {
+                viewModels[date] = [viewModel]
             }
         }
         return (dates: dates, viewModels: viewModels)
@@ -107,6 +117,17 @@ class MessageViewModelFactory {
         style: MessageViewModel.Style,
         fits layoutWidth: CGFloat
     ) -> MessageViewModel {
+        let viewModel = self.viewModel(withMessage: message)
+        layout(viewModel, style: style, fits: layoutWidth)
+        return viewModel
+    }
+    
+    private func layout(_ viewModel: MessageViewModel, style: MessageViewModel.Style, fits layoutWidth: CGFloat) {
+        viewModel.layout(width: layoutWidth, style: style)
+        delegate?.messageViewModelFactory(self, updateViewModelForPresentation: viewModel)
+    }
+    
+    private func viewModel(withMessage message: MessageItem) -> MessageViewModel {
         let viewModel: MessageViewModel
         if message.status == MessageStatus.FAILED.rawValue {
             viewModel = DecryptionFailedMessageViewModel(message: message)
@@ -171,8 +192,6 @@ class MessageViewModelFactory {
                 viewModel = UnknownMessageViewModel(message: message)
             }
         }
-        viewModel.layout(width: layoutWidth, style: style)
-        delegate?.messageViewModelFactory(self, updateViewModelForPresentation: viewModel)
         return viewModel
     }
     
@@ -1,4 +1,5 @@
 import UIKit
+import SDWebImage
 import MixinServices
 
 class PostMessageViewModel: DetailInfoMessageViewModel, BackgroundedTrailingInfoViewModel {
@@ -13,6 +14,8 @@ class PostMessageViewModel: DetailInfoMessageViewModel, BackgroundedTrailingInfo
     
     let html: String // For display
     let contentAttributedString: NSAttributedString // For estimating cell frame
+    let contentHash: UInt // For looking up cached layout
+    let imagesToLoad: [MarkdownImage] // Measured with placeholders
     
     var webViewFrame: CGRect = .zero
     var trailingInfoBackgroundFrame: CGRect = .zero
@@ -43,23 +46,45 @@ class PostMessageViewModel: DetailInfoMessageViewModel, BackgroundedTrailingInfo
             }
             return lines.joined(separator: "\n")
         }()
-        html = MarkdownConverter.htmlString(from: previewableMarkdown, richFormat: false)
-        contentAttributedString = MarkdownConverter.attributedString(from: previewableMarkdown,
-                                                                     maxNumberOfCharacters: frameEstimatingMaxCharacterCount,
-                                                                     maxNumberOfLines: frameEstimationMaxLineCount)
+        let rendering = MarkdownConverter.render(from: previewableMarkdown,
+                                                 outputs: [.html, .attributedString],
+                                                 richFormat: false,
+                                                 maxNumberOfCharacters: frameEstimatingMaxCharacterCount,
+                                                 maxNumberOfLines: frameEstimationMaxLineCount)
+        var attributedString = rendering.attributedString ?? NSAttributedString()
+        var hasher = Hasher()
+        hasher.combine(previewableMarkdown)
+        // Fonts are scaled with content size category
+        if attributedString.length > 0, let font = attributedString.attribute(.font, at: 0, effectiveRange: nil) as? UIFont {
+            hasher.combine(font.pointSize)
+        }
+        // Images loaded before are measured with their own size
+        var imagesToLoad = [MarkdownImage]()
+        for image in rendering.images ?? [] {
+            if let attachment = MarkdownImageLoader.cachedAttachment(of: image) {
+                attributedString = MarkdownImageLoader.attributedString(attributedString, replacingPlaceholderOf: image, with: attachment)
+                hasher.combine(image.source)
+            } else {
+                imagesToLoad.append(image)
+            }
+        }
+        html = rendering.htmlString ?? ""
+        contentAttributedString = attributedString
+        contentHash = UInt(bitPattern: hasher.finalize())
+        self.imagesToLoad = imagesToLoad
         super.init(message: message)
     }
     
     override func layout(width: CGFloat, style: MessageViewModel.Style) {
         super.layout(width: width, style: style)
         let backgroundWidth = layoutWidth - DetailInfoMessageViewModel.bubbleMargin.horizontal
-        let widthToFit = round(backgroundWidth - contentMargin.horizontal - webViewLeadingMargin - webViewTrailingMargin)
+        let (widthToFit, maxTextHeight) = textLayoutLimits(layoutWidth: layoutWidth)
         let sizeToFit = CGSize(width: widthToFit, height: UIView.layoutFittingExpandedSize.height)
-        let textSize = contentAttributedString.boundingRect(with: sizeToFit,
-                                                            options: [.usesLineFragmentOrigin, .usesFontLeading],
-                                                            context: nil)
-        let maxTextHeight = round(widthToFit / 4 * 3)
-        let height = ceil(min(maxTextHeight, max(minTextHeight, textSize.height)))
+        let textLayout = MarkdownConverter.layout(of: contentAttributedString,
+                                                  contentHash: contentHash,
+                                                  width: widthToFit,
+                                                  maxHeight: maxTextHeight)
+        let height = ceil(min(maxTextHeight, max(minTextHeight, textLayout.size.height)))
         let bubbleMargin = DetailInfoMessageViewModel.bubbleMargin
         let contentLabelTopMargin: CGFloat = {
             if style.contains(.fullname) {
@@ -96,6 +121,31 @@ class PostMessageViewModel: DetailInfoMessageViewModel, BackgroundedTrailingInfo
         layoutTrailingInfoBackgroundFrame()
     }
     
+    // Lays out the content on a background queue, layout(width:style:) with the
+    // same width picks up the result, or waits for it if it's still in progress
+    func prepareLayout(width: CGFloat) {
+        let (widthToFit, maxTextHeight) = textLayoutLimits(layoutWidth: width)
+        MarkdownConverter.prepareLayout(of: contentAttributedString,
+                                        contentHash: contentHash,
+                                        width: widthToFit,
+                                        maxHeight: maxTextHeight,
+                                        completion: nil)
+    }
+    
+    // Loaded images are cached, the post is measured with them next time it's rendered.
+    // Only visible cells load them, and cancel the operations when they are reused.
+    func loadImages(priority: MarkdownImageLoader.Priority) -> [SDWebImageCombinedOperation] {
+        imagesToLoad.compactMap { image in
+            MarkdownImageLoader.load(image, priority: priority) { _ in }
+        }
+    }
+    
+    private func textLayoutLimits(layoutWidth: CGFloat) -> (width: CGFloat, maxHeight: CGFloat) {
+        let backgroundWidth = layoutWidth - DetailInfoMessageViewModel.bubbleMargin.horizontal
+        let width = round(backgroundWidth - contentMargin.horizontal - webViewLeadingMargin - webViewTrailingMargin)
+        return (width, round(width / 4 * 3))
+    }
+    
 }
 
 extension PostMessageViewModel: SharedMediaItem {
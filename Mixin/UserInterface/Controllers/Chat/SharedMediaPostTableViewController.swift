@@ -39,6 +39,9 @@ extension SharedMediaPostTableViewController: SharedMediaDataSourceDelegate {
                 - SharedMediaPostCell.backgroundHorizontalMargin * 2
                 - SharedMediaPostCell.labelHorizontalMargin * 2
         }
+        for item in items {
+            item.prepareLayout(width: layoutWidth)
+        }
         for item in items {
             item.layout(width: layoutWidth, style: [])
         }
@@ -32,8 +32,13 @@ final class PostWebViewController: WebViewController {
             return
         }
         DispatchQueue.global().async {
-            let title = MarkdownConverter.attributedString(from: content, maxNumberOfCharacters: 20, maxNumberOfLines: 1).string.trimmingCharacters(in: .newlines)
-            let html = MarkdownConverter.htmlString(from: content, richFormat: true)
+            let rendering = MarkdownConverter.render(from: content,
+                                                     outputs: [.html, .attributedString],
+                                                     richFormat: true,
+                                                     maxNumberOfCharacters: 20,
+                                                     maxNumberOfLines: 1)
+            let title = (rendering.attributedString?.string ?? "").trimmingCharacters(in: .newlines)
+            let html = rendering.htmlString ?? ""
             DispatchQueue.main.async { [weak self] in
                 guard let self = self else {
                     return
@@ -0,0 +1,350 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+/*
+ * Latency and throughput of Argon2 over grids of t/m/p and thread counts, for
+ * each fill_block implementation the CPU supports, and a calibrator that
+ * recommends parameters for a target latency.
+ *
+ * Build and run from this directory on Linux:
+ *
+ *   A=../../MixinServices/Crypto/Argon2
+ *   cc -O3 -pthread -I$A/include -I$A -o argon2-bench argon2-bench.c \
+ *      $A/argon2.c $A/arena.c $A/core.c $A/ct_base64.c $A/encoding.c \
+ *      $A/opt.c $A/ref.c $A/thread.c $A/blake2/blake2b.c
+ *   ./argon2-bench -t 1,2,4 -m 1024,4096,16384 -p 1,2,4 -L 500
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "argon2.h"
+
+#define MAX_VALUES 16
+
+typedef struct Value_list {
+    uint32_t values[MAX_VALUES];
+    size_t count;
+} value_list;
+
+typedef struct Bench_options {
+    value_list t_costs;
+    value_list m_costs;
+    value_list lanes;
+    value_list threads; /* empty means threads = lanes */
+    uint32_t iterations;
+    argon2_type types[3];
+    size_t type_count;
+    int use_arena;
+    double target_ms; /* 0 disables the calibrator */
+    uint32_t min_t_cost;
+    uint32_t max_m_cost;
+} bench_options;
+
+static const argon2_impl impls[] = {Argon2_impl_ref, Argon2_impl_sse2,
+                                    Argon2_impl_avx2, Argon2_impl_neon};
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int parse_list(const char *text, value_list *list) {
+    char *end;
+    list->count = 0;
+    while (*text != '\0' && list->count < MAX_VALUES) {
+        unsigned long value = strtoul(text, &end, 10);
+        if (end == text || value == 0 || value > UINT32_MAX) {
+            return -1;
+        }
+        list->values[list->count++] = (uint32_t)value;
+        text = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return -1;
+        }
+    }
+    return list->count > 0 ? 0 : -1;
+}
+
+/* Median latency of @iterations hashes in milliseconds, negative on error */
+static double measure(const bench_options *options, argon2_type type,
+                      uint32_t t_cost, uint32_t m_cost, uint32_t lanes,
+                      uint32_t threads) {
+    static const uint8_t pwd[32] = {1};
+    static const uint8_t salt[16] = {2};
+    uint8_t out[32];
+    double samples[64];
+    uint32_t iterations = options->iterations;
+    argon2_arena *arena = NULL;
+    argon2_context context;
+    uint32_t i;
+
+    if (iterations > sizeof(samples) / sizeof(samples[0])) {
+        iterations = sizeof(samples) / sizeof(samples[0]);
+    }
+    if (options->use_arena) {
+        arena = argon2_arena_create(m_cost, lanes, 0);
+        if (arena == NULL) {
+            return -1;
+        }
+    }
+
+    memset(&context, 0, sizeof(context));
+    context.out = out;
+    context.outlen = sizeof(out);
+    context.pwd = (uint8_t *)pwd;
+    context.pwdlen = sizeof(pwd);
+    context.salt = (uint8_t *)salt;
+    context.saltlen = sizeof(salt);
+    context.t_cost = t_cost;
+    context.m_cost = m_cost;
+    context.lanes = lanes;
+    context.threads = threads;
+    context.version = ARGON2_VERSION_NUMBER;
+
+    /* Warm up the worker pool and the page cache */
+    if (argon2_ctx(&context, type) != ARGON2_OK) {
+        argon2_arena_release(arena);
+        return -1;
+    }
+    for (i = 0; i < iterations; ++i) {
+        double start = now_ms();
+        int rc = arena != NULL ? argon2_ctx_arena(&context, type, arena)
+                               : argon2_ctx(&context, type);
+        if (rc != ARGON2_OK) {
+            argon2_arena_release(arena);
+            return -1;
+        }
+        samples[i] = now_ms() - start;
+    }
+    argon2_arena_release(arena);
+
+    qsort(samples, iterations, sizeof(double), compare_doubles);
+    return samples[iterations / 2];
+}
+
+static void bench_point(const bench_options *options, argon2_impl impl,
+                        argon2_type type, uint32_t t_cost, uint32_t m_cost,
+                        uint32_t lanes, uint32_t threads) {
+    double latency = measure(options, type, t_cost, m_cost, lanes, threads);
+
+    if (latency < 0) {
+        printf("%s,%s,%u,%u,%u,%u,error,,\n", argon2_impl2string(impl),
+               argon2_type2string(type, 0), t_cost, m_cost, lanes, threads);
+        return;
+    }
+    printf("%s,%s,%u,%u,%u,%u,%.3f,%.2f,%.1f\n", argon2_impl2string(impl),
+           argon2_type2string(type, 0), t_cost, m_cost, lanes, threads,
+           latency, 1e3 / latency,
+           (double)t_cost * m_cost / 1024 / latency * 1e3);
+    fflush(stdout);
+}
+
+static void run_grid(const bench_options *options) {
+    size_t i, ti, mi, pi, ji, yi;
+
+    printf("impl,type,t_cost,m_cost,lanes,threads,latency_ms,hashes_per_s,"
+           "mib_per_s\n");
+    for (i = 0; i < sizeof(impls) / sizeof(impls[0]); ++i) {
+        if (!argon2_impl_supported(impls[i])) {
+            continue;
+        }
+        argon2_select_impl(impls[i]);
+        for (ti = 0; ti < options->t_costs.count; ++ti) {
+            for (mi = 0; mi < options->m_costs.count; ++mi) {
+                for (pi = 0; pi < options->lanes.count; ++pi) {
+                    uint32_t lanes = options->lanes.values[pi];
+                    size_t thread_counts =
+                        options->threads.count ? options->threads.count : 1;
+
+                    for (ji = 0; ji < thread_counts; ++ji) {
+                        uint32_t threads = options->threads.count
+                                               ? options->threads.values[ji]
+                                               : lanes;
+                        if (threads > lanes) {
+                            continue;
+                        }
+                        /* Variants next to each other, at equal hardness */
+                        for (yi = 0; yi < options->type_count; ++yi) {
+                            bench_point(options, impls[i], options->types[yi],
+                                        options->t_costs.values[ti],
+                                        options->m_costs.values[mi], lanes,
+                                        threads);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    argon2_select_impl(Argon2_impl_auto);
+}
+
+/*
+ * Follows the procedure of RFC 9106, section 4: for each lane count, take the
+ * largest memory cost that fits the target with the minimum number of passes,
+ * then raise the number of passes while the latency still fits.
+ */
+static void calibrate(const bench_options *options, argon2_type type) {
+    size_t pi;
+
+    argon2_select_impl(Argon2_impl_auto);
+    printf("\ncalibrating for %.0f ms with %s, %s\n", options->target_ms,
+           argon2_impl2string(argon2_selected_impl()),
+           argon2_type2string(type, 0));
+
+    for (pi = 0; pi < options->lanes.count; ++pi) {
+        uint32_t lanes = options->lanes.values[pi];
+        uint32_t t_cost = options->min_t_cost;
+        uint32_t m_cost = 8 * lanes;
+        double latency = measure(options, type, t_cost, m_cost, lanes, lanes);
+
+        if (latency < 0 || latency > options->target_ms) {
+            printf("p=%u: even m=%u KiB does not fit\n", lanes, m_cost);
+            continue;
+        }
+        /* Double the memory while it fits */
+        while (m_cost * 2 <= options->max_m_cost) {
+            double next =
+                measure(options, type, t_cost, m_cost * 2, lanes, lanes);
+            if (next < 0 || next > options->target_ms) {
+                break;
+            }
+            m_cost *= 2;
+            latency = next;
+        }
+        /* Then add passes while they fit */
+        for (;;) {
+            double next =
+                measure(options, type, t_cost + 1, m_cost, lanes, lanes);
+            if (next < 0 || next > options->target_ms) {
+                break;
+            }
+            t_cost += 1;
+            latency = next;
+        }
+        printf("recommended: t=%u m=%u p=%u (%.1f ms)\n", t_cost, m_cost,
+               lanes, latency);
+    }
+}
+
+static void add_type(bench_options *options, argon2_type type) {
+    size_t i;
+    for (i = 0; i < options->type_count; ++i) {
+        if (options->types[i] == type) {
+            return;
+        }
+    }
+    options->types[options->type_count++] = type;
+}
+
+static void usage(const char *cmd) {
+    printf("usage: %s [-t list] [-m list] [-p list] [-j list] [-n count]\n"
+           "          [-d | -i | -id] [-a] [-L ms [-T min_t] [-M max_m]]\n"
+           "\t-t  comma separated numbers of passes (default 1,2,4)\n"
+           "\t-m  comma separated memory costs in KiB (default 1024,4096)\n"
+           "\t-p  comma separated numbers of lanes (default 1,2,4)\n"
+           "\t-j  comma separated thread counts (default equal to lanes)\n"
+           "\t-n  measured iterations per point, median is reported "
+           "(default 9)\n"
+           "\t-d, -i, -id  Argon2 variants, may be combined to compare them at\n"
+           "\t    equal hardness (default Argon2i)\n"
+           "\t-a  hash in a preallocated arena\n"
+           "\t-L  target latency in ms, recommends t and m for each p\n"
+           "\t-T  minimum number of passes for the recommendation "
+           "(default 3)\n"
+           "\t-M  maximum memory cost in KiB for the recommendation "
+           "(default 1048576)\n",
+           cmd);
+}
+
+int main(int argc, char *argv[]) {
+    bench_options options;
+    int i;
+
+    memset(&options, 0, sizeof(options));
+    parse_list("1,2,4", &options.t_costs);
+    parse_list("1024,4096", &options.m_costs);
+    parse_list("1,2,4", &options.lanes);
+    options.iterations = 9;
+    options.min_t_cost = 3;
+    options.max_m_cost = 1 << 20;
+
+    for (i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        int rc = 0;
+
+        if (!strcmp(a, "-d")) {
+            add_type(&options, Argon2_d);
+        } else if (!strcmp(a, "-i")) {
+            add_type(&options, Argon2_i);
+        } else if (!strcmp(a, "-id")) {
+            add_type(&options, Argon2_id);
+        } else if (!strcmp(a, "-a")) {
+            options.use_arena = 1;
+        } else if (value == NULL) {
+            rc = -1;
+        } else if (!strcmp(a, "-t")) {
+            rc = parse_list(value, &options.t_costs), ++i;
+        } else if (!strcmp(a, "-m")) {
+            rc = parse_list(value, &options.m_costs), ++i;
+        } else if (!strcmp(a, "-p")) {
+            rc = parse_list(value, &options.lanes), ++i;
+        } else if (!strcmp(a, "-j")) {
+            rc = parse_list(value, &options.threads), ++i;
+        } else if (!strcmp(a, "-n")) {
+            options.iterations = (uint32_t)strtoul(value, NULL, 10), ++i;
+            rc = options.iterations > 0 ? 0 : -1;
+        } else if (!strcmp(a, "-L")) {
+            options.target_ms = strtod(value, NULL), ++i;
+            rc = options.target_ms > 0 ? 0 : -1;
+        } else if (!strcmp(a, "-T")) {
+            options.min_t_cost = (uint32_t)strtoul(value, NULL, 10), ++i;
+            rc = options.min_t_cost > 0 ? 0 : -1;
+        } else if (!strcmp(a, "-M")) {
+            options.max_m_cost = (uint32_t)strtoul(value, NULL, 10), ++i;
+        } else {
+            rc = -1;
+        }
+        if (rc != 0) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.type_count == 0) {
+        add_type(&options, Argon2_i);
+    }
+
+    run_grid(&options);
+    if (options.target_ms > 0) {
+        size_t yi;
+        for (yi = 0; yi < options.type_count; ++yi) {
+            calibrate(&options, options.types[yi]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,325 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+/*
+ * Timing-variance check for the data-independent parts of Argon2, in the
+ * style of dudect: measurements with a fixed input and with random inputs are
+ * interleaved at random and compared with Welch's t-test. |t| above 4.5 means
+ * the timing depends on the input.
+ *
+ *   index_alpha        reference block selection, fixed or random J1
+ *   argon2i            whole hash, fixed or random password
+ *   argon2id-first     the data-independent first half of the first pass of
+ *                      Argon2id (slices 0 and 1), fixed or random password
+ *   argon2id           whole Argon2id hash, data-dependent by design and
+ *                      only reported for comparison
+ *
+ * Build and run from this directory on Linux:
+ *
+ *   A=../../MixinServices/Crypto/Argon2
+ *   cc -O2 -pthread -I$A/include -I$A -o argon2-timing argon2-timing.c \
+ *      $A/argon2.c $A/arena.c $A/core.c $A/ct_base64.c $A/encoding.c \
+ *      $A/opt.c $A/ref.c $A/thread.c $A/blake2/blake2b.c -lm
+ *   ./argon2-timing -t 4 -m 1024 -p 2 -n 4000
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "argon2.h"
+#include "core.h"
+
+/* Measurements above this percentile are dropped as noise */
+#define CROP_PERCENTILE 0.9
+#define T_THRESHOLD 4.5
+#define INDEX_ALPHA_BATCH 256
+
+typedef struct Timing_options {
+    uint32_t t_cost;
+    uint32_t m_cost;
+    uint32_t lanes;
+    uint32_t measurements;
+} timing_options;
+
+typedef double (*measure_fn)(const timing_options *options, int random_input);
+
+/* Keeps the results of index_alpha alive */
+static volatile uint32_t index_alpha_sink;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void) {
+    /* xorshift64*, statistical quality is enough to pick classes and inputs */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static void fill_input(uint8_t *input, size_t length, int random_input) {
+    size_t i;
+    for (i = 0; i < length; ++i) {
+        input[i] = random_input ? (uint8_t)next_random() : 0x5A;
+    }
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void init_context(argon2_context *context, const timing_options *options,
+                         uint8_t *out, uint8_t *pwd, uint8_t *salt) {
+    memset(context, 0, sizeof(*context));
+    context->out = out;
+    context->outlen = 32;
+    context->pwd = pwd;
+    context->pwdlen = 32;
+    context->salt = salt;
+    context->saltlen = 16;
+    context->t_cost = options->t_cost;
+    context->m_cost = options->m_cost;
+    context->lanes = options->lanes;
+    context->threads = 1; /* keep the scheduler out of the measurement */
+    context->version = ARGON2_VERSION_NUMBER;
+}
+
+/* Same derivation as argon2_ctx */
+static void init_instance(argon2_instance_t *instance,
+                          const argon2_context *context, argon2_type type) {
+    uint32_t memory_blocks = context->m_cost;
+    uint32_t segment_length;
+
+    if (memory_blocks < 2 * ARGON2_SYNC_POINTS * context->lanes) {
+        memory_blocks = 2 * ARGON2_SYNC_POINTS * context->lanes;
+    }
+    segment_length = memory_blocks / (context->lanes * ARGON2_SYNC_POINTS);
+
+    memset(instance, 0, sizeof(*instance));
+    instance->version = context->version;
+    instance->passes = context->t_cost;
+    instance->memory_blocks =
+        segment_length * context->lanes * ARGON2_SYNC_POINTS;
+    instance->segment_length = segment_length;
+    instance->lane_length = segment_length * ARGON2_SYNC_POINTS;
+    instance->lanes = context->lanes;
+    instance->threads = 1;
+    instance->type = type;
+    instance->fill_block = fill_block_ref;
+}
+
+static double measure_index_alpha(const timing_options *options,
+                                  int random_input) {
+    uint32_t pseudo_rand[INDEX_ALPHA_BATCH];
+    argon2_context context;
+    argon2_instance_t instance;
+    argon2_position_t position = {1, 0, 2, 5};
+    uint32_t i, acc = 0;
+    double start;
+
+    init_context(&context, options, NULL, NULL, NULL);
+    init_instance(&instance, &context, Argon2_i);
+    for (i = 0; i < INDEX_ALPHA_BATCH; ++i) {
+        pseudo_rand[i] = random_input ? (uint32_t)next_random() : 0x5A5A5A5A;
+    }
+
+    start = now_ns();
+    for (i = 0; i < INDEX_ALPHA_BATCH; ++i) {
+        acc += index_alpha(&instance, &position, pseudo_rand[i], 1);
+    }
+    index_alpha_sink = acc;
+    return now_ns() - start;
+}
+
+static double measure_hash(const timing_options *options, int random_input,
+                           argon2_type type) {
+    uint8_t out[32], pwd[32], salt[16];
+    argon2_context context;
+    double start;
+
+    fill_input(pwd, sizeof(pwd), random_input);
+    memset(salt, 0x11, sizeof(salt));
+    init_context(&context, options, out, pwd, salt);
+
+    start = now_ns();
+    if (argon2_ctx(&context, type) != ARGON2_OK) {
+        return -1;
+    }
+    return now_ns() - start;
+}
+
+static double measure_argon2i(const timing_options *options,
+                              int random_input) {
+    return measure_hash(options, random_input, Argon2_i);
+}
+
+static double measure_argon2id(const timing_options *options,
+                               int random_input) {
+    return measure_hash(options, random_input, Argon2_id);
+}
+
+static double measure_argon2id_first(const timing_options *options,
+                                     int random_input) {
+    uint8_t out[32], pwd[32], salt[16];
+    argon2_context context;
+    argon2_instance_t instance;
+    uint32_t l;
+    uint8_t s;
+    double start, elapsed;
+
+    fill_input(pwd, sizeof(pwd), random_input);
+    memset(salt, 0x11, sizeof(salt));
+    init_context(&context, options, out, pwd, salt);
+    init_instance(&instance, &context, Argon2_id);
+    if (initialize(&instance, &context) != ARGON2_OK) {
+        return -1;
+    }
+
+    start = now_ns();
+    for (s = 0; s < ARGON2_SYNC_POINTS / 2; ++s) {
+        for (l = 0; l < instance.lanes; ++l) {
+            argon2_position_t position = {0, l, s, 0};
+            fill_segment(&instance, position);
+        }
+    }
+    elapsed = now_ns() - start;
+
+    free_memory(&context, (uint8_t *)instance.memory, instance.memory_blocks,
+                sizeof(block));
+    return elapsed;
+}
+
+/* Welch's t statistic of the two classes, after cropping outliers */
+static double welch_t(const double *samples, const int *classes, size_t count) {
+    double *sorted = malloc(count * sizeof(double));
+    double threshold, mean[2] = {0, 0}, m2[2] = {0, 0};
+    size_t n[2] = {0, 0}, i;
+
+    if (sorted == NULL) {
+        return NAN;
+    }
+    memcpy(sorted, samples, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
+    threshold = sorted[(size_t)(count * CROP_PERCENTILE)];
+    free(sorted);
+
+    /* Welford's online mean and variance */
+    for (i = 0; i < count; ++i) {
+        int c = classes[i];
+        double delta;
+        if (samples[i] > threshold) {
+            continue;
+        }
+        n[c]++;
+        delta = samples[i] - mean[c];
+        mean[c] += delta / n[c];
+        m2[c] += delta * (samples[i] - mean[c]);
+    }
+    if (n[0] < 2 || n[1] < 2) {
+        return NAN;
+    }
+    return (mean[0] - mean[1]) /
+           sqrt(m2[0] / (n[0] - 1) / n[0] + m2[1] / (n[1] - 1) / n[1]);
+}
+
+static int run_test(const char *name, measure_fn measure,
+                    const timing_options *options, uint32_t measurements,
+                    int informational) {
+    double *samples = malloc(measurements * sizeof(double));
+    int *classes = malloc(measurements * sizeof(int));
+    uint32_t i;
+    double t;
+    int leak;
+
+    if (samples == NULL || classes == NULL) {
+        free(samples);
+        free(classes);
+        return -1;
+    }
+    /* Warm up caches and the allocator */
+    for (i = 0; i < 16; ++i) {
+        measure(options, i & 1);
+    }
+    for (i = 0; i < measurements; ++i) {
+        classes[i] = (int)(next_random() & 1);
+        samples[i] = measure(options, classes[i]);
+        if (samples[i] < 0) {
+            printf("%-16s error\n", name);
+            free(samples);
+            free(classes);
+            return -1;
+        }
+    }
+    t = welch_t(samples, classes, measurements);
+    leak = !(fabs(t) < T_THRESHOLD);
+    printf("%-16s n=%-7u t=%8.3f  %s\n", name, measurements, t,
+           leak ? (informational ? "input-dependent (expected)"
+                                 : "INPUT-DEPENDENT TIMING")
+                : "no leak detected");
+    free(samples);
+    free(classes);
+    return leak && !informational;
+}
+
+int main(int argc, char *argv[]) {
+    timing_options options = {4, 1024, 2, 4000};
+    int i, failures = 0;
+
+    for (i = 1; i + 1 < argc; i += 2) {
+        uint32_t value = (uint32_t)strtoul(argv[i + 1], NULL, 10);
+        if (!strcmp(argv[i], "-t")) {
+            options.t_cost = value;
+        } else if (!strcmp(argv[i], "-m")) {
+            options.m_cost = value;
+        } else if (!strcmp(argv[i], "-p")) {
+            options.lanes = value;
+        } else if (!strcmp(argv[i], "-n")) {
+            options.measurements = value;
+        } else {
+            break;
+        }
+    }
+    if (i < argc || options.t_cost == 0 || options.lanes == 0 ||
+        options.measurements < 100) {
+        printf("usage: %s [-t passes] [-m KiB] [-p lanes] [-n measurements]\n",
+               argv[0]);
+        return 1;
+    }
+    rng_state ^= (uint64_t)time(NULL);
+
+    printf("t=%u m=%u p=%u, |t| > %.1f flags input-dependent timing\n",
+           options.t_cost, options.m_cost, options.lanes, T_THRESHOLD);
+    failures += run_test("index_alpha", measure_index_alpha, &options,
+                         options.measurements * 25, 0) != 0;
+    failures += run_test("argon2i", measure_argon2i, &options,
+                         options.measurements, 0) != 0;
+    failures += run_test("argon2id-first", measure_argon2id_first, &options,
+                         options.measurements, 0) != 0;
+    run_test("argon2id", measure_argon2id, &options, options.measurements, 1);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+/*
+ * Throughput of the constant-time Base64 codec in ct_base64.c, encoding and
+ * decoding 32 bytes (keys, hashes) up to 64 KiB, for every variant.
+ *
+ * Build and run from this directory on Linux, once as is and once with
+ * -mssse3 (default on Apple platforms) to compare the scalar and vector code:
+ *
+ *   A=../../MixinServices/Crypto/Argon2
+ *   cc -O3 -I$A/include -I$A -o base64-bench base64-bench.c $A/ct_base64.c
+ *   ./base64-bench
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ct_base64.h"
+
+/* Bytes converted per measurement, so small inputs are repeated */
+#define BYTES_PER_RUN (16 * 1024 * 1024)
+#define RUNS 7
+
+static const size_t sizes[] = {32, 64, 256, 1024, 65536};
+static const char *variants[] = {"standard", "standard-unpadded", "urlsafe",
+                                 "urlsafe-unpadded"};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(void) {
+    const size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    unsigned char *bin = malloc(max_size);
+    char *text = malloc(max_size * 2);
+    size_t i, si;
+    int variant;
+
+    if (bin == NULL || text == NULL) {
+        return 1;
+    }
+    for (i = 0; i < max_size; ++i) {
+        bin[i] = (unsigned char)(i * 131 + 7);
+    }
+
+    printf("variant,bytes,encode_mib_per_s,decode_mib_per_s\n");
+    for (variant = 0; variant < 4; ++variant) {
+        for (si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+            size_t size = sizes[si];
+            size_t repeats = BYTES_PER_RUN / size;
+            size_t text_len = ct_base64_encoded_len(size, variant);
+            double encode[RUNS], decode[RUNS];
+            int run;
+
+            for (run = 0; run < RUNS; ++run) {
+                double start = now_ns();
+                size_t r;
+                for (r = 0; r < repeats; ++r) {
+                    ct_base64_encode(text, max_size * 2, bin, size, variant);
+                    bin[0] ^= (unsigned char)text[0]; /* defeat hoisting */
+                }
+                encode[run] = repeats * size / (1024.0 * 1024.0) /
+                              ((now_ns() - start) / 1e9);
+
+                start = now_ns();
+                for (r = 0; r < repeats; ++r) {
+                    size_t bin_len = max_size;
+                    if (ct_base64_decode(bin, &bin_len, text, text_len,
+                                         variant) == NULL) {
+                        printf("decoding failed\n");
+                        return 1;
+                    }
+                }
+                decode[run] = repeats * size / (1024.0 * 1024.0) /
+                              ((now_ns() - start) / 1e9);
+            }
+            qsort(encode, RUNS, sizeof(double), compare_doubles);
+            qsort(decode, RUNS, sizeof(double), compare_doubles);
+            printf("%s,%zu,%.0f,%.0f\n", variants[variant], size,
+                   encode[RUNS / 2], decode[RUNS / 2]);
+            fflush(stdout);
+        }
+    }
+    free(bin);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+/*
+ * Speed of BLAKE2b in cycles per byte for each compression function the CPU
+ * supports, over message sizes from one block to 1 MiB.
+ *
+ * Build and run from this directory on Linux:
+ *
+ *   A=../../MixinServices/Crypto/Argon2
+ *   cc -O3 -pthread -I$A/include -I$A -o blake2b-bench blake2b-bench.c \
+ *      $A/argon2.c $A/arena.c $A/core.c $A/ct_base64.c $A/encoding.c \
+ *      $A/opt.c $A/ref.c $A/thread.c $A/blake2/blake2b.c
+ *   ./blake2b-bench
+ *
+ * Cycles are read from the time stamp counter on x86. Elsewhere they are
+ * derived from elapsed time at the clock rate given with -g (GHz).
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "argon2.h"
+#include "blake2/blake2.h"
+
+/* Bytes hashed per measurement, so small messages are repeated */
+#define BYTES_PER_RUN (8 * 1024 * 1024)
+#define RUNS 7
+
+static const argon2_impl impls[] = {Argon2_impl_ref, Argon2_impl_sse2,
+                                    Argon2_impl_avx2, Argon2_impl_neon};
+static const size_t sizes[] = {128, 256, 1024, 4096, 16384, 1 << 20};
+
+static double ghz = 0;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t cycles(void) {
+#if defined(HAVE_TSC)
+    if (ghz == 0) {
+        return __rdtsc();
+    }
+#endif
+    return (uint64_t)(now_ns() * ghz);
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    uint8_t *message, out[BLAKE2B_OUTBYTES];
+    size_t i, si;
+
+    if (argc == 3 && !strcmp(argv[1], "-g")) {
+        ghz = strtod(argv[2], NULL);
+    }
+#if !defined(HAVE_TSC)
+    if (ghz <= 0) {
+        printf("usage: %s -g <clock rate in GHz>\n", argv[0]);
+        return 1;
+    }
+#endif
+
+    message = malloc(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    if (message == NULL) {
+        return 1;
+    }
+    for (i = 0; i < sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]; ++i) {
+        message[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    printf("impl,message_bytes,cycles_per_byte,mib_per_s\n");
+    for (i = 0; i < sizeof(impls) / sizeof(impls[0]); ++i) {
+        if (!argon2_impl_supported(impls[i])) {
+            continue;
+        }
+        argon2_select_impl(impls[i]);
+        for (si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+            size_t size = sizes[si];
+            size_t repeats = BYTES_PER_RUN / size;
+            double cpb[RUNS], mibs[RUNS];
+            int run;
+
+            for (run = 0; run < RUNS; ++run) {
+                double start_ns = now_ns();
+                uint64_t start = cycles();
+                size_t r;
+                for (r = 0; r < repeats; ++r) {
+                    blake2b(out, sizeof(out), message, size, NULL, 0);
+                    message[0] ^= out[0]; /* chain to defeat hoisting */
+                }
+                cpb[run] = (double)(cycles() - start) / (repeats * size);
+                mibs[run] = repeats * size / (1024.0 * 1024.0) /
+                            ((now_ns() - start_ns) / 1e9);
+            }
+            qsort(cpb, RUNS, sizeof(double), compare_doubles);
+            qsort(mibs, RUNS, sizeof(double), compare_doubles);
+            printf("%s,%zu,%.2f,%.1f\n", argon2_impl2string(impls[i]), size,
+                   cpb[RUNS / 2], mibs[RUNS / 2]);
+            fflush(stdout);
+        }
+    }
+    argon2_select_impl(Argon2_impl_auto);
+    free(message);
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+/*
+ * Messages per second of blake2b_x4, which hashes four independent messages
+ * one per vector lane, against four serial blake2b calls, for message sizes
+ * from 64 to 1024 bytes and each implementation the CPU supports.
+ *
+ * Build and run from this directory on Linux:
+ *
+ *   A=../../MixinServices/Crypto/Argon2
+ *   cc -O3 -pthread -I$A/include -I$A -o blake2b-multi-bench \
+ *      blake2b-multi-bench.c $A/argon2.c $A/arena.c $A/core.c \
+ *      $A/ct_base64.c $A/encoding.c $A/opt.c $A/ref.c $A/thread.c \
+ *      $A/blake2/blake2b.c
+ *   ./blake2b-multi-bench
+ *
+ * Implementations without a multi-buffer kernel fall back to serial calls,
+ * so their speedup is about 1.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "argon2.h"
+#include "blake2/blake2.h"
+
+/* Messages hashed per measurement */
+#define MESSAGES_PER_RUN (256 * 1024)
+#define RUNS 7
+
+static const argon2_impl impls[] = {Argon2_impl_ref, Argon2_impl_sse2,
+                                    Argon2_impl_avx2, Argon2_impl_neon};
+static const size_t sizes[] = {64, 128, 256, 512, 1024};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Median messages per second of hashing four messages of @size bytes */
+static double measure(uint8_t *messages[4], size_t size, int multi) {
+    uint8_t out[4][BLAKE2B_OUTBYTES];
+    void *outs[4] = {out[0], out[1], out[2], out[3]};
+    const void *ins[4] = {messages[0], messages[1], messages[2], messages[3]};
+    const size_t inlens[4] = {size, size, size, size};
+    double rates[RUNS];
+    int run;
+
+    for (run = 0; run < RUNS; ++run) {
+        double start = now_ns();
+        size_t r, lane;
+        for (r = 0; r < MESSAGES_PER_RUN / 4; ++r) {
+            if (multi) {
+                blake2b_x4(outs, BLAKE2B_OUTBYTES, ins, inlens);
+            } else {
+                for (lane = 0; lane < 4; ++lane) {
+                    blake2b(out[lane], BLAKE2B_OUTBYTES, messages[lane], size,
+                            NULL, 0);
+                }
+            }
+            for (lane = 0; lane < 4; ++lane) {
+                messages[lane][0] ^= out[lane][0]; /* chain to defeat hoisting */
+            }
+        }
+        rates[run] = MESSAGES_PER_RUN / ((now_ns() - start) / 1e9);
+    }
+    qsort(rates, RUNS, sizeof(double), compare_doubles);
+    return rates[RUNS / 2];
+}
+
+int main(void) {
+    const size_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+    uint8_t *messages[4];
+    size_t i, si, lane;
+
+    for (lane = 0; lane < 4; ++lane) {
+        messages[lane] = malloc(max_size);
+        if (messages[lane] == NULL) {
+            return 1;
+        }
+        for (i = 0; i < max_size; ++i) {
+            messages[lane][i] = (uint8_t)(i * 131 + lane * 17 + 7);
+        }
+    }
+
+    printf("impl,message_bytes,serial_msgs_per_s,x4_msgs_per_s,speedup\n");
+    for (i = 0; i < sizeof(impls) / sizeof(impls[0]); ++i) {
+        if (!argon2_impl_supported(impls[i])) {
+            continue;
+        }
+        argon2_select_impl(impls[i]);
+        for (si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+            double serial = measure(messages, sizes[si], 0);
+            double multi = measure(messages, sizes[si], 1);
+            printf("%s,%zu,%.0f,%.0f,%.2f\n", argon2_impl2string(impls[i]),
+                   sizes[si], serial, multi, multi / serial);
+            fflush(stdout);
+        }
+    }
+    argon2_select_impl(Argon2_impl_auto);
+    for (lane = 0; lane < 4; ++lane) {
+        free(messages[lane]);
+    }
+    return 0;
+}
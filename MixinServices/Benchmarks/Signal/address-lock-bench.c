@@ -0,0 +1,196 @@
+//
+//  address-lock-bench.c
+//  libsignal-protocol-swift iOS
+//
+//  Throughput of the libsignal lock with 1 to 8 threads, comparing the
+//  single recursive mutex it used to be with address_lock. Each thread works
+//  on its own conversation, like decrypting messages from different senders,
+//  and every operation takes the lock twice nested and spins inside it for
+//  about as long as a ratchet step.
+//
+//  Build and run from this directory on Linux or macOS:
+//
+//    S=../../MixinServices/Services/libsignal-protocol-swift/Setup
+//    cc -O2 -pthread -I$S -o address-lock-bench address-lock-bench.c $S/address_lock.c
+//    ./address-lock-bench [-w work_ns] [-u unscoped_percent] [-s]
+//
+//  -s makes all threads share one conversation, the sharded lock then
+//  degrades to the global one. -u mixes in calls made without a scope.
+//  Threads only run in parallel with several CPUs, with one CPU both locks
+//  perform about the same whatever the thread count.
+//
+
+#include "address_lock.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_THREADS 8
+#define RUN_SECONDS 0.5
+
+typedef struct {
+    const char *name;
+    void (*acquire)(void *user_data);
+    void (*release)(void *user_data);
+} lock_impl;
+
+static pthread_mutex_t global_mutex;
+
+static void global_acquire(void *user_data) {
+    pthread_mutex_lock(&global_mutex);
+}
+
+static void global_release(void *user_data) {
+    pthread_mutex_unlock(&global_mutex);
+}
+
+static const lock_impl impls[] = {
+    { "global mutex", global_acquire, global_release },
+    { "address_lock", address_lock_acquire, address_lock_release },
+};
+
+typedef struct {
+    const lock_impl *impl;
+    int index;
+    int shared;
+    unsigned int unscoped_percent;
+    uint64_t spin;
+    int *stop;
+    uint64_t ops;
+} worker;
+
+static uint64_t sink;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t spin(uint64_t x, uint64_t n) {
+    uint64_t i;
+
+    for(i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+static void *run(void *arg) {
+    worker *w = arg;
+    char name[32];
+    uint64_t x = 0x9e3779b97f4a7c15ull + (uint64_t) w->index;
+    uint32_t r = 2463534242u + (uint32_t) w->index;
+
+    snprintf(name, sizeof(name), "user-%d", w->shared ? 0 : w->index);
+    while(!__atomic_load_n(w->stop, __ATOMIC_RELAXED)) {
+        r ^= r << 13;
+        r ^= r >> 17;
+        r ^= r << 5;
+        int scoped = (r % 100) >= w->unscoped_percent;
+        int outer_scope = -1;
+        if(scoped) {
+            outer_scope = address_lock_scope_enter(NULL, 0, name, strlen(name), 1);
+        }
+        w->impl->acquire(NULL);
+        w->impl->acquire(NULL);
+        x = spin(x, w->spin);
+        w->impl->release(NULL);
+        w->impl->release(NULL);
+        if(scoped) {
+            address_lock_scope_leave(outer_scope);
+        }
+        w->ops++;
+    }
+    __atomic_fetch_add(&sink, x, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static uint64_t calibrate(uint64_t work_ns) {
+    uint64_t n = 1 << 16;
+    double start = now();
+    sink += spin(1, n);
+    double elapsed = now() - start;
+    return (uint64_t) (n * (work_ns / 1e9) / elapsed) + 1;
+}
+
+int main(int argc, char **argv) {
+    uint64_t work_ns = 2000;
+    unsigned int unscoped_percent = 0;
+    int shared = 0;
+    pthread_mutexattr_t attr;
+    int opt;
+
+    while((opt = getopt(argc, argv, "w:u:s")) != -1) {
+        switch(opt) {
+            case 'w':
+                work_ns = strtoull(optarg, NULL, 10);
+                break;
+            case 'u':
+                unscoped_percent = (unsigned int) atoi(optarg);
+                break;
+            case 's':
+                shared = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-w work_ns] [-u unscoped_percent] [-s]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&global_mutex, &attr);
+    if(address_lock_init() != 0) {
+        fprintf(stderr, "address_lock_init failed\n");
+        return 1;
+    }
+
+    uint64_t spin_count = calibrate(work_ns);
+    printf("%llu ns per operation, %u%% unscoped, %s conversations, %ld CPUs\n",
+           (unsigned long long) work_ns, unscoped_percent, shared ? "one shared" : "separate",
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-14s", "threads");
+    for(size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+        printf("%16s", impls[i].name);
+    }
+    printf("%10s\n", "speedup");
+
+    for(int threads = 1; threads <= MAX_THREADS; threads++) {
+        double rates[2];
+        printf("%-14d", threads);
+        for(size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++) {
+            pthread_t ids[MAX_THREADS];
+            worker workers[MAX_THREADS];
+            int stop = 0;
+            uint64_t ops = 0;
+
+            for(int t = 0; t < threads; t++) {
+                workers[t] = (worker) { &impls[i], t, shared, unscoped_percent, spin_count, &stop, 0 };
+                pthread_create(&ids[t], NULL, run, &workers[t]);
+            }
+            double start = now();
+            usleep((useconds_t) (RUN_SECONDS * 1e6));
+            __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+            for(int t = 0; t < threads; t++) {
+                pthread_join(ids[t], NULL);
+                ops += workers[t].ops;
+            }
+            rates[i] = ops / (now() - start);
+            printf("%12.0f op/s", rates[i]);
+        }
+        printf("%9.2fx\n", rates[1] / rates[0]);
+    }
+
+    address_lock_destroy();
+    pthread_mutex_destroy(&global_mutex);
+    pthread_mutexattr_destroy(&attr);
+    return (int) (sink & 0);
+}
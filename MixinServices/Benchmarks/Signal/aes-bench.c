@@ -0,0 +1,208 @@
+//
+//  aes-bench.c
+//  libsignal-protocol-swift iOS
+//
+//  Latency of AES-CBC and AES-CTR through the crypto provider for message
+//  sizes from 16 bytes to 4 KiB, against creating a cryptor and an output
+//  copy for every call like the provider used to.
+//
+//  Needs libsignal-protocol-c, which CocoaPods checks out in
+//  Pods/libsignal-protocol-c. Build and run from this directory:
+//
+//    L=../../../Pods/libsignal-protocol-c
+//    cmake -S $L -B libsignal -DCMAKE_BUILD_TYPE=Release && cmake --build libsignal
+//    mkdir -p include && ln -sfn $(cd $L/src && pwd) include/libsignal_protocol_c
+//    S=../../MixinServices/Services/libsignal-protocol-swift/Setup
+//    P="$S/crypto_provider.c $S/crypto_provider_openssl.c $S/context_pool.c $S/random_generator.c"
+//    cc -O2 -pthread -Iinclude -I$S -o aes-bench aes-bench.c $P libsignal/src/libsignal-protocol-c.a -lcrypto
+//    ./aes-bench
+//
+//  -lcrypto is for Linux, macOS builds use CommonCrypto.
+//
+
+#include "crypto_backend.h"
+
+#include <libsignal_protocol_c/signal_protocol.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO)
+#include <CommonCrypto/CommonCryptor.h>
+#else
+#include <openssl/evp.h>
+#endif
+
+int test_encrypt(signal_buffer **output,
+                 int cipher,
+                 const uint8_t *key, size_t key_len,
+                 const uint8_t *iv, size_t iv_len,
+                 const uint8_t *plaintext, size_t plaintext_len,
+                 void *user_data);
+int test_decrypt(signal_buffer **output,
+                 int cipher,
+                 const uint8_t *key, size_t key_len,
+                 const uint8_t *iv, size_t iv_len,
+                 const uint8_t *ciphertext, size_t ciphertext_len,
+                 void *user_data);
+
+typedef int (*crypt_func)(signal_buffer **output,
+                          int cipher,
+                          const uint8_t *key, size_t key_len,
+                          const uint8_t *iv, size_t iv_len,
+                          const uint8_t *input, size_t input_len,
+                          void *user_data);
+
+// The provider as it was: a new cryptor, a malloc'd output and a copy of it
+static int per_call_crypt(signal_buffer **output, int encrypt, int cipher,
+                          const uint8_t *key, size_t key_len, const uint8_t *iv,
+                          const uint8_t *input, size_t input_len)
+{
+    int result = SG_ERR_UNKNOWN;
+    uint8_t *out_buf = malloc(input_len + 16);
+    size_t moved_len = 0;
+    if(!out_buf) {
+        return SG_ERR_NOMEM;
+    }
+
+#if defined(SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO)
+    CCCryptorRef ref = 0;
+    CCOperation op = encrypt ? kCCEncrypt : kCCDecrypt;
+    CCCryptorStatus status;
+    if(cipher == SG_CIPHER_AES_CBC_PKCS5) {
+        status = CCCryptorCreate(op, kCCAlgorithmAES, kCCOptionPKCS7Padding, key, key_len, iv, &ref);
+    }
+    else {
+        status = CCCryptorCreateWithMode(op, kCCModeCTR, kCCAlgorithmAES, ccNoPadding,
+                                         iv, key, key_len, 0, 0, 0, kCCModeOptionCTR_BE, &ref);
+    }
+    if(status == kCCSuccess) {
+        size_t update_len = 0, final_len = 0;
+        if(CCCryptorUpdate(ref, input, input_len, out_buf, input_len + 16, &update_len) == kCCSuccess &&
+           CCCryptorFinal(ref, out_buf + update_len, input_len + 16 - update_len, &final_len) == kCCSuccess) {
+            moved_len = update_len + final_len;
+            result = 0;
+        }
+        CCCryptorRelease(ref);
+    }
+#else
+    const EVP_CIPHER *evp_cipher = cipher == SG_CIPHER_AES_CBC_PKCS5 ? EVP_aes_256_cbc() : EVP_aes_256_ctr();
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    int update_len = 0, final_len = 0;
+    if(ctx && EVP_CipherInit_ex(ctx, evp_cipher, 0, key, iv, encrypt) == 1 &&
+       EVP_CipherUpdate(ctx, out_buf, &update_len, input, (int) input_len) == 1 &&
+       EVP_CipherFinal_ex(ctx, out_buf + update_len, &final_len) == 1) {
+        moved_len = (size_t) update_len + (size_t) final_len;
+        result = 0;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+    (void) key_len;
+#endif
+
+    if(result == 0) {
+        *output = signal_buffer_create(out_buf, moved_len);
+        result = *output ? 0 : SG_ERR_NOMEM;
+    }
+    free(out_buf);
+    return result;
+}
+
+static int per_call_encrypt(signal_buffer **output, int cipher, const uint8_t *key, size_t key_len,
+                            const uint8_t *iv, size_t iv_len, const uint8_t *input, size_t input_len,
+                            void *user_data)
+{
+    return per_call_crypt(output, 1, cipher, key, key_len, iv, input, input_len);
+}
+
+static int per_call_decrypt(signal_buffer **output, int cipher, const uint8_t *key, size_t key_len,
+                            const uint8_t *iv, size_t iv_len, const uint8_t *input, size_t input_len,
+                            void *user_data)
+{
+    return per_call_crypt(output, 0, cipher, key, key_len, iv, input, input_len);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Nanoseconds per call, the best of five runs
+static double measure(crypt_func func, int cipher, const uint8_t *key, const uint8_t *iv,
+                      const uint8_t *input, size_t input_len, int iterations)
+{
+    double best = 1e30;
+    int run, i;
+
+    for(run = 0; run < 5; run++) {
+        double start = now();
+        for(i = 0; i < iterations; i++) {
+            signal_buffer *output = 0;
+            if(func(&output, cipher, key, 32, iv, 16, input, input_len, 0) != 0) {
+                fprintf(stderr, "crypt failed\n");
+                exit(1);
+            }
+            signal_buffer_free(output);
+        }
+        double elapsed = (now() - start) * 1e9 / iterations;
+        if(elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+int main(void)
+{
+    static const size_t sizes[] = { 16, 64, 160, 256, 1024, 4096 };
+    static const struct {
+        const char *name;
+        int cipher;
+    } ciphers[] = {
+        { "CBC", SG_CIPHER_AES_CBC_PKCS5 },
+        { "CTR", SG_CIPHER_AES_CTR_NOPADDING },
+    };
+    uint8_t key[32], iv[16], input[4096];
+    size_t i, c;
+
+    for(i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t) (i * 7 + 1);
+    }
+    memset(iv, 0x24, sizeof(iv));
+    for(i = 0; i < sizeof(input); i++) {
+        input[i] = (uint8_t) i;
+    }
+
+#if defined(SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO)
+    printf("CommonCrypto, AES-256, ns per call\n");
+#else
+    printf("libcrypto, AES-256, ns per call\n");
+#endif
+    printf("%-4s %-8s %12s %12s %12s %12s\n", "mode", "bytes", "encrypt", "per-call", "decrypt", "per-call");
+    for(c = 0; c < sizeof(ciphers) / sizeof(ciphers[0]); c++) {
+        for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            size_t len = sizes[i];
+            int iterations = len <= 256 ? 200000 : 50000;
+            signal_buffer *ciphertext = 0;
+
+            if(test_encrypt(&ciphertext, ciphers[c].cipher, key, 32, iv, 16, input, len, 0) != 0) {
+                fprintf(stderr, "encrypt failed\n");
+                return 1;
+            }
+            const uint8_t *ct = signal_buffer_data(ciphertext);
+            size_t ct_len = signal_buffer_len(ciphertext);
+
+            printf("%-4s %-8zu %12.0f %12.0f %12.0f %12.0f\n", ciphers[c].name, len,
+                   measure(test_encrypt, ciphers[c].cipher, key, iv, input, len, iterations),
+                   measure(per_call_encrypt, ciphers[c].cipher, key, iv, input, len, iterations),
+                   measure(test_decrypt, ciphers[c].cipher, key, iv, ct, ct_len, iterations),
+                   measure(per_call_decrypt, ciphers[c].cipher, key, iv, ct, ct_len, iterations));
+            signal_buffer_free(ciphertext);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,1035 @@
+//
+//  signal-bench.c
+//  libsignal-protocol-swift iOS
+//
+//  Operations per second of the libsignal calls the app makes, run through
+//  signal_setup with in-memory stores so only libsignal and the crypto
+//  provider are measured: pre-key and signed pre-key generation, session
+//  setup from a pre-key bundle, 1:1 encrypt, decrypt and ratchet steps, and
+//  sender key encrypt and decrypt. Like the Swift wrappers, every operation
+//  creates its own builder or cipher and decrypts from serialized bytes.
+//
+//  Needs libsignal-protocol-c, which CocoaPods checks out in
+//  Pods/libsignal-protocol-c. Build and run from this directory:
+//
+//    L=../../../Pods/libsignal-protocol-c
+//    cmake -S $L -B libsignal -DCMAKE_BUILD_TYPE=Release && cmake --build libsignal
+//    mkdir -p include && ln -sfn $(cd $L/src && pwd) include/libsignal_protocol_c
+//    S=../../MixinServices/Services/libsignal-protocol-swift/Setup
+//    P="$S/setup.c $S/address_lock.c $S/signal_log.c $S/crypto_provider.c"
+//    P="$P $S/crypto_provider_openssl.c $S/context_pool.c $S/random_generator.c"
+//    cc -O2 -pthread -Iinclude -I$S -o signal-bench signal-bench.c $P libsignal/src/libsignal-protocol-c.a -lcrypto
+//    ./signal-bench [-s message_bytes] [-c corpus_dir]
+//
+//  -c writes one message of each kind to corpus_dir as seeds for the fuzz
+//  target. Built with -DSIGNAL_BENCH_FUZZ the file has no main and instead
+//  defines LLVMFuzzerTestOneInput, which hands its input to the message
+//  deserializers. The first byte picks the message type:
+//
+//    clang -g -O1 -fsanitize=fuzzer,address -DSIGNAL_BENCH_FUZZ -pthread -Iinclude -I$S -o signal-fuzz signal-bench.c $P libsignal/src/libsignal-protocol-c.a -lcrypto
+//    ./signal-fuzz corpus_dir
+//
+//  -lcrypto is for Linux, macOS builds use CommonCrypto.
+//
+
+#include "setup.h"
+
+#include <libsignal_protocol_c/signal_protocol.h>
+#include <libsignal_protocol_c/key_helper.h>
+#include <libsignal_protocol_c/session_builder.h>
+#include <libsignal_protocol_c/session_cipher.h>
+#include <libsignal_protocol_c/session_pre_key.h>
+#include <libsignal_protocol_c/protocol.h>
+#include <libsignal_protocol_c/ratchet.h>
+#include <libsignal_protocol_c/group_session_builder.h>
+#include <libsignal_protocol_c/group_cipher.h>
+#include <libsignal_protocol_c/curve.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RUN_SECONDS 0.5
+#define BATCH 64
+#define MAX_KEY_LEN 256
+
+static signal_context *context;
+
+#ifndef SIGNAL_BENCH_FUZZ
+
+// MARK: In-memory store
+
+typedef struct mem_entry {
+    struct mem_entry *next;
+    signal_buffer *record;
+    size_t key_len;
+    uint8_t key[];
+} mem_entry;
+
+typedef struct {
+    mem_entry *buckets[256];
+} mem_table;
+
+static unsigned int mem_hash(const uint8_t *key, size_t key_len)
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
+    for(i = 0; i < key_len; i++) {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+    return (hash ^ (hash >> 8) ^ (hash >> 16) ^ (hash >> 24)) & 0xff;
+}
+
+static mem_entry **mem_find(mem_table *table, const uint8_t *key, size_t key_len)
+{
+    mem_entry **slot = &table->buckets[mem_hash(key, key_len)];
+    while(*slot && ((*slot)->key_len != key_len || memcmp((*slot)->key, key, key_len) != 0)) {
+        slot = &(*slot)->next;
+    }
+    return slot;
+}
+
+static signal_buffer *mem_get(mem_table *table, const uint8_t *key, size_t key_len)
+{
+    mem_entry *entry = *mem_find(table, key, key_len);
+    return entry ? entry->record : 0;
+}
+
+static int mem_put(mem_table *table, const uint8_t *key, size_t key_len,
+                   const uint8_t *record, size_t record_len)
+{
+    mem_entry **slot = mem_find(table, key, key_len);
+    signal_buffer *buffer = signal_buffer_create(record, record_len);
+    if(!buffer) {
+        return SG_ERR_NOMEM;
+    }
+    if(*slot) {
+        signal_buffer_bzero_free((*slot)->record);
+        (*slot)->record = buffer;
+        return 0;
+    }
+    mem_entry *entry = malloc(sizeof(mem_entry) + key_len);
+    if(!entry) {
+        signal_buffer_free(buffer);
+        return SG_ERR_NOMEM;
+    }
+    entry->next = 0;
+    entry->record = buffer;
+    entry->key_len = key_len;
+    memcpy(entry->key, key, key_len);
+    *slot = entry;
+    return 0;
+}
+
+static void mem_unlink(mem_entry **slot)
+{
+    mem_entry *entry = *slot;
+    *slot = entry->next;
+    signal_buffer_bzero_free(entry->record);
+    free(entry);
+}
+
+static int mem_remove(mem_table *table, const uint8_t *key, size_t key_len)
+{
+    mem_entry **slot = mem_find(table, key, key_len);
+    if(!*slot) {
+        return 0;
+    }
+    mem_unlink(slot);
+    return 1;
+}
+
+// Removes every entry whose key starts with prefix and returns the count
+static int mem_remove_prefix(mem_table *table, const uint8_t *prefix, size_t prefix_len)
+{
+    int count = 0;
+    int i;
+    for(i = 0; i < 256; i++) {
+        mem_entry **slot = &table->buckets[i];
+        while(*slot) {
+            if((*slot)->key_len >= prefix_len && memcmp((*slot)->key, prefix, prefix_len) == 0) {
+                mem_unlink(slot);
+                count++;
+            }
+            else {
+                slot = &(*slot)->next;
+            }
+        }
+    }
+    return count;
+}
+
+static void mem_clear(mem_table *table)
+{
+    mem_remove_prefix(table, (const uint8_t *) "", 0);
+}
+
+// Keys are group‖0‖name‖0‖device_id, with an empty group for 1:1 sessions
+static size_t address_key(uint8_t *key, const char *group_id, size_t group_id_len,
+                          const char *name, size_t name_len, int32_t device_id)
+{
+    size_t len = 0;
+    if(group_id_len + name_len + 2 + sizeof(device_id) > MAX_KEY_LEN) {
+        return 0;
+    }
+    memcpy(key, group_id, group_id_len);
+    len += group_id_len;
+    key[len++] = 0;
+    memcpy(key + len, name, name_len);
+    len += name_len;
+    key[len++] = 0;
+    memcpy(key + len, &device_id, sizeof(device_id));
+    return len + sizeof(device_id);
+}
+
+static size_t id_key(uint8_t *key, uint32_t id)
+{
+    memcpy(key, &id, sizeof(id));
+    return sizeof(id);
+}
+
+typedef struct {
+    const char *name;
+    uint32_t registration_id;
+    ratchet_identity_key_pair *identity;
+    signal_buffer *identity_public;
+    signal_buffer *identity_private;
+    session_signed_pre_key *signed_pre_key;
+    uint32_t next_pre_key_id;
+    mem_table sessions;
+    mem_table pre_keys;
+    mem_table signed_pre_keys;
+    mem_table identities;
+    mem_table sender_keys;
+    signal_protocol_store_context *store;
+} party;
+
+#define ADDRESS_KEY(key, address) \
+    address_key(key, "", 0, (address)->name, (address)->name_len, (address)->device_id)
+
+static int load_session(signal_buffer **record, signal_buffer **user_record,
+                        const signal_protocol_address *address, void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t key_len = ADDRESS_KEY(key, address);
+    signal_buffer *found = key_len ? mem_get(&p->sessions, key, key_len) : 0;
+    if(!found) {
+        return 0;
+    }
+    *record = signal_buffer_copy(found);
+    return *record ? 1 : SG_ERR_NOMEM;
+}
+
+static int get_sub_device_sessions(signal_int_list **sessions, const char *name, size_t name_len,
+                                   void *user_data)
+{
+    party *p = user_data;
+    uint8_t prefix[MAX_KEY_LEN];
+    size_t prefix_len = address_key(prefix, "", 0, name, name_len, 0);
+    signal_int_list *list;
+    int i;
+    if(prefix_len == 0) {
+        return SG_ERR_INVAL;
+    }
+    prefix_len -= sizeof(int32_t);
+    list = signal_int_list_alloc();
+    if(!list) {
+        return SG_ERR_NOMEM;
+    }
+    for(i = 0; i < 256; i++) {
+        mem_entry *entry;
+        for(entry = p->sessions.buckets[i]; entry; entry = entry->next) {
+            int32_t device_id;
+            if(entry->key_len != prefix_len + sizeof(device_id) ||
+               memcmp(entry->key, prefix, prefix_len) != 0) {
+                continue;
+            }
+            memcpy(&device_id, entry->key + prefix_len, sizeof(device_id));
+            if(signal_int_list_push_back(list, device_id) != 0) {
+                signal_int_list_free(list);
+                return SG_ERR_NOMEM;
+            }
+        }
+    }
+    *sessions = list;
+    return (int) signal_int_list_size(list);
+}
+
+static int store_session(const signal_protocol_address *address, uint8_t *record, size_t record_len,
+                         uint8_t *user_record, size_t user_record_len, void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t key_len = ADDRESS_KEY(key, address);
+    return key_len ? mem_put(&p->sessions, key, key_len, record, record_len) : SG_ERR_INVAL;
+}
+
+static int contains_session(const signal_protocol_address *address, void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t key_len = ADDRESS_KEY(key, address);
+    return key_len && mem_get(&p->sessions, key, key_len) ? 1 : 0;
+}
+
+static int delete_session(const signal_protocol_address *address, void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t key_len = ADDRESS_KEY(key, address);
+    return key_len ? mem_remove(&p->sessions, key, key_len) : 0;
+}
+
+static int delete_all_sessions(const char *name, size_t name_len, void *user_data)
+{
+    party *p = user_data;
+    uint8_t prefix[MAX_KEY_LEN];
+    size_t prefix_len = address_key(prefix, "", 0, name, name_len, 0);
+    if(prefix_len == 0) {
+        return 0;
+    }
+    return mem_remove_prefix(&p->sessions, prefix, prefix_len - sizeof(int32_t));
+}
+
+static int load_key(mem_table *table, signal_buffer **record, uint32_t id)
+{
+    uint8_t key[sizeof(id)];
+    signal_buffer *found = mem_get(table, key, id_key(key, id));
+    if(!found) {
+        return SG_ERR_INVALID_KEY_ID;
+    }
+    *record = signal_buffer_copy(found);
+    return *record ? SG_SUCCESS : SG_ERR_NOMEM;
+}
+
+static int store_key(mem_table *table, uint32_t id, uint8_t *record, size_t record_len)
+{
+    uint8_t key[sizeof(id)];
+    return mem_put(table, key, id_key(key, id), record, record_len);
+}
+
+static int contains_key(mem_table *table, uint32_t id)
+{
+    uint8_t key[sizeof(id)];
+    return mem_get(table, key, id_key(key, id)) ? 1 : 0;
+}
+
+static int remove_key(mem_table *table, uint32_t id)
+{
+    uint8_t key[sizeof(id)];
+    mem_remove(table, key, id_key(key, id));
+    return 0;
+}
+
+static int load_pre_key(signal_buffer **record, uint32_t pre_key_id, void *user_data)
+{
+    return load_key(&((party *) user_data)->pre_keys, record, pre_key_id);
+}
+
+static int store_pre_key(uint32_t pre_key_id, uint8_t *record, size_t record_len, void *user_data)
+{
+    return store_key(&((party *) user_data)->pre_keys, pre_key_id, record, record_len);
+}
+
+static int contains_pre_key(uint32_t pre_key_id, void *user_data)
+{
+    return contains_key(&((party *) user_data)->pre_keys, pre_key_id);
+}
+
+static int remove_pre_key(uint32_t pre_key_id, void *user_data)
+{
+    return remove_key(&((party *) user_data)->pre_keys, pre_key_id);
+}
+
+static int load_signed_pre_key(signal_buffer **record, uint32_t signed_pre_key_id, void *user_data)
+{
+    return load_key(&((party *) user_data)->signed_pre_keys, record, signed_pre_key_id);
+}
+
+static int store_signed_pre_key(uint32_t signed_pre_key_id, uint8_t *record, size_t record_len,
+                                void *user_data)
+{
+    return store_key(&((party *) user_data)->signed_pre_keys, signed_pre_key_id, record, record_len);
+}
+
+static int contains_signed_pre_key(uint32_t signed_pre_key_id, void *user_data)
+{
+    return contains_key(&((party *) user_data)->signed_pre_keys, signed_pre_key_id);
+}
+
+static int remove_signed_pre_key(uint32_t signed_pre_key_id, void *user_data)
+{
+    return remove_key(&((party *) user_data)->signed_pre_keys, signed_pre_key_id);
+}
+
+static int get_identity_key_pair(signal_buffer **public_data, signal_buffer **private_data, void *user_data)
+{
+    party *p = user_data;
+    *public_data = signal_buffer_copy(p->identity_public);
+    *private_data = signal_buffer_copy(p->identity_private);
+    if(!*public_data || !*private_data) {
+        signal_buffer_free(*public_data);
+        signal_buffer_free(*private_data);
+        return SG_ERR_NOMEM;
+    }
+    return 0;
+}
+
+static int get_local_registration_id(void *user_data, uint32_t *registration_id)
+{
+    *registration_id = ((party *) user_data)->registration_id;
+    return 0;
+}
+
+static int save_identity(const signal_protocol_address *address, uint8_t *key_data, size_t key_len,
+                         void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t len = ADDRESS_KEY(key, address);
+    if(len == 0) {
+        return SG_ERR_INVAL;
+    }
+    if(!key_data) {
+        mem_remove(&p->identities, key, len);
+        return 0;
+    }
+    return mem_put(&p->identities, key, len, key_data, key_len);
+}
+
+// Trust on first use, like the app
+static int is_trusted_identity(const signal_protocol_address *address, uint8_t *key_data, size_t key_len,
+                               void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t len = ADDRESS_KEY(key, address);
+    signal_buffer *known = len ? mem_get(&p->identities, key, len) : 0;
+    if(!known) {
+        return 1;
+    }
+    return signal_buffer_len(known) == key_len && memcmp(signal_buffer_data(known), key_data, key_len) == 0;
+}
+
+static int store_sender_key(const signal_protocol_sender_key_name *sender_key_name,
+                            uint8_t *record, size_t record_len,
+                            uint8_t *user_record, size_t user_record_len, void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t key_len = address_key(key, sender_key_name->group_id, sender_key_name->group_id_len,
+                                 sender_key_name->sender.name, sender_key_name->sender.name_len,
+                                 sender_key_name->sender.device_id);
+    return key_len ? mem_put(&p->sender_keys, key, key_len, record, record_len) : SG_ERR_INVAL;
+}
+
+static int load_sender_key(signal_buffer **record, signal_buffer **user_record,
+                           const signal_protocol_sender_key_name *sender_key_name, void *user_data)
+{
+    party *p = user_data;
+    uint8_t key[MAX_KEY_LEN];
+    size_t key_len = address_key(key, sender_key_name->group_id, sender_key_name->group_id_len,
+                                 sender_key_name->sender.name, sender_key_name->sender.name_len,
+                                 sender_key_name->sender.device_id);
+    signal_buffer *found = key_len ? mem_get(&p->sender_keys, key, key_len) : 0;
+    if(!found) {
+        return 0;
+    }
+    *record = signal_buffer_copy(found);
+    return *record ? 1 : SG_ERR_NOMEM;
+}
+
+static int party_init(party *p, const char *name, signal_context *context)
+{
+    int result;
+    memset(p, 0, sizeof(*p));
+    p->name = name;
+    p->next_pre_key_id = 1;
+
+    result = signal_protocol_key_helper_generate_identity_key_pair(&p->identity, context);
+    if(result != 0) goto complete;
+    result = ec_public_key_serialize(&p->identity_public, ratchet_identity_key_pair_get_public(p->identity));
+    if(result != 0) goto complete;
+    result = ec_private_key_serialize(&p->identity_private, ratchet_identity_key_pair_get_private(p->identity));
+    if(result != 0) goto complete;
+    result = signal_protocol_key_helper_generate_registration_id(&p->registration_id, 0, context);
+    if(result != 0) goto complete;
+
+    result = signal_protocol_store_context_create(&p->store, context);
+    if(result != 0) goto complete;
+
+    signal_protocol_session_store session_store = {
+        .load_session_func = load_session,
+        .get_sub_device_sessions_func = get_sub_device_sessions,
+        .store_session_func = store_session,
+        .contains_session_func = contains_session,
+        .delete_session_func = delete_session,
+        .delete_all_sessions_func = delete_all_sessions,
+        .user_data = p
+    };
+    signal_protocol_pre_key_store pre_key_store = {
+        .load_pre_key = load_pre_key,
+        .store_pre_key = store_pre_key,
+        .contains_pre_key = contains_pre_key,
+        .remove_pre_key = remove_pre_key,
+        .user_data = p
+    };
+    signal_protocol_signed_pre_key_store signed_pre_key_store = {
+        .load_signed_pre_key = load_signed_pre_key,
+        .store_signed_pre_key = store_signed_pre_key,
+        .contains_signed_pre_key = contains_signed_pre_key,
+        .remove_signed_pre_key = remove_signed_pre_key,
+        .user_data = p
+    };
+    signal_protocol_identity_key_store identity_key_store = {
+        .get_identity_key_pair = get_identity_key_pair,
+        .get_local_registration_id = get_local_registration_id,
+        .save_identity = save_identity,
+        .is_trusted_identity = is_trusted_identity,
+        .user_data = p
+    };
+    signal_protocol_sender_key_store sender_key_store = {
+        .store_sender_key = store_sender_key,
+        .load_sender_key = load_sender_key,
+        .user_data = p
+    };
+    signal_protocol_store_context_set_session_store(p->store, &session_store);
+    signal_protocol_store_context_set_pre_key_store(p->store, &pre_key_store);
+    signal_protocol_store_context_set_signed_pre_key_store(p->store, &signed_pre_key_store);
+    signal_protocol_store_context_set_identity_key_store(p->store, &identity_key_store);
+    signal_protocol_store_context_set_sender_key_store(p->store, &sender_key_store);
+
+    result = signal_protocol_key_helper_generate_signed_pre_key(&p->signed_pre_key, p->identity, 1,
+                                                                (uint64_t) time(0) * 1000, context);
+    if(result != 0) goto complete;
+    result = signal_protocol_signed_pre_key_store_key(p->store, p->signed_pre_key);
+
+complete:
+    return result;
+}
+
+static void party_destroy(party *p)
+{
+    if(p->store) {
+        signal_protocol_store_context_destroy(p->store);
+    }
+    SIGNAL_UNREF(p->signed_pre_key);
+    SIGNAL_UNREF(p->identity);
+    signal_buffer_free(p->identity_public);
+    signal_buffer_bzero_free(p->identity_private);
+    mem_clear(&p->sessions);
+    mem_clear(&p->pre_keys);
+    mem_clear(&p->signed_pre_keys);
+    mem_clear(&p->identities);
+    mem_clear(&p->sender_keys);
+}
+
+// MARK: Operations
+
+static uint8_t *plaintext;
+static size_t plaintext_len = 256;
+
+static signal_protocol_address address_of(const party *p)
+{
+    signal_protocol_address address = { p->name, strlen(p->name), 1 };
+    return address;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void check(int result, const char *what)
+{
+    if(result < 0) {
+        fprintf(stderr, "%s failed: %d\n", what, result);
+        exit(1);
+    }
+}
+
+// Generates count pre-keys for owner and keeps them in its store, returns
+// the list so the caller can build bundles from it
+static signal_protocol_key_helper_pre_key_list_node *generate_pre_keys(party *owner, unsigned int count)
+{
+    signal_protocol_key_helper_pre_key_list_node *head = 0, *node;
+    unsigned int start = owner->next_pre_key_id;
+    // Pre-key ids are medium, wrap before they run out
+    if(start + count > 0xFFFFFF) {
+        start = 1;
+    }
+    owner->next_pre_key_id = start + count;
+    check(signal_protocol_key_helper_generate_pre_keys(&head, start, count, context), "generate_pre_keys");
+    for(node = head; node; node = signal_protocol_key_helper_key_list_next(node)) {
+        check(signal_protocol_pre_key_store_key(owner->store, signal_protocol_key_helper_key_list_element(node)),
+              "pre_key_store_key");
+    }
+    return head;
+}
+
+static session_pre_key_bundle *bundle_of(party *owner, session_pre_key *pre_key)
+{
+    session_pre_key_bundle *bundle = 0;
+    check(session_pre_key_bundle_create(&bundle, owner->registration_id, 1,
+                                        session_pre_key_get_id(pre_key),
+                                        ec_key_pair_get_public(session_pre_key_get_key_pair(pre_key)),
+                                        session_signed_pre_key_get_id(owner->signed_pre_key),
+                                        ec_key_pair_get_public(session_signed_pre_key_get_key_pair(owner->signed_pre_key)),
+                                        session_signed_pre_key_get_signature(owner->signed_pre_key),
+                                        session_signed_pre_key_get_signature_len(owner->signed_pre_key),
+                                        ratchet_identity_key_pair_get_public(owner->identity)),
+          "session_pre_key_bundle_create");
+    return bundle;
+}
+
+static void process_bundle(party *from, party *to, session_pre_key_bundle *bundle)
+{
+    signal_protocol_address address = address_of(to);
+    session_builder *builder = 0;
+    check(session_builder_create(&builder, from->store, &address, context), "session_builder_create");
+    check(session_builder_process_pre_key_bundle(builder, bundle), "session_builder_process_pre_key_bundle");
+    session_builder_free(builder);
+}
+
+// Returns the serialized message, a pre-key message until to has replied
+static signal_buffer *encrypt(party *from, party *to, int *type)
+{
+    signal_protocol_address address = address_of(to);
+    session_cipher *cipher = 0;
+    ciphertext_message *message = 0;
+    check(session_cipher_create(&cipher, from->store, &address, context), "session_cipher_create");
+    check(session_cipher_encrypt(cipher, plaintext, plaintext_len, &message), "session_cipher_encrypt");
+    signal_buffer *serialized = signal_buffer_copy(ciphertext_message_get_serialized(message));
+    if(type) {
+        *type = ciphertext_message_get_type(message);
+    }
+    SIGNAL_UNREF(message);
+    session_cipher_free(cipher);
+    if(!serialized) {
+        check(SG_ERR_NOMEM, "signal_buffer_copy");
+    }
+    return serialized;
+}
+
+static void decrypt(party *to, party *from, signal_buffer *serialized, int type)
+{
+    signal_protocol_address address = address_of(from);
+    session_cipher *cipher = 0;
+    signal_buffer *output = 0;
+    check(session_cipher_create(&cipher, to->store, &address, context), "session_cipher_create");
+    if(type == CIPHERTEXT_PREKEY_TYPE) {
+        pre_key_signal_message *message = 0;
+        check(pre_key_signal_message_deserialize(&message, signal_buffer_data(serialized),
+                                                 signal_buffer_len(serialized), context),
+              "pre_key_signal_message_deserialize");
+        check(session_cipher_decrypt_pre_key_signal_message(cipher, message, 0, &output),
+              "session_cipher_decrypt_pre_key_signal_message");
+        SIGNAL_UNREF(message);
+    }
+    else {
+        signal_message *message = 0;
+        check(signal_message_deserialize(&message, signal_buffer_data(serialized),
+                                         signal_buffer_len(serialized), context),
+              "signal_message_deserialize");
+        check(session_cipher_decrypt_signal_message(cipher, message, 0, &output),
+              "session_cipher_decrypt_signal_message");
+        SIGNAL_UNREF(message);
+    }
+    if(signal_buffer_len(output) != plaintext_len ||
+       memcmp(signal_buffer_data(output), plaintext, plaintext_len) != 0) {
+        fprintf(stderr, "decrypted message differs\n");
+        exit(1);
+    }
+    signal_buffer_free(output);
+    session_cipher_free(cipher);
+}
+
+// Sets up sessions between a and b and exchanges one message each way, so
+// that later messages are plain signal messages
+static void establish(party *a, party *b)
+{
+    signal_protocol_key_helper_pre_key_list_node *pre_keys = generate_pre_keys(b, 1);
+    session_pre_key_bundle *bundle = bundle_of(b, signal_protocol_key_helper_key_list_element(pre_keys));
+    int type;
+    process_bundle(a, b, bundle);
+    SIGNAL_UNREF(bundle);
+    signal_protocol_key_helper_key_list_free(pre_keys);
+
+    signal_buffer *message = encrypt(a, b, &type);
+    decrypt(b, a, message, type);
+    signal_buffer_free(message);
+    message = encrypt(b, a, &type);
+    decrypt(a, b, message, type);
+    signal_buffer_free(message);
+}
+
+static sender_key_distribution_message *create_sender_key(party *sender, const char *group_id)
+{
+    signal_protocol_sender_key_name name = { group_id, strlen(group_id), address_of(sender) };
+    group_session_builder *builder = 0;
+    sender_key_distribution_message *distribution = 0;
+    check(group_session_builder_create(&builder, sender->store, context), "group_session_builder_create");
+    check(group_session_builder_create_session(builder, &distribution, &name),
+          "group_session_builder_create_session");
+    group_session_builder_free(builder);
+    return distribution;
+}
+
+static void process_sender_key(party *receiver, party *sender, const char *group_id,
+                               sender_key_distribution_message *distribution)
+{
+    signal_protocol_sender_key_name name = { group_id, strlen(group_id), address_of(sender) };
+    group_session_builder *builder = 0;
+    check(group_session_builder_create(&builder, receiver->store, context), "group_session_builder_create");
+    check(group_session_builder_process_session(builder, &name, distribution),
+          "group_session_builder_process_session");
+    group_session_builder_free(builder);
+}
+
+static signal_buffer *group_encrypt(party *sender, const char *group_id)
+{
+    signal_protocol_sender_key_name name = { group_id, strlen(group_id), address_of(sender) };
+    group_cipher *cipher = 0;
+    ciphertext_message *message = 0;
+    check(group_cipher_create(&cipher, sender->store, &name, context), "group_cipher_create");
+    check(group_cipher_encrypt(cipher, plaintext, plaintext_len, &message), "group_cipher_encrypt");
+    signal_buffer *serialized = signal_buffer_copy(ciphertext_message_get_serialized(message));
+    SIGNAL_UNREF(message);
+    group_cipher_free(cipher);
+    if(!serialized) {
+        check(SG_ERR_NOMEM, "signal_buffer_copy");
+    }
+    return serialized;
+}
+
+static void group_decrypt(party *receiver, party *sender, const char *group_id, signal_buffer *serialized)
+{
+    signal_protocol_sender_key_name name = { group_id, strlen(group_id), address_of(sender) };
+    group_cipher *cipher = 0;
+    sender_key_message *message = 0;
+    signal_buffer *output = 0;
+    check(group_cipher_create(&cipher, receiver->store, &name, context), "group_cipher_create");
+    check(sender_key_message_deserialize(&message, signal_buffer_data(serialized),
+                                         signal_buffer_len(serialized), context),
+          "sender_key_message_deserialize");
+    check(group_cipher_decrypt(cipher, message, 0, &output), "group_cipher_decrypt");
+    if(signal_buffer_len(output) != plaintext_len ||
+       memcmp(signal_buffer_data(output), plaintext, plaintext_len) != 0) {
+        fprintf(stderr, "decrypted group message differs\n");
+        exit(1);
+    }
+    signal_buffer_free(output);
+    SIGNAL_UNREF(message);
+    group_cipher_free(cipher);
+}
+
+// MARK: Benchmarks
+
+static party alice, bob;
+
+// Each benchmark runs batches of BATCH operations and times only the
+// operations, not the preparation of their inputs, for RUN_SECONDS
+typedef struct {
+    double seconds;
+    long ops;
+} tally;
+
+static double rate(const tally *t)
+{
+    return t->ops / t->seconds;
+}
+
+static void bench_pre_keys(tally *generate, tally *sign)
+{
+    while(generate->seconds < RUN_SECONDS) {
+        party *p = &alice;
+        double start = now();
+        signal_protocol_key_helper_pre_key_list_node *head = generate_pre_keys(p, BATCH);
+        generate->seconds += now() - start;
+        generate->ops += BATCH;
+        signal_protocol_key_helper_key_list_free(head);
+        mem_clear(&p->pre_keys);
+    }
+    while(sign->seconds < RUN_SECONDS) {
+        int i;
+        double start = now();
+        for(i = 0; i < BATCH; i++) {
+            session_signed_pre_key *key = 0;
+            check(signal_protocol_key_helper_generate_signed_pre_key(&key, alice.identity, (uint32_t) i + 2,
+                                                                     (uint64_t) time(0) * 1000, context),
+                  "generate_signed_pre_key");
+            check(signal_protocol_signed_pre_key_store_key(alice.store, key), "signed_pre_key_store_key");
+            SIGNAL_UNREF(key);
+        }
+        sign->seconds += now() - start;
+        sign->ops += BATCH;
+    }
+}
+
+// Alice fetches a bundle of Bob, sends him the first message and Bob
+// decrypts it, which is what the first message to a new contact costs
+static void bench_session_setup(tally *setup)
+{
+    while(setup->seconds < RUN_SECONDS) {
+        signal_protocol_key_helper_pre_key_list_node *head = generate_pre_keys(&bob, BATCH), *node;
+        for(node = head; node; node = signal_protocol_key_helper_key_list_next(node)) {
+            int type;
+            double start = now();
+            session_pre_key_bundle *bundle = bundle_of(&bob, signal_protocol_key_helper_key_list_element(node));
+            process_bundle(&alice, &bob, bundle);
+            signal_buffer *message = encrypt(&alice, &bob, &type);
+            decrypt(&bob, &alice, message, type);
+            setup->seconds += now() - start;
+            setup->ops++;
+            SIGNAL_UNREF(bundle);
+            signal_buffer_free(message);
+            // Start over instead of archiving up to 40 old states per record
+            mem_clear(&alice.sessions);
+            mem_clear(&bob.sessions);
+        }
+        signal_protocol_key_helper_key_list_free(head);
+    }
+}
+
+static void bench_messages(tally *encrypt_tally, tally *decrypt_tally, tally *ratchet)
+{
+    signal_buffer *messages[BATCH];
+    int i;
+
+    establish(&alice, &bob);
+    while(encrypt_tally->seconds < RUN_SECONDS || decrypt_tally->seconds < RUN_SECONDS) {
+        double start = now();
+        for(i = 0; i < BATCH; i++) {
+            messages[i] = encrypt(&alice, &bob, 0);
+        }
+        double middle = now();
+        for(i = 0; i < BATCH; i++) {
+            decrypt(&bob, &alice, messages[i], CIPHERTEXT_SIGNAL_TYPE);
+        }
+        double end = now();
+        encrypt_tally->seconds += middle - start;
+        encrypt_tally->ops += BATCH;
+        decrypt_tally->seconds += end - middle;
+        decrypt_tally->ops += BATCH;
+        for(i = 0; i < BATCH; i++) {
+            signal_buffer_free(messages[i]);
+        }
+    }
+
+    // Replying turns the ratchet, every message here carries a new ratchet
+    // key and costs a DH step on each side
+    while(ratchet->seconds < RUN_SECONDS) {
+        double start = now();
+        for(i = 0; i < BATCH; i++) {
+            party *from = i % 2 ? &bob : &alice;
+            party *to = i % 2 ? &alice : &bob;
+            signal_buffer *message = encrypt(from, to, 0);
+            decrypt(to, from, message, CIPHERTEXT_SIGNAL_TYPE);
+            signal_buffer_free(message);
+        }
+        ratchet->seconds += now() - start;
+        ratchet->ops += BATCH;
+    }
+    mem_clear(&alice.sessions);
+    mem_clear(&bob.sessions);
+}
+
+static void bench_group(tally *encrypt_tally, tally *decrypt_tally)
+{
+    static const char *group_id = "bench-group";
+    signal_buffer *messages[BATCH];
+    int i;
+
+    sender_key_distribution_message *distribution = create_sender_key(&alice, group_id);
+    process_sender_key(&bob, &alice, group_id, distribution);
+    SIGNAL_UNREF(distribution);
+
+    while(encrypt_tally->seconds < RUN_SECONDS || decrypt_tally->seconds < RUN_SECONDS) {
+        double start = now();
+        for(i = 0; i < BATCH; i++) {
+            messages[i] = group_encrypt(&alice, group_id);
+        }
+        double middle = now();
+        for(i = 0; i < BATCH; i++) {
+            group_decrypt(&bob, &alice, group_id, messages[i]);
+        }
+        double end = now();
+        encrypt_tally->seconds += middle - start;
+        encrypt_tally->ops += BATCH;
+        decrypt_tally->seconds += end - middle;
+        decrypt_tally->ops += BATCH;
+        for(i = 0; i < BATCH; i++) {
+            signal_buffer_free(messages[i]);
+        }
+    }
+}
+
+static void write_seed(const char *dir, const char *name, uint8_t type, const signal_buffer *message)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *file = fopen(path, "wb");
+    if(!file) {
+        perror(path);
+        exit(1);
+    }
+    fwrite(&type, 1, 1, file);
+    fwrite(signal_buffer_data((signal_buffer *) message), 1, signal_buffer_len((signal_buffer *) message), file);
+    fclose(file);
+}
+
+// One message of each type the fuzz target takes, prefixed with its selector
+static void write_corpus(const char *dir)
+{
+    static const char *group_id = "corpus-group";
+    signal_buffer *message;
+    int type;
+
+    signal_protocol_key_helper_pre_key_list_node *pre_keys = generate_pre_keys(&bob, 1);
+    session_pre_key_bundle *bundle = bundle_of(&bob, signal_protocol_key_helper_key_list_element(pre_keys));
+    process_bundle(&alice, &bob, bundle);
+    SIGNAL_UNREF(bundle);
+    signal_protocol_key_helper_key_list_free(pre_keys);
+
+    message = encrypt(&alice, &bob, &type);
+    write_seed(dir, "pre-key-signal-message", 0, message);
+    decrypt(&bob, &alice, message, type);
+    signal_buffer_free(message);
+    message = encrypt(&bob, &alice, &type);
+    write_seed(dir, "signal-message", 1, message);
+    signal_buffer_free(message);
+
+    sender_key_distribution_message *distribution = create_sender_key(&alice, group_id);
+    write_seed(dir, "sender-key-distribution-message", 3,
+               ciphertext_message_get_serialized((ciphertext_message *) distribution));
+    SIGNAL_UNREF(distribution);
+    message = group_encrypt(&alice, group_id);
+    write_seed(dir, "sender-key-message", 2, message);
+    signal_buffer_free(message);
+
+    mem_clear(&alice.sessions);
+    mem_clear(&bob.sessions);
+    mem_clear(&alice.sender_keys);
+}
+
+int main(int argc, char **argv) {
+    const char *corpus_dir = 0;
+    int opt;
+    size_t i;
+
+    while((opt = getopt(argc, argv, "s:c:")) != -1) {
+        switch(opt) {
+            case 's':
+                plaintext_len = strtoul(optarg, 0, 10);
+                break;
+            case 'c':
+                corpus_dir = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-s message_bytes] [-c corpus_dir]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    context = signal_setup();
+    if(!context) {
+        fprintf(stderr, "signal_setup failed\n");
+        return 1;
+    }
+    plaintext = malloc(plaintext_len ? plaintext_len : 1);
+    for(i = 0; i < plaintext_len; i++) {
+        plaintext[i] = (uint8_t) i;
+    }
+    check(party_init(&alice, "alice", context), "party_init");
+    check(party_init(&bob, "bob", context), "party_init");
+
+    if(corpus_dir) {
+        write_corpus(corpus_dir);
+    }
+
+    tally pre_keys = { 0 }, signed_pre_keys = { 0 }, setup = { 0 };
+    tally encrypt_1 = { 0 }, decrypt_1 = { 0 }, ratchet = { 0 };
+    tally encrypt_group = { 0 }, decrypt_group = { 0 };
+    bench_pre_keys(&pre_keys, &signed_pre_keys);
+    bench_session_setup(&setup);
+    bench_messages(&encrypt_1, &decrypt_1, &ratchet);
+    bench_group(&encrypt_group, &decrypt_group);
+
+    printf("%zu byte messages, %ld CPUs\n", plaintext_len, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-22s %14s\n", "operation", "op/s");
+    printf("%-22s %14.0f\n", "pre-key generation", rate(&pre_keys));
+    printf("%-22s %14.0f\n", "signed pre-key", rate(&signed_pre_keys));
+    printf("%-22s %14.0f\n", "session setup", rate(&setup));
+    printf("%-22s %14.0f\n", "1:1 encrypt", rate(&encrypt_1));
+    printf("%-22s %14.0f\n", "1:1 decrypt", rate(&decrypt_1));
+    printf("%-22s %14.0f\n", "1:1 ratchet step", rate(&ratchet));
+    printf("%-22s %14.0f\n", "group encrypt", rate(&encrypt_group));
+    printf("%-22s %14.0f\n", "group decrypt", rate(&decrypt_group));
+
+    party_destroy(&alice);
+    party_destroy(&bob);
+    free(plaintext);
+    signal_destroy(context);
+    return 0;
+}
+
+#else
+
+// MARK: Fuzz target
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if(!context) {
+        context = signal_setup();
+        if(!context) {
+            abort();
+        }
+        // Rejected input is expected here, keep libsignal's warnings quiet
+        signal_log_set_level(-1);
+    }
+    if(size < 1) {
+        return 0;
+    }
+
+    const uint8_t *message = data + 1;
+    size_t len = size - 1;
+    switch(data[0] & 3) {
+        case 0: {
+            pre_key_signal_message *result = 0;
+            if(pre_key_signal_message_deserialize(&result, message, len, context) == 0) {
+                SIGNAL_UNREF(result);
+            }
+            break;
+        }
+        case 1: {
+            signal_message *result = 0;
+            if(signal_message_deserialize(&result, message, len, context) == 0) {
+                SIGNAL_UNREF(result);
+            }
+            break;
+        }
+        case 2: {
+            sender_key_message *result = 0;
+            if(sender_key_message_deserialize(&result, message, len, context) == 0) {
+                SIGNAL_UNREF(result);
+            }
+            break;
+        }
+        case 3: {
+            sender_key_distribution_message *result = 0;
+            if(sender_key_distribution_message_deserialize(&result, message, len, context) == 0) {
+                SIGNAL_UNREF(result);
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+#endif
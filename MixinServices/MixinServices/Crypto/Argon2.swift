@@ -0,0 +1,270 @@
+import Foundation
+
+enum Argon2 {
+    
+    enum Variant {
+        
+        // Data-independent memory access, resistant to side-channel attacks
+        case i
+        
+        // Data-independent access for the first half of the first pass,
+        // data-dependent afterwards for better resistance to tradeoff attacks
+        case id
+        
+        fileprivate var type: argon2_type {
+            switch self {
+            case .i:
+                Argon2_i
+            case .id:
+                Argon2_id
+            }
+        }
+        
+    }
+    
+    struct Error: Swift.Error {
+        
+        let code: Argon2_ErrorCodes.RawValue
+        
+        var isCanceled: Bool {
+            code == ARGON2_CANCELED.rawValue
+        }
+        
+    }
+    
+    // Stops the hashes it's passed to at their next slice boundary. They throw
+    // an error with isCanceled set, and their memory is wiped right away, then
+    // freed unless it belongs to an arena.
+    final class Cancellation: @unchecked Sendable {
+        
+        // Runs body with a cancellation that's canceled along with the current task
+        static func withCurrentTask<Result>(
+            _ body: (Cancellation) throws -> Result
+        ) async rethrows -> Result {
+            let cancellation = Cancellation()
+            return try await withTaskCancellationHandler {
+                try body(cancellation)
+            } onCancel: {
+                cancellation.cancel()
+            }
+        }
+        
+        private let lock = NSLock()
+        
+        private var canceled = false
+        
+        var isCanceled: Bool {
+            lock.lock()
+            defer {
+                lock.unlock()
+            }
+            return canceled
+        }
+        
+        func cancel() {
+            lock.lock()
+            canceled = true
+            lock.unlock()
+        }
+        
+    }
+    
+    // Reported on the hashing thread after each slice of every pass, a pass
+    // is made of 4 slices
+    struct Progress {
+        
+        let pass: UInt32
+        let slice: UInt32
+        let passes: UInt32
+        
+        var fractionCompleted: Double {
+            Double(pass * 4 + slice + 1) / Double(passes * 4)
+        }
+        
+    }
+    
+    private final class Observer {
+        
+        let passes: UInt32
+        let cancellation: Cancellation?
+        let progress: ((Progress) -> Void)?
+        
+        init(passes: UInt32, cancellation: Cancellation?, progress: ((Progress) -> Void)?) {
+            self.passes = passes
+            self.cancellation = cancellation
+            self.progress = progress
+        }
+        
+        // Returns false to cancel
+        func report(pass: UInt32, slice: UInt32) -> Bool {
+            progress?(Progress(pass: pass, slice: slice, passes: passes))
+            return !(cancellation?.isCanceled ?? false)
+        }
+        
+    }
+    
+    // Reusable memory for a series of hashes. Pages are locked into RAM where
+    // possible and reused by subsequent hashes, each of which wipes what it used
+    // before returning. Create one for a flow and let it go when the flow ends,
+    // the locked pages stay resident as long as the arena lives.
+    final class Arena {
+        
+        // Fits a batch of two hashes with default costs, e.g. TIP key derivations
+        static let defaultMemoryCost: UInt32 = 2 * 1024
+        
+        let memoryCost: UInt32
+        let isLocked: Bool
+        
+        private let arena: OpaquePointer
+        private let lock = NSLock()
+        
+        init?(memoryCost: UInt32, lanes: UInt32, hugePages: Bool = false) {
+            let flags = hugePages ? ARGON2_ARENA_HUGE_PAGES.rawValue : 0
+            guard let arena = argon2_arena_create(memoryCost, lanes, flags) else {
+                return nil
+            }
+            self.memoryCost = memoryCost
+            self.isLocked = argon2_arena_flags(arena) & ARGON2_ARENA_LOCKED.rawValue != 0
+            self.arena = arena
+        }
+        
+        deinit {
+            argon2_arena_release(arena)
+        }
+        
+        // Calls body with the arena if it's free and large enough, with nil otherwise
+        fileprivate func withArena<Result>(
+            memoryCost required: UInt32,
+            _ body: (OpaquePointer?) throws -> Result
+        ) rethrows -> Result {
+            if required <= memoryCost, lock.try() {
+                defer {
+                    lock.unlock()
+                }
+                return try body(arena)
+            } else {
+                return try body(nil)
+            }
+        }
+        
+    }
+    
+    static func hash(
+        _ variant: Variant,
+        timeCost: UInt32 = 4,
+        memoryCost: UInt32 = 1024,
+        parallelism: UInt32 = 2,
+        password: Data,
+        salt: Data,
+        hashCount: Int = 32,
+        arena: Arena? = nil,
+        cancellation: Cancellation? = nil,
+        progress: ((Progress) -> Void)? = nil
+    ) throws -> Data {
+        let hashes = try hash(variant,
+                              timeCost: timeCost,
+                              memoryCost: memoryCost,
+                              parallelism: parallelism,
+                              batch: [(password: password, salt: salt)],
+                              hashCount: hashCount,
+                              arena: arena,
+                              cancellation: cancellation,
+                              progress: progress)
+        return hashes[0]
+    }
+    
+    // Hashes independent inputs together, filling the memory of all of them
+    // concurrently out of a single arena instead of one hash after another.
+    // Inputs are filled in lockstep, progress is reported once for all of them.
+    static func hash(
+        _ variant: Variant,
+        timeCost: UInt32 = 4,
+        memoryCost: UInt32 = 1024,
+        parallelism: UInt32 = 2,
+        batch inputs: [(password: Data, salt: Data)],
+        hashCount: Int = 32,
+        arena: Arena? = nil,
+        cancellation: Cancellation? = nil,
+        progress: ((Progress) -> Void)? = nil
+    ) throws -> [Data] {
+        guard !inputs.isEmpty else {
+            return []
+        }
+        if let cancellation, cancellation.isCanceled {
+            throw Error(code: ARGON2_CANCELED.rawValue)
+        }
+        let inputsCount = inputs.reduce(0) { $0 + $1.password.count + $1.salt.count }
+        let buffer = UnsafeMutableRawBufferPointer.allocate(
+            byteCount: inputsCount + inputs.count * hashCount,
+            alignment: MemoryLayout<UInt8>.alignment
+        )
+        defer {
+            buffer.initializeMemory(as: UInt8.self, repeating: 0)
+            buffer.deallocate()
+        }
+        
+        var offset = 0
+        func copy(_ data: Data) -> UnsafeMutablePointer<UInt8> {
+            let pointer = buffer.baseAddress!.advanced(by: offset)
+            data.copyBytes(to: pointer.assumingMemoryBound(to: UInt8.self), count: data.count)
+            offset += data.count
+            return pointer.assumingMemoryBound(to: UInt8.self)
+        }
+        var contexts = inputs.map { input in
+            var context = argon2_context()
+            context.pwd = copy(input.password)
+            context.pwdlen = UInt32(input.password.count)
+            context.salt = copy(input.salt)
+            context.saltlen = UInt32(input.salt.count)
+            context.t_cost = timeCost
+            context.m_cost = memoryCost
+            context.lanes = parallelism
+            context.threads = parallelism
+            context.version = ARGON2_VERSION_NUMBER.rawValue
+            return context
+        }
+        let outputs = offset
+        for i in contexts.indices {
+            contexts[i].out = buffer.baseAddress!
+                .advanced(by: outputs + i * hashCount)
+                .assumingMemoryBound(to: UInt8.self)
+            contexts[i].outlen = UInt32(hashCount)
+        }
+        
+        // Canceling one instance stops the whole batch, so the first one
+        // reports for all of them
+        let observer: Observer? = if cancellation != nil || progress != nil {
+            Observer(passes: timeCost, cancellation: cancellation, progress: progress)
+        } else {
+            nil
+        }
+        if let observer {
+            contexts[0].progress_cbk = { context, pass, slice in
+                let observer = Unmanaged<Observer>.fromOpaque(context!).takeUnretainedValue()
+                return observer.report(pass: pass, slice: slice) ? 0 : 1
+            }
+            contexts[0].progress_ctx = Unmanaged.passUnretained(observer).toOpaque()
+        }
+        
+        // Each instance uses at least 8 blocks per lane
+        let requiredMemoryCost = max(memoryCost, 8 * parallelism) * UInt32(contexts.count)
+        let result = { (arena: OpaquePointer?) in
+            argon2_ctx_batch(&contexts, UInt32(contexts.count), variant.type, arena)
+        }
+        let code = withExtendedLifetime(observer) {
+            if let arena {
+                arena.withArena(memoryCost: requiredMemoryCost, result)
+            } else {
+                result(nil)
+            }
+        }
+        if code == ARGON2_OK.rawValue {
+            return contexts.indices.map { i in
+                Data(buffer[(outputs + i * hashCount)..<(outputs + (i + 1) * hashCount)])
+            }
+        } else {
+            throw Error(code: code)
+        }
+    }
+    
+}
@@ -0,0 +1,192 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <mach/vm_statistics.h>
+#endif
+#endif
+
+#include "argon2.h"
+#include "core.h"
+
+/*
+ * Reusable memory for the block matrix. The pages are mapped once and locked
+ * into RAM so that the blocks never reach swap. Every hash wipes the part it
+ * used before returning, so an idle arena holds nothing derived from a
+ * password. Hashes computed with an arena skip the allocator and never fault
+ * pages in again.
+ */
+
+#define ARGON2_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+struct Argon2_arena {
+    uint8_t *memory;    /* Memory pointer */
+    size_t size;        /* Usable size in bytes */
+    size_t mapped_size; /* Size of the mapping, rounded up to pages */
+    uint32_t flags;     /* ARGON2_ARENA_* flags actually in effect */
+};
+
+static size_t round_up(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+static size_t page_size(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : 4096;
+#endif
+}
+
+static uint8_t *map_pages(size_t size, int huge_pages) {
+#if defined(_WIN32)
+    if (huge_pages) {
+        return NULL;
+    }
+    return VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    void *memory = MAP_FAILED;
+    if (huge_pages) {
+#if defined(MAP_HUGETLB)
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#elif defined(__APPLE__) && defined(VM_FLAGS_SUPERPAGE_SIZE_2MB)
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANON, VM_FLAGS_SUPERPAGE_SIZE_2MB, 0);
+#endif
+    } else {
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANON, -1, 0);
+    }
+    return memory == MAP_FAILED ? NULL : memory;
+#endif
+}
+
+static void unmap_pages(uint8_t *memory, size_t size) {
+#if defined(_WIN32)
+    (void)size;
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
+
+static int lock_pages(uint8_t *memory, size_t size) {
+#if defined(_WIN32)
+    return VirtualLock(memory, size) ? 0 : -1;
+#else
+    return mlock(memory, size);
+#endif
+}
+
+static void unlock_pages(uint8_t *memory, size_t size) {
+#if defined(_WIN32)
+    VirtualUnlock(memory, size);
+#else
+    munlock(memory, size);
+#endif
+}
+
+argon2_arena *argon2_arena_create(uint32_t m_cost, uint32_t lanes,
+                                  uint32_t flags) {
+    argon2_arena *arena;
+    uint32_t memory_blocks = m_cost;
+    size_t size;
+
+    if (lanes < ARGON2_MIN_LANES || lanes > ARGON2_MAX_LANES) {
+        return NULL;
+    }
+    /* Same alignment as the instance will apply */
+    if (memory_blocks < 2 * ARGON2_SYNC_POINTS * lanes) {
+        memory_blocks = 2 * ARGON2_SYNC_POINTS * lanes;
+    }
+    size = (size_t)memory_blocks * ARGON2_BLOCK_SIZE;
+
+    arena = calloc(1, sizeof(argon2_arena));
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->size = size;
+
+    if (flags & ARGON2_ARENA_HUGE_PAGES) {
+        arena->mapped_size = round_up(size, ARGON2_HUGE_PAGE_SIZE);
+        arena->memory = map_pages(arena->mapped_size, 1);
+        if (arena->memory != NULL) {
+            arena->flags |= ARGON2_ARENA_HUGE_PAGES;
+        }
+    }
+    if (arena->memory == NULL) {
+        arena->mapped_size = round_up(size, page_size());
+        arena->memory = map_pages(arena->mapped_size, 0);
+    }
+    if (arena->memory == NULL) {
+        free(arena);
+        return NULL;
+    }
+
+#if defined(MADV_DONTDUMP)
+    madvise(arena->memory, arena->mapped_size, MADV_DONTDUMP);
+#endif
+
+    if (lock_pages(arena->memory, arena->mapped_size) == 0) {
+        arena->flags |= ARGON2_ARENA_LOCKED;
+    } else if (flags & ARGON2_ARENA_LOCKED) {
+        unmap_pages(arena->memory, arena->mapped_size);
+        free(arena);
+        return NULL;
+    }
+
+    return arena;
+}
+
+uint32_t argon2_arena_flags(const argon2_arena *arena) {
+    return arena != NULL ? arena->flags : 0;
+}
+
+void argon2_arena_release(argon2_arena *arena) {
+    if (arena == NULL) {
+        return;
+    }
+    secure_wipe_memory(arena->memory, arena->mapped_size);
+    if (arena->flags & ARGON2_ARENA_LOCKED) {
+        unlock_pages(arena->memory, arena->mapped_size);
+    }
+    unmap_pages(arena->memory, arena->mapped_size);
+    free(arena);
+}
+
+int arena_claim(argon2_arena *arena, block **memory, size_t blocks) {
+    if (arena == NULL || memory == NULL) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+    if (blocks > arena->size / sizeof(block)) {
+        return ARGON2_MEMORY_TOO_MUCH;
+    }
+    *memory = (block *)arena->memory;
+    return ARGON2_OK;
+}
@@ -20,6 +20,7 @@
 #include <stdio.h>
 
 #include "argon2.h"
+#include "ct_base64.h"
 #include "encoding.h"
 #include "core.h"
 
@@ -36,21 +37,11 @@ const char *argon2_type2string(argon2_type type, int uppercase) {
     return NULL;
 }
 
-int argon2_ctx(argon2_context *context, argon2_type type) {
-    /* 1. Validate all inputs */
-    int result = validate_inputs(context);
+/* Derives the instance parameters of @context */
+static void init_instance(argon2_instance_t *instance,
+                          const argon2_context *context, argon2_type type) {
     uint32_t memory_blocks, segment_length;
-    argon2_instance_t instance;
-
-    if (ARGON2_OK != result) {
-        return result;
-    }
 
-    if (Argon2_d != type && Argon2_i != type && Argon2_id != type) {
-        return ARGON2_INCORRECT_TYPE;
-    }
-
-    /* 2. Align memory size */
     /* Minimum memory_blocks = 8L blocks, where L is the number of lanes */
     memory_blocks = context->m_cost;
 
@@ -62,20 +53,38 @@ int argon2_ctx(argon2_context *context, argon2_type type) {
     /* Ensure that all segments have equal length */
     memory_blocks = segment_length * (context->lanes * ARGON2_SYNC_POINTS);
 
-    instance.version = context->version;
-    instance.memory = NULL;
-    instance.passes = context->t_cost;
-    instance.memory_blocks = memory_blocks;
-    instance.segment_length = segment_length;
-    instance.lane_length = segment_length * ARGON2_SYNC_POINTS;
-    instance.lanes = context->lanes;
-    instance.threads = context->threads;
-    instance.type = type;
+    instance->version = context->version;
+    instance->memory = NULL;
+    instance->passes = context->t_cost;
+    instance->memory_blocks = memory_blocks;
+    instance->segment_length = segment_length;
+    instance->lane_length = segment_length * ARGON2_SYNC_POINTS;
+    instance->lanes = context->lanes;
+    instance->threads = context->threads;
+    instance->type = type;
+    instance->fill_block = selected_fill_block();
+
+    if (instance->threads > instance->lanes) {
+        instance->threads = instance->lanes;
+    }
+}
+
+int argon2_ctx(argon2_context *context, argon2_type type) {
+    /* 1. Validate all inputs */
+    int result = validate_inputs(context);
+    argon2_instance_t instance;
+
+    if (ARGON2_OK != result) {
+        return result;
+    }
 
-    if (instance.threads > instance.lanes) {
-        instance.threads = instance.lanes;
+    if (Argon2_d != type && Argon2_i != type && Argon2_id != type) {
+        return ARGON2_INCORRECT_TYPE;
     }
 
+    /* 2. Align memory size */
+    init_instance(&instance, context, type);
+
     /* 3. Initialization: Hashing inputs, allocating memory, filling first
      * blocks
      */
@@ -89,6 +98,9 @@ int argon2_ctx(argon2_context *context, argon2_type type) {
     result = fill_memory_blocks(&instance);
 
     if (ARGON2_OK != result) {
+        /* Canceled or failed, the memory is not needed anymore */
+        free_memory(context, (uint8_t *)instance.memory,
+                    instance.memory_blocks, sizeof(block));
         return result;
     }
     /* 5. Finalization */
@@ -97,6 +109,124 @@ int argon2_ctx(argon2_context *context, argon2_type type) {
     return ARGON2_OK;
 }
 
+int argon2_ctx_arena(argon2_context *context, argon2_type type,
+                     argon2_arena *arena) {
+    /* 1. Validate all inputs */
+    int result = validate_inputs(context);
+    argon2_instance_t instance;
+
+    if (ARGON2_OK != result) {
+        return result;
+    }
+
+    if (Argon2_d != type && Argon2_i != type && Argon2_id != type) {
+        return ARGON2_INCORRECT_TYPE;
+    }
+
+    /* 2. Align memory size and take the memory of the arena */
+    init_instance(&instance, context, type);
+    result = arena_claim(arena, &instance.memory, instance.memory_blocks);
+    if (ARGON2_OK != result) {
+        return result;
+    }
+
+    /* 3. Initialization */
+    result = initialize(&instance, context);
+
+    /* 4. Filling memory */
+    if (ARGON2_OK == result) {
+        result = fill_memory_blocks(&instance);
+    }
+
+    /* 5. Finalization */
+    if (ARGON2_OK == result) {
+        finalize(context, &instance);
+    }
+
+    /* Nothing derived from the password stays in the arena between hashes */
+    clear_internal_memory(instance.memory,
+                          instance.memory_blocks * sizeof(block));
+    return result;
+}
+
+int argon2_ctx_batch(argon2_context *contexts, uint32_t count,
+                     argon2_type type, argon2_arena *arena) {
+    argon2_instance_t *instances = NULL;
+    block *memory = NULL;
+    size_t total_blocks = 0, offset = 0;
+    uint32_t i;
+    int result = ARGON2_OK;
+
+    if (contexts == NULL || count == 0) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+
+    if (Argon2_d != type && Argon2_i != type && Argon2_id != type) {
+        return ARGON2_INCORRECT_TYPE;
+    }
+
+    /* 1. Validate all inputs */
+    for (i = 0; i < count; ++i) {
+        result = validate_inputs(&contexts[i]);
+        if (ARGON2_OK != result) {
+            return result;
+        }
+    }
+
+    instances = calloc(count, sizeof(argon2_instance_t));
+    if (instances == NULL) {
+        return ARGON2_MEMORY_ALLOCATION_ERROR;
+    }
+
+    /* 2. Align memory sizes and carve all instances out of a single arena */
+    for (i = 0; i < count; ++i) {
+        init_instance(&instances[i], &contexts[i], type);
+        total_blocks += instances[i].memory_blocks;
+    }
+
+    if (arena != NULL) {
+        result = arena_claim(arena, &memory, total_blocks);
+    } else {
+        result = allocate_memory(&contexts[0], (uint8_t **)&memory,
+                                 total_blocks, sizeof(block));
+    }
+    if (ARGON2_OK != result) {
+        goto fail;
+    }
+
+    /* 3. Initialization */
+    for (i = 0; i < count; ++i) {
+        instances[i].memory = memory + offset;
+        offset += instances[i].memory_blocks;
+        result = initialize(&instances[i], &contexts[i]);
+        if (ARGON2_OK != result) {
+            goto fail;
+        }
+    }
+
+    /* 4. Filling memory of all instances together */
+    result = fill_memory_blocks_batch(instances, count);
+    if (ARGON2_OK != result) {
+        goto fail;
+    }
+
+    /* 5. Finalization, the memory is wiped once below */
+    for (i = 0; i < count; ++i) {
+        finalize(&contexts[i], &instances[i]);
+    }
+
+fail:
+    if (arena != NULL && memory != NULL) {
+        clear_internal_memory(memory, total_blocks * sizeof(block));
+    }
+    if (arena == NULL && memory != NULL) {
+        free_memory(&contexts[0], (uint8_t *)memory, total_blocks,
+                    sizeof(block));
+    }
+    free(instances);
+    return result;
+}
+
 int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
                 const uint32_t parallelism, const void *pwd,
                 const size_t pwdlen, const void *salt, const size_t saltlen,
@@ -146,6 +276,9 @@ int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
     context.allocate_cbk = NULL;
     context.free_cbk = NULL;
     context.flags = ARGON2_DEFAULT_FLAGS;
+    context.progress_cbk = NULL;
+    context.progress_ctx = NULL;
+    context.cancel = NULL;
     context.version = version;
 
     result = argon2_ctx(&context, type);
@@ -246,6 +379,55 @@ static int argon2_compare(const uint8_t *b1, const uint8_t *b2, size_t len) {
     return (int)((1 & ((d - 1) >> 8)) - 1);
 }
 
+/* Longest salt and output verify_encoded handles on the stack */
+#define ARGON2_VERIFY_STACK_LEN 64
+
+/*
+ * Verifies without heap copies of the encoded fields: the salt is decoded on
+ * the stack, and the computed output is encoded and compared with the encoded
+ * one in constant time. Returns ARGON2_DECODING_FAIL for strings it can't
+ * handle, which argon2_verify then decodes the regular way.
+ */
+static int verify_encoded(const char *encoded, const void *pwd,
+                          const size_t pwdlen, argon2_type type) {
+    argon2_context ctx;
+    uint8_t salt[ARGON2_VERIFY_STACK_LEN];
+    uint8_t out[ARGON2_VERIFY_STACK_LEN];
+    char out_b64[(ARGON2_VERIFY_STACK_LEN + 2) / 3 * 4 + 1];
+    const char *expected = NULL;
+    size_t expected_len = 0;
+    int ret;
+
+    ctx.salt = salt;
+    ctx.saltlen = sizeof(salt);
+    ctx.out = out;
+    ctx.outlen = sizeof(out);
+    ctx.pwd = CONST_CAST(uint8_t *)pwd;
+    ctx.pwdlen = (uint32_t)pwdlen;
+
+    ret = decode_string_params(&ctx, encoded, type, &expected, &expected_len);
+    if (ret != ARGON2_OK) {
+        return ret;
+    }
+
+    ret = argon2_ctx(&ctx, type);
+    if (ret != ARGON2_OK) {
+        goto fail;
+    }
+
+    if (ct_base64_encode(out_b64, sizeof(out_b64), out, ctx.outlen,
+                         CT_BASE64_STANDARD_NO_PADDING) != expected_len ||
+        argon2_compare((const uint8_t *)out_b64, (const uint8_t *)expected,
+                       expected_len) != 0) {
+        ret = ARGON2_VERIFY_MISMATCH;
+    }
+
+fail:
+    clear_internal_memory(out, sizeof(out));
+    clear_internal_memory(out_b64, sizeof(out_b64));
+    return ret;
+}
+
 int argon2_verify(const char *encoded, const void *pwd, const size_t pwdlen,
                   argon2_type type) {
 
@@ -270,6 +452,13 @@ int argon2_verify(const char *encoded, const void *pwd, const size_t pwdlen,
         return ARGON2_DECODING_FAIL;
     }
 
+    /* Common lengths need no allocation */
+    ret = verify_encoded(encoded, pwd, pwdlen, type);
+    if (ret != ARGON2_DECODING_FAIL) {
+        return ret;
+    }
+    ret = ARGON2_OK;
+
     /* No field can be longer than the encoded length */
     max_field_len = (uint32_t)encoded_len;
 
@@ -439,6 +628,8 @@ const char *argon2_error_message(int error_code) {
         return "Some of encoded parameters are too long or too short";
     case ARGON2_VERIFY_MISMATCH:
         return "The password does not match the supplied hash";
+    case ARGON2_CANCELED:
+        return "Hashing was canceled";
     default:
         return "Unknown error code";
     }
@@ -78,8 +78,17 @@ ARGON2_LOCAL int blake2b_final(blake2b_state *S, void *out, size_t outlen);
 ARGON2_LOCAL int blake2b(void *out, size_t outlen, const void *in, size_t inlen,
                          const void *key, size_t keylen);
 
+/* Multi-buffer API: four unkeyed messages hashed at once */
+ARGON2_LOCAL int blake2b_x4(void *out[4], size_t outlen,
+                            const void *const in[4], const size_t inlen[4]);
+
 /* Argon2 Team - Begin Code */
 ARGON2_LOCAL int blake2b_long(void *out, size_t outlen, const void *in, size_t inlen);
+
+/* Longest input blake2b_long_x4 hashes side by side */
+#define BLAKE2B_LONG_X4_MAX_INLEN 256
+ARGON2_LOCAL int blake2b_long_x4(void *out[4], size_t outlen,
+                                 const void *const in[4], size_t inlen);
 /* Argon2 Team - End Code */
 
 #if defined(__cplusplus)
@@ -21,6 +21,7 @@
 
 #include "blake2.h"
 #include "blake2-impl.h"
+#include "blamka-round-opt.h"
 
 static const uint64_t blake2b_IV[8] = {
     UINT64_C(0x6a09e667f3bcc908), UINT64_C(0xbb67ae8584caa73b),
@@ -163,7 +164,7 @@ int blake2b_init_key(blake2b_state *S, size_t outlen, const void *key,
     return 0;
 }
 
-static void blake2b_compress(blake2b_state *S, const uint8_t *block) {
+static void blake2b_compress_ref(blake2b_state *S, const uint8_t *block) {
     uint64_t m[16];
     uint64_t v[16];
     unsigned int i, r;
@@ -221,6 +222,218 @@ static void blake2b_compress(blake2b_state *S, const uint8_t *block) {
 #undef ROUND
 }
 
+/*
+ * Vectorized compression functions. The message schedule is unrolled, so the
+ * sigma lookups are resolved at compile time and every round loads its message
+ * words straight into vectors.
+ */
+
+#define BLAKE2B_G1(isa, A0, B0, C0, D0, A1, B1, C1, D1, M0, M1)                \
+    do {                                                                       \
+        A0 = isa##_add(isa##_add(A0, B0), M0);                                 \
+        A1 = isa##_add(isa##_add(A1, B1), M1);                                 \
+        D0 = isa##_rotr(isa##_xor(D0, A0), 32);                                \
+        D1 = isa##_rotr(isa##_xor(D1, A1), 32);                                \
+        C0 = isa##_add(C0, D0);                                                \
+        C1 = isa##_add(C1, D1);                                                \
+        B0 = isa##_rotr(isa##_xor(B0, C0), 24);                                \
+        B1 = isa##_rotr(isa##_xor(B1, C1), 24);                                \
+    } while ((void)0, 0)
+
+#define BLAKE2B_G2(isa, A0, B0, C0, D0, A1, B1, C1, D1, M0, M1)                \
+    do {                                                                       \
+        A0 = isa##_add(isa##_add(A0, B0), M0);                                 \
+        A1 = isa##_add(isa##_add(A1, B1), M1);                                 \
+        D0 = isa##_rotr(isa##_xor(D0, A0), 16);                                \
+        D1 = isa##_rotr(isa##_xor(D1, A1), 16);                                \
+        C0 = isa##_add(C0, D0);                                                \
+        C1 = isa##_add(C1, D1);                                                \
+        B0 = isa##_rotr(isa##_xor(B0, C0), 63);                                \
+        B1 = isa##_rotr(isa##_xor(B1, C1), 63);                                \
+    } while ((void)0, 0)
+
+#define SIGMA_M(r, i) m[blake2b_sigma[r][i]]
+
+/* One round on 128-bit vectors, laid out as in blamka-round-opt.h */
+#define BLAKE2B_ROUND_128(isa, r)                                              \
+    do {                                                                       \
+        BLAKE2B_G1(isa, a0, b0, c0, d0, a1, b1, c1, d1,                        \
+                   isa##_set(SIGMA_M(r, 0), SIGMA_M(r, 2)),                    \
+                   isa##_set(SIGMA_M(r, 4), SIGMA_M(r, 6)));                   \
+        BLAKE2B_G2(isa, a0, b0, c0, d0, a1, b1, c1, d1,                        \
+                   isa##_set(SIGMA_M(r, 1), SIGMA_M(r, 3)),                    \
+                   isa##_set(SIGMA_M(r, 5), SIGMA_M(r, 7)));                   \
+        BLAMKA_DIAGONALIZE(isa, a0, b0, c0, d0, a1, b1, c1, d1);               \
+        BLAKE2B_G1(isa, a0, b0, c0, d0, a1, b1, c1, d1,                        \
+                   isa##_set(SIGMA_M(r, 8), SIGMA_M(r, 10)),                   \
+                   isa##_set(SIGMA_M(r, 12), SIGMA_M(r, 14)));                 \
+        BLAKE2B_G2(isa, a0, b0, c0, d0, a1, b1, c1, d1,                        \
+                   isa##_set(SIGMA_M(r, 9), SIGMA_M(r, 11)),                   \
+                   isa##_set(SIGMA_M(r, 13), SIGMA_M(r, 15)));                 \
+        BLAMKA_UNDIAGONALIZE(isa, a0, b0, c0, d0, a1, b1, c1, d1);             \
+    } while ((void)0, 0)
+
+#define BLAKE2B_ROUNDS(round, isa)                                             \
+    do {                                                                       \
+        round(isa, 0);                                                         \
+        round(isa, 1);                                                         \
+        round(isa, 2);                                                         \
+        round(isa, 3);                                                         \
+        round(isa, 4);                                                         \
+        round(isa, 5);                                                         \
+        round(isa, 6);                                                         \
+        round(isa, 7);                                                         \
+        round(isa, 8);                                                         \
+        round(isa, 9);                                                         \
+        round(isa, 10);                                                        \
+        round(isa, 11);                                                        \
+    } while ((void)0, 0)
+
+#define BLAKE2B_COMPRESS_128(isa, vec)                                         \
+    static void blake2b_compress_##isa(blake2b_state *S,                       \
+                                       const uint8_t *block) {                 \
+        uint64_t m[16];                                                        \
+        vec a0, a1, b0, b1, c0, c1, d0, d1;                                    \
+        unsigned int i;                                                        \
+                                                                               \
+        for (i = 0; i < 16; ++i) {                                             \
+            m[i] = load64(block + i * sizeof(m[i]));                           \
+        }                                                                      \
+                                                                               \
+        a0 = isa##_load(&S->h[0]);                                             \
+        a1 = isa##_load(&S->h[2]);                                             \
+        b0 = isa##_load(&S->h[4]);                                             \
+        b1 = isa##_load(&S->h[6]);                                             \
+        c0 = isa##_load(&blake2b_IV[0]);                                       \
+        c1 = isa##_load(&blake2b_IV[2]);                                       \
+        d0 = isa##_xor(isa##_load(&blake2b_IV[4]), isa##_load(&S->t[0]));      \
+        d1 = isa##_xor(isa##_load(&blake2b_IV[6]), isa##_load(&S->f[0]));      \
+                                                                               \
+        BLAKE2B_ROUNDS(BLAKE2B_ROUND_128, isa);                                \
+                                                                               \
+        isa##_store(&S->h[0],                                                  \
+                    isa##_xor(isa##_load(&S->h[0]), isa##_xor(a0, c0)));       \
+        isa##_store(&S->h[2],                                                  \
+                    isa##_xor(isa##_load(&S->h[2]), isa##_xor(a1, c1)));       \
+        isa##_store(&S->h[4],                                                  \
+                    isa##_xor(isa##_load(&S->h[4]), isa##_xor(b0, d0)));       \
+        isa##_store(&S->h[6],                                                  \
+                    isa##_xor(isa##_load(&S->h[6]), isa##_xor(b1, d1)));       \
+    }
+
+#if defined(ARGON2_HAVE_NEON)
+BLAKE2B_COMPRESS_128(neon, uint64x2_t)
+#endif
+
+#if defined(ARGON2_HAVE_AVX2)
+
+/*
+ * One row of the state per 256-bit vector. The diagonal step rotates rows B,
+ * C and D across the whole vector instead of swapping halves between pairs.
+ * Message words are gathered with the sigma permutation of each round, laid
+ * out in blake2b_sigma_avx2 as the four vectors a round consumes.
+ */
+static const int32_t blake2b_sigma_avx2[12][16] = {
+    {0, 2, 4, 6, 1, 3, 5, 7, 8, 10, 12, 14, 9, 11, 13, 15},
+    {14, 4, 9, 13, 10, 8, 15, 6, 1, 0, 11, 5, 12, 2, 7, 3},
+    {11, 12, 5, 15, 8, 0, 2, 13, 10, 3, 7, 9, 14, 6, 1, 4},
+    {7, 3, 13, 11, 9, 1, 12, 14, 2, 5, 4, 15, 6, 10, 0, 8},
+    {9, 5, 2, 10, 0, 7, 4, 15, 14, 11, 6, 3, 1, 12, 8, 13},
+    {2, 6, 0, 8, 12, 10, 11, 3, 4, 7, 15, 1, 13, 5, 14, 9},
+    {12, 1, 14, 4, 5, 15, 13, 10, 0, 6, 9, 8, 7, 3, 2, 11},
+    {13, 7, 12, 3, 11, 14, 1, 9, 5, 15, 8, 2, 0, 4, 6, 10},
+    {6, 14, 11, 0, 15, 9, 3, 8, 12, 13, 1, 10, 2, 7, 4, 5},
+    {10, 8, 7, 1, 2, 4, 6, 5, 15, 9, 3, 13, 11, 14, 12, 0},
+    {0, 2, 4, 6, 1, 3, 5, 7, 8, 10, 12, 14, 9, 11, 13, 15},
+    {14, 4, 9, 13, 10, 8, 15, 6, 1, 0, 11, 5, 12, 2, 7, 3},
+};
+
+#define avx2_gather(m, r, i)                                                   \
+    _mm256_i32gather_epi64(                                                    \
+        (const long long *)(m),                                                \
+        _mm_loadu_si128((const __m128i *)&blake2b_sigma_avx2[r][4 * (i)]), 8)
+
+/* Rotations by multiples of 8 bits are byte shuffles */
+#define avx2_rotr_bytes(x, c)                                                  \
+    ((c) == 24 ? _mm256_shuffle_epi8((x), rotr24)                              \
+     : (c) == 16 ? _mm256_shuffle_epi8((x), rotr16)                            \
+                 : avx2_rotr((x), (c)))
+
+#define BLAKE2B_G_256(a, b, c, d, M0, M1)                                      \
+    do {                                                                       \
+        a = avx2_add(avx2_add(a, b), M0);                                      \
+        d = avx2_rotr(avx2_xor(d, a), 32);                                     \
+        c = avx2_add(c, d);                                                    \
+        b = avx2_rotr_bytes(avx2_xor(b, c), 24);                               \
+        a = avx2_add(avx2_add(a, b), M1);                                      \
+        d = avx2_rotr_bytes(avx2_xor(d, a), 16);                               \
+        c = avx2_add(c, d);                                                    \
+        b = avx2_rotr(avx2_xor(b, c), 63);                                     \
+    } while ((void)0, 0)
+
+#define BLAKE2B_ROUND_256(isa, r)                                              \
+    do {                                                                       \
+        BLAKE2B_G_256(a, b, c, d, avx2_gather(m, r, 0), avx2_gather(m, r, 1)); \
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));              \
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));              \
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));              \
+        BLAKE2B_G_256(a, b, c, d, avx2_gather(m, r, 2), avx2_gather(m, r, 3)); \
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));              \
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));              \
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));              \
+    } while ((void)0, 0)
+
+static AVX2_TARGET void blake2b_compress_avx2(blake2b_state *S,
+                                              const uint8_t *block) {
+    const __m256i rotr24 = _mm256_setr_epi8(
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    const __m256i rotr16 = _mm256_setr_epi8(
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    const uint8_t *m = block; /* little-endian, words are gathered in place */
+    __m256i a, b, c, d, h0, h1;
+
+    h0 = _mm256_loadu_si256((const __m256i *)&S->h[0]);
+    h1 = _mm256_loadu_si256((const __m256i *)&S->h[4]);
+    a = h0;
+    b = h1;
+    c = _mm256_loadu_si256((const __m256i *)&blake2b_IV[0]);
+    /* t and f are adjacent in the state */
+    d = avx2_xor(_mm256_loadu_si256((const __m256i *)&blake2b_IV[4]),
+                 _mm256_loadu_si256((const __m256i *)&S->t[0]));
+
+    BLAKE2B_ROUNDS(BLAKE2B_ROUND_256, avx2);
+
+    _mm256_storeu_si256((__m256i *)&S->h[0], avx2_xor(h0, avx2_xor(a, c)));
+    _mm256_storeu_si256((__m256i *)&S->h[4], avx2_xor(h1, avx2_xor(b, d)));
+}
+
+#endif /* ARGON2_HAVE_AVX2 */
+
+/*
+ * Follows the fill_block implementation selected for Argon2. SSE2 has no
+ * compression function of its own, two-word vectors do not beat the scalar
+ * code on x86.
+ */
+static void blake2b_compress(blake2b_state *S, const uint8_t *block) {
+    switch (argon2_selected_impl()) {
+#if defined(ARGON2_HAVE_AVX2)
+    case Argon2_impl_avx2:
+        blake2b_compress_avx2(S, block);
+        return;
+#endif
+#if defined(ARGON2_HAVE_NEON)
+    case Argon2_impl_neon:
+        blake2b_compress_neon(S, block);
+        return;
+#endif
+    default:
+        blake2b_compress_ref(S, block);
+        return;
+    }
+}
+
 int blake2b_update(blake2b_state *S, const void *in, size_t inlen) {
     const uint8_t *pin = (const uint8_t *)in;
 
@@ -329,6 +542,250 @@ fail:
     return ret;
 }
 
+/*
+ * Multi-buffer hashing. Independent messages are hashed side by side, one per
+ * vector lane: vector i of the state holds word i of every message, so the
+ * rounds need neither gathers nor diagonal shuffles. Messages of different
+ * lengths run in lockstep, a lane whose message is done keeps its state.
+ */
+
+#define BLAKE2B_MULTI_MAX_LANES 4
+
+typedef struct blake2b_multi {
+    const uint8_t *in[BLAKE2B_MULTI_MAX_LANES];
+    size_t inlen[BLAKE2B_MULTI_MAX_LANES];
+    size_t blocks[BLAKE2B_MULTI_MAX_LANES];
+    size_t max_blocks;
+    size_t lanes;
+    uint64_t h[8 * BLAKE2B_MULTI_MAX_LANES]; /* h[i * lanes + lane] */
+} blake2b_multi;
+
+static void blake2b_multi_init(blake2b_multi *M, size_t lanes, size_t outlen,
+                               const void *const *in, const size_t *inlen) {
+    size_t i, lane;
+
+    M->lanes = lanes;
+    M->max_blocks = 0;
+    for (lane = 0; lane < lanes; ++lane) {
+        M->in[lane] = (const uint8_t *)in[lane];
+        M->inlen[lane] = inlen[lane];
+        /* An empty message still compresses one (padding) block */
+        M->blocks[lane] = inlen[lane] == 0
+                              ? 1
+                              : (inlen[lane] + BLAKE2B_BLOCKBYTES - 1) /
+                                    BLAKE2B_BLOCKBYTES;
+        if (M->blocks[lane] > M->max_blocks) {
+            M->max_blocks = M->blocks[lane];
+        }
+    }
+    for (i = 0; i < 8; ++i) {
+        for (lane = 0; lane < lanes; ++lane) {
+            M->h[i * lanes + lane] = blake2b_IV[i];
+        }
+    }
+    /* Unkeyed parameter block: digest length, fanout 1, depth 1 */
+    for (lane = 0; lane < lanes; ++lane) {
+        M->h[lane] ^= 0x01010000ULL ^ (uint64_t)outlen;
+    }
+}
+
+/*
+ * Transposes block @k of every message into @words (words[i * lanes + lane])
+ * and sets the counter, finalization flag and activity mask of each lane.
+ */
+static void blake2b_multi_load(const blake2b_multi *M, size_t k,
+                               uint64_t *words, uint64_t *t, uint64_t *f,
+                               uint64_t *active) {
+    uint8_t buffer[BLAKE2B_BLOCKBYTES];
+    size_t i, lane, lanes = M->lanes;
+
+    for (lane = 0; lane < lanes; ++lane) {
+        const uint8_t *block = buffer;
+        if (k < M->blocks[lane]) {
+            size_t offset = k * BLAKE2B_BLOCKBYTES;
+            size_t n = M->inlen[lane] - offset;
+            if (n >= BLAKE2B_BLOCKBYTES) {
+                n = BLAKE2B_BLOCKBYTES;
+                block = M->in[lane] + offset;
+            } else {
+                memset(buffer, 0, sizeof(buffer));
+                if (n > 0) {
+                    memcpy(buffer, M->in[lane] + offset, n);
+                }
+            }
+            t[lane] = (uint64_t)(offset + n);
+            f[lane] = k + 1 == M->blocks[lane] ? (uint64_t)-1 : 0;
+            active[lane] = (uint64_t)-1;
+        } else {
+            memset(buffer, 0, sizeof(buffer));
+            t[lane] = 0;
+            f[lane] = 0;
+            active[lane] = 0;
+        }
+        for (i = 0; i < 16; ++i) {
+            words[i * lanes + lane] = load64(block + i * sizeof(uint64_t));
+        }
+    }
+    clear_internal_memory(buffer, sizeof(buffer));
+}
+
+static void blake2b_multi_output(blake2b_multi *M, void *const *out,
+                                 size_t outlen) {
+    uint8_t buffer[BLAKE2B_OUTBYTES];
+    size_t i, lane;
+
+    for (lane = 0; lane < M->lanes; ++lane) {
+        for (i = 0; i < 8; ++i) {
+            store64(buffer + i * sizeof(uint64_t), M->h[i * M->lanes + lane]);
+        }
+        memcpy(out[lane], buffer, outlen);
+    }
+    clear_internal_memory(buffer, sizeof(buffer));
+    clear_internal_memory(M->h, sizeof(M->h));
+}
+
+#define BLAKE2B_G_MULTI(isa, rotr, a, b, c, d, M0, M1)                         \
+    do {                                                                       \
+        a = isa##_add(isa##_add(a, b), M0);                                    \
+        d = rotr(isa##_xor(d, a), 32);                                         \
+        c = isa##_add(c, d);                                                   \
+        b = rotr(isa##_xor(b, c), 24);                                         \
+        a = isa##_add(isa##_add(a, b), M1);                                    \
+        d = rotr(isa##_xor(d, a), 16);                                         \
+        c = isa##_add(c, d);                                                   \
+        b = rotr(isa##_xor(b, c), 63);                                         \
+    } while ((void)0, 0)
+
+#define BLAKE2B_ROUND_MULTI(isa, rotr, r)                                      \
+    do {                                                                       \
+        BLAKE2B_G_MULTI(isa, rotr, v[0], v[4], v[8], v[12], SIGMA_M(r, 0),     \
+                        SIGMA_M(r, 1));                                        \
+        BLAKE2B_G_MULTI(isa, rotr, v[1], v[5], v[9], v[13], SIGMA_M(r, 2),     \
+                        SIGMA_M(r, 3));                                        \
+        BLAKE2B_G_MULTI(isa, rotr, v[2], v[6], v[10], v[14], SIGMA_M(r, 4),    \
+                        SIGMA_M(r, 5));                                        \
+        BLAKE2B_G_MULTI(isa, rotr, v[3], v[7], v[11], v[15], SIGMA_M(r, 6),    \
+                        SIGMA_M(r, 7));                                        \
+        BLAKE2B_G_MULTI(isa, rotr, v[0], v[5], v[10], v[15], SIGMA_M(r, 8),    \
+                        SIGMA_M(r, 9));                                        \
+        BLAKE2B_G_MULTI(isa, rotr, v[1], v[6], v[11], v[12], SIGMA_M(r, 10),   \
+                        SIGMA_M(r, 11));                                       \
+        BLAKE2B_G_MULTI(isa, rotr, v[2], v[7], v[8], v[13], SIGMA_M(r, 12),    \
+                        SIGMA_M(r, 13));                                       \
+        BLAKE2B_G_MULTI(isa, rotr, v[3], v[4], v[9], v[14], SIGMA_M(r, 14),    \
+                        SIGMA_M(r, 15));                                       \
+    } while ((void)0, 0)
+
+/*
+ * Shared by every vector width: @lanes words per vector, loaded with
+ * isa##_load. A lane that is past its last block XORs nothing into h.
+ */
+#define BLAKE2B_MULTI_BLOCKS(isa, vec, and, rotr, lanes)                       \
+    do {                                                                       \
+        uint64_t words[16 * (lanes)], t[lanes], f[lanes], active[lanes];       \
+        vec h[8], v[16], m[16];                                                \
+        size_t i, k;                                                           \
+                                                                               \
+        for (i = 0; i < 8; ++i) {                                              \
+            h[i] = isa##_load(&M->h[i * (lanes)]);                             \
+        }                                                                      \
+        for (k = 0; k < M->max_blocks; ++k) {                                  \
+            blake2b_multi_load(M, k, words, t, f, active);                     \
+            for (i = 0; i < 16; ++i) {                                         \
+                m[i] = isa##_load(&words[i * (lanes)]);                        \
+            }                                                                  \
+            for (i = 0; i < 8; ++i) {                                          \
+                v[i] = h[i];                                                   \
+                v[i + 8] = isa##_broadcast(blake2b_IV[i]);                     \
+            }                                                                  \
+            v[12] = isa##_xor(v[12], isa##_load(t));                           \
+            v[14] = isa##_xor(v[14], isa##_load(f));                           \
+                                                                               \
+            BLAKE2B_ROUNDS(BLAKE2B_ROUND_MULTI_##isa, isa);                    \
+                                                                               \
+            for (i = 0; i < 8; ++i) {                                          \
+                h[i] = isa##_xor(                                              \
+                    h[i], and(isa##_load(active), isa##_xor(v[i], v[i + 8]))); \
+            }                                                                  \
+        }                                                                      \
+        for (i = 0; i < 8; ++i) {                                              \
+            isa##_store(&M->h[i * (lanes)], h[i]);                             \
+        }                                                                      \
+        clear_internal_memory(words, sizeof(words));                           \
+    } while ((void)0, 0)
+
+#if defined(ARGON2_HAVE_AVX2)
+#define avx2_load(p) _mm256_loadu_si256((const __m256i *)(p))
+#define avx2_store(p, x) _mm256_storeu_si256((__m256i *)(p), (x))
+#define avx2_broadcast(x) _mm256_set1_epi64x((long long)(x))
+#define BLAKE2B_ROUND_MULTI_avx2(isa, r)                                       \
+    BLAKE2B_ROUND_MULTI(avx2, avx2_rotr_bytes, r)
+
+static AVX2_TARGET void blake2b_multi_avx2(blake2b_multi *M) {
+    const __m256i rotr24 = _mm256_setr_epi8(
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+        3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+    const __m256i rotr16 = _mm256_setr_epi8(
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+        2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+    BLAKE2B_MULTI_BLOCKS(avx2, __m256i, _mm256_and_si256, avx2_rotr_bytes, 4);
+}
+#endif
+
+#if defined(ARGON2_HAVE_NEON)
+#define neon_broadcast(x) vdupq_n_u64(x)
+#define BLAKE2B_ROUND_MULTI_neon(isa, r) BLAKE2B_ROUND_MULTI(neon, neon_rotr, r)
+
+static void blake2b_multi_neon(blake2b_multi *M) {
+    BLAKE2B_MULTI_BLOCKS(neon, uint64x2_t, vandq_u64, neon_rotr, 2);
+}
+#endif
+
+int blake2b_x4(void *out[4], size_t outlen, const void *const in[4],
+               const size_t inlen[4]) {
+    blake2b_multi M;
+    unsigned int i;
+
+    /* Verify parameters */
+    if (out == NULL || in == NULL || inlen == NULL || outlen == 0 ||
+        outlen > BLAKE2B_OUTBYTES) {
+        return -1;
+    }
+    for (i = 0; i < 4; ++i) {
+        if (out[i] == NULL || (in[i] == NULL && inlen[i] > 0)) {
+            return -1;
+        }
+    }
+
+    switch (argon2_selected_impl()) {
+#if defined(ARGON2_HAVE_AVX2)
+    case Argon2_impl_avx2:
+        blake2b_multi_init(&M, 4, outlen, in, inlen);
+        blake2b_multi_avx2(&M);
+        blake2b_multi_output(&M, out, outlen);
+        break;
+#endif
+#if defined(ARGON2_HAVE_NEON)
+    case Argon2_impl_neon:
+        for (i = 0; i < 4; i += 2) {
+            blake2b_multi_init(&M, 2, outlen, &in[i], &inlen[i]);
+            blake2b_multi_neon(&M);
+            blake2b_multi_output(&M, &out[i], outlen);
+        }
+        break;
+#endif
+    default:
+        for (i = 0; i < 4; ++i) {
+            if (blake2b(out[i], outlen, in[i], inlen[i], NULL, 0) < 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    clear_internal_memory(&M, sizeof(M));
+    return 0;
+}
+
 /* Argon2 Team - Begin Code */
 int blake2b_long(void *pout, size_t outlen, const void *in, size_t inlen) {
     uint8_t *out = (uint8_t *)pout;
@@ -387,4 +844,93 @@ fail:
     return ret;
 #undef TRY
 }
+
+/*
+ * blake2b_long of four inputs of equal length, producing four outputs of
+ * @outlen bytes. The chains of 64-byte hashes advance in lockstep through
+ * blake2b_x4.
+ */
+int blake2b_long_x4(void *pout[4], size_t outlen, const void *const in[4],
+                    size_t inlen) {
+    uint8_t prefixed[4][sizeof(uint32_t) + BLAKE2B_LONG_X4_MAX_INLEN];
+    uint8_t out_buffer[4][BLAKE2B_OUTBYTES];
+    uint8_t in_buffer[4][BLAKE2B_OUTBYTES];
+    uint8_t *out[4];
+    void *outs[4];
+    const void *ins[4];
+    size_t inlens[4];
+    uint32_t toproduce;
+    unsigned int i;
+    int ret = -1;
+
+    if (outlen > UINT32_MAX) {
+        return -1;
+    }
+
+    /* The prefixed copies live on the stack, longer inputs go one by one */
+    if (inlen > BLAKE2B_LONG_X4_MAX_INLEN) {
+        for (i = 0; i < 4; ++i) {
+            ret = blake2b_long(pout[i], outlen, in[i], inlen);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return 0;
+    }
+
+    for (i = 0; i < 4; ++i) {
+        /* Ensure little-endian byte order! */
+        store32(prefixed[i], (uint32_t)outlen);
+        memcpy(prefixed[i] + sizeof(uint32_t), in[i], inlen);
+        out[i] = (uint8_t *)pout[i];
+        ins[i] = prefixed[i];
+        inlens[i] = sizeof(uint32_t) + inlen;
+    }
+
+#define TRY(statement)                                                         \
+    do {                                                                       \
+        ret = statement;                                                       \
+        if (ret < 0) {                                                         \
+            goto fail;                                                         \
+        }                                                                      \
+    } while ((void)0, 0)
+
+    if (outlen <= BLAKE2B_OUTBYTES) {
+        TRY(blake2b_x4(pout, outlen, ins, inlens));
+    } else {
+        for (i = 0; i < 4; ++i) {
+            outs[i] = out_buffer[i];
+        }
+        TRY(blake2b_x4(outs, BLAKE2B_OUTBYTES, ins, inlens));
+        for (i = 0; i < 4; ++i) {
+            memcpy(out[i], out_buffer[i], BLAKE2B_OUTBYTES / 2);
+            out[i] += BLAKE2B_OUTBYTES / 2;
+            ins[i] = in_buffer[i];
+            inlens[i] = BLAKE2B_OUTBYTES;
+        }
+        toproduce = (uint32_t)outlen - BLAKE2B_OUTBYTES / 2;
+
+        while (toproduce > BLAKE2B_OUTBYTES) {
+            memcpy(in_buffer, out_buffer, sizeof(in_buffer));
+            TRY(blake2b_x4(outs, BLAKE2B_OUTBYTES, ins, inlens));
+            for (i = 0; i < 4; ++i) {
+                memcpy(out[i], out_buffer[i], BLAKE2B_OUTBYTES / 2);
+                out[i] += BLAKE2B_OUTBYTES / 2;
+            }
+            toproduce -= BLAKE2B_OUTBYTES / 2;
+        }
+
+        memcpy(in_buffer, out_buffer, sizeof(in_buffer));
+        TRY(blake2b_x4(outs, toproduce, ins, inlens));
+        for (i = 0; i < 4; ++i) {
+            memcpy(out[i], out_buffer[i], toproduce);
+        }
+    }
+fail:
+    clear_internal_memory(prefixed, sizeof(prefixed));
+    clear_internal_memory(out_buffer, sizeof(out_buffer));
+    clear_internal_memory(in_buffer, sizeof(in_buffer));
+    return ret;
+#undef TRY
+}
 /* Argon2 Team - End Code */
@@ -0,0 +1,194 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+#ifndef BLAKE_ROUND_MKA_OPT_H
+#define BLAKE_ROUND_MKA_OPT_H
+
+#include "blake2-impl.h"
+
+/*
+ * Vectorized BlaMka round. A vector holds two 64-bit words, the 16 words of
+ * a round are kept in 8 vectors laid out as rows of the 4x4 BLAKE2 state:
+ *   A0 = (v0, v1)    A1 = (v2, v3)
+ *   B0 = (v4, v5)    B1 = (v6, v7)
+ *   C0 = (v8, v9)    C1 = (v10, v11)
+ *   D0 = (v12, v13)  D1 = (v14, v15)
+ * The round is written once against the primitives below, each instruction
+ * set provides them with its own prefix:
+ *   isa##_blamka(x, y)     fBlaMka on every 64-bit lane
+ *   isa##_add(x, y)        addition on every 64-bit lane
+ *   isa##_xor(x, y)        bitwise XOR
+ *   isa##_rotr(x, c)       right rotation of every 64-bit lane by c
+ *   isa##_hi_lo(x, y)      (x.hi, y.lo) within every 128-bit lane
+ * The BLAKE2b compression in blake2b.c also loads message words with
+ * isa##_set(lo, hi) and the state with isa##_load(p) / isa##_store(p, x).
+ * 256-bit vectors run two independent rounds, one per 128-bit lane.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+
+#define ARGON2_HAVE_SSE2 1
+
+static BLAKE2_INLINE __m128i sse2_blamka(__m128i x, __m128i y) {
+    const __m128i z = _mm_mul_epu32(x, y);
+    return _mm_add_epi64(_mm_add_epi64(x, y), _mm_add_epi64(z, z));
+}
+
+#define sse2_xor(x, y) _mm_xor_si128((x), (y))
+
+#define sse2_rotr(x, c)                                                        \
+    ((c) == 32 ? _mm_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))               \
+     : (c) == 16                                                               \
+         ? _mm_shufflehi_epi16(                                                \
+               _mm_shufflelo_epi16((x), _MM_SHUFFLE(0, 3, 2, 1)),              \
+               _MM_SHUFFLE(0, 3, 2, 1))                                        \
+     : (c) == 63 ? _mm_xor_si128(_mm_srli_epi64((x), 63),                      \
+                                 _mm_add_epi64((x), (x)))                      \
+                 : _mm_xor_si128(_mm_srli_epi64((x), (c)),                     \
+                                 _mm_slli_epi64((x), 64 - (c))))
+
+#define sse2_hi_lo(x, y)                                                       \
+    _mm_castpd_si128(                                                          \
+        _mm_shuffle_pd(_mm_castsi128_pd(x), _mm_castsi128_pd(y), 1))
+
+/* AVX2 is not part of the x86_64 baseline, code using it is compiled for it
+ * function by function and only called after a runtime check */
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+
+#define ARGON2_HAVE_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+static BLAKE2_INLINE AVX2_TARGET __m256i avx2_blamka(__m256i x, __m256i y) {
+    const __m256i z = _mm256_mul_epu32(x, y);
+    return _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_add_epi64(z, z));
+}
+
+#define avx2_xor(x, y) _mm256_xor_si256((x), (y))
+#define avx2_add(x, y) _mm256_add_epi64((x), (y))
+
+#define avx2_rotr(x, c)                                                        \
+    ((c) == 32 ? _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))            \
+     : (c) == 16                                                               \
+         ? _mm256_shufflehi_epi16(                                             \
+               _mm256_shufflelo_epi16((x), _MM_SHUFFLE(0, 3, 2, 1)),           \
+               _MM_SHUFFLE(0, 3, 2, 1))                                        \
+     : (c) == 63 ? _mm256_xor_si256(_mm256_srli_epi64((x), 63),                \
+                                    _mm256_add_epi64((x), (x)))                \
+                 : _mm256_xor_si256(_mm256_srli_epi64((x), (c)),               \
+                                    _mm256_slli_epi64((x), 64 - (c))))
+
+#define avx2_hi_lo(x, y)                                                       \
+    _mm256_castpd_si256(                                                       \
+        _mm256_shuffle_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(y), 5))
+#endif
+
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+
+#define ARGON2_HAVE_NEON 1
+
+static BLAKE2_INLINE uint64x2_t neon_blamka(uint64x2_t x, uint64x2_t y) {
+    const uint64x2_t z = vmull_u32(vmovn_u64(x), vmovn_u64(y));
+    return vaddq_u64(vaddq_u64(x, y), vaddq_u64(z, z));
+}
+
+#define neon_xor(x, y) veorq_u64((x), (y))
+
+#define neon_rotr(x, c)                                                        \
+    ((c) == 32 ? vreinterpretq_u64_u32(vrev64q_u32(vreinterpretq_u32_u64(x)))  \
+               : vsriq_n_u64(vshlq_n_u64((x), 64 - (c)), (x), (c)))
+
+#define neon_hi_lo(x, y) vextq_u64((x), (y), 1)
+
+#define neon_add(x, y) vaddq_u64((x), (y))
+#define neon_set(lo, hi) vcombine_u64(vcreate_u64(lo), vcreate_u64(hi))
+#define neon_load(p) vld1q_u64((const uint64_t *)(p))
+#define neon_store(p, x) vst1q_u64((uint64_t *)(p), (x))
+
+#endif
+
+#define BLAMKA_G1(isa, A0, B0, C0, D0, A1, B1, C1, D1)                         \
+    do {                                                                       \
+        A0 = isa##_blamka(A0, B0);                                             \
+        A1 = isa##_blamka(A1, B1);                                             \
+        D0 = isa##_rotr(isa##_xor(D0, A0), 32);                                \
+        D1 = isa##_rotr(isa##_xor(D1, A1), 32);                                \
+        C0 = isa##_blamka(C0, D0);                                             \
+        C1 = isa##_blamka(C1, D1);                                             \
+        B0 = isa##_rotr(isa##_xor(B0, C0), 24);                                \
+        B1 = isa##_rotr(isa##_xor(B1, C1), 24);                                \
+    } while ((void)0, 0)
+
+#define BLAMKA_G2(isa, A0, B0, C0, D0, A1, B1, C1, D1)                         \
+    do {                                                                       \
+        A0 = isa##_blamka(A0, B0);                                             \
+        A1 = isa##_blamka(A1, B1);                                             \
+        D0 = isa##_rotr(isa##_xor(D0, A0), 16);                                \
+        D1 = isa##_rotr(isa##_xor(D1, A1), 16);                                \
+        C0 = isa##_blamka(C0, D0);                                             \
+        C1 = isa##_blamka(C1, D1);                                             \
+        B0 = isa##_rotr(isa##_xor(B0, C0), 63);                                \
+        B1 = isa##_rotr(isa##_xor(B1, C1), 63);                                \
+    } while ((void)0, 0)
+
+/* Rotates row B by one word, C by two and D by three, so that the columns
+ * become the diagonals (v0, v5, v10, v15), (v1, v6, v11, v12), ... */
+#define BLAMKA_DIAGONALIZE(isa, A0, B0, C0, D0, A1, B1, C1, D1)                \
+    do {                                                                       \
+        __typeof__(A0) t0, t1;                                                 \
+        t0 = isa##_hi_lo(B0, B1);                                              \
+        t1 = isa##_hi_lo(B1, B0);                                              \
+        B0 = t0;                                                               \
+        B1 = t1;                                                               \
+        t0 = C0;                                                               \
+        C0 = C1;                                                               \
+        C1 = t0;                                                               \
+        t0 = isa##_hi_lo(D1, D0);                                              \
+        t1 = isa##_hi_lo(D0, D1);                                              \
+        D0 = t0;                                                               \
+        D1 = t1;                                                               \
+    } while ((void)0, 0)
+
+#define BLAMKA_UNDIAGONALIZE(isa, A0, B0, C0, D0, A1, B1, C1, D1)              \
+    do {                                                                       \
+        __typeof__(A0) t0, t1;                                                 \
+        t0 = isa##_hi_lo(B1, B0);                                              \
+        t1 = isa##_hi_lo(B0, B1);                                              \
+        B0 = t0;                                                               \
+        B1 = t1;                                                               \
+        t0 = C0;                                                               \
+        C0 = C1;                                                               \
+        C1 = t0;                                                               \
+        t0 = isa##_hi_lo(D0, D1);                                              \
+        t1 = isa##_hi_lo(D1, D0);                                              \
+        D0 = t0;                                                               \
+        D1 = t1;                                                               \
+    } while ((void)0, 0)
+
+#define BLAKE2_ROUND_OPT(isa, A0, A1, B0, B1, C0, C1, D0, D1)                  \
+    do {                                                                       \
+        BLAMKA_G1(isa, A0, B0, C0, D0, A1, B1, C1, D1);                        \
+        BLAMKA_G2(isa, A0, B0, C0, D0, A1, B1, C1, D1);                        \
+        BLAMKA_DIAGONALIZE(isa, A0, B0, C0, D0, A1, B1, C1, D1);               \
+        BLAMKA_G1(isa, A0, B0, C0, D0, A1, B1, C1, D1);                        \
+        BLAMKA_G2(isa, A0, B0, C0, D0, A1, B1, C1, D1);                        \
+        BLAMKA_UNDIAGONALIZE(isa, A0, B0, C0, D0, A1, B1, C1, D1);             \
+    } while ((void)0, 0)
+
+#endif
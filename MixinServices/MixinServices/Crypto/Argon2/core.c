@@ -181,8 +181,10 @@ void finalize(const argon2_context *context, argon2_instance_t *instance) {
         print_tag(context->out, context->outlen);
 #endif
 
-        free_memory(context, (uint8_t *)instance->memory,
-                    instance->memory_blocks, sizeof(block));
+        if (instance->owns_memory) {
+            free_memory(context, (uint8_t *)instance->memory,
+                        instance->memory_blocks, sizeof(block));
+        }
     }
 }
 
@@ -256,9 +258,27 @@ uint32_t index_alpha(const argon2_instance_t *instance,
     return absolute_position;
 }
 
+/* Reports a filled slice to the progress callback and checks the
+ * cancellation flag, all lanes are in sync at this point */
+static int slice_done(const argon2_context *context, uint32_t pass,
+                      uint32_t slice) {
+    if (context == NULL) {
+        return ARGON2_OK;
+    }
+    if (context->progress_cbk != NULL &&
+        context->progress_cbk(context->progress_ctx, pass, slice) != 0) {
+        return ARGON2_CANCELED;
+    }
+    if (context->cancel != NULL && *context->cancel != 0) {
+        return ARGON2_CANCELED;
+    }
+    return ARGON2_OK;
+}
+
 /* Single-threaded version for p=1 case */
 static int fill_memory_blocks_st(argon2_instance_t *instance) {
     uint32_t r, s, l;
+    int result;
 
     for (r = 0; r < instance->passes; ++r) {
         for (s = 0; s < ARGON2_SYNC_POINTS; ++s) {
@@ -266,6 +286,10 @@ static int fill_memory_blocks_st(argon2_instance_t *instance) {
                 argon2_position_t position = {r, l, (uint8_t)s, 0};
                 fill_segment(instance, position);
             }
+            result = slice_done(instance->context_ptr, r, s);
+            if (result != ARGON2_OK) {
+                return result;
+            }
         }
 #ifdef GENKAT
         internal_kat(instance, r); /* Print all memory blocks */
@@ -276,83 +300,32 @@ static int fill_memory_blocks_st(argon2_instance_t *instance) {
 
 #if !defined(ARGON2_NO_THREADS)
 
-#ifdef _WIN32
-static unsigned __stdcall fill_segment_thr(void *thread_data)
-#else
-static void *fill_segment_thr(void *thread_data)
-#endif
-{
-    argon2_thread_data *my_data = thread_data;
-    fill_segment(my_data->instance_ptr, my_data->pos);
-    argon2_thread_exit();
-    return 0;
+static void fill_segment_job(void *job_data, uint32_t lane) {
+    argon2_thread_data *my_data = job_data;
+    argon2_position_t position = my_data->pos;
+    position.lane = lane;
+    fill_segment(my_data->instance_ptr, position);
 }
 
-/* Multi-threaded version for p > 1 case */
+/* Multi-threaded version for p > 1 case, lanes of each slice are filled by
+ * the persistent worker pool which also acts as the barrier between slices */
 static int fill_memory_blocks_mt(argon2_instance_t *instance) {
     uint32_t r, s;
-    argon2_thread_handle_t *thread = NULL;
-    argon2_thread_data *thr_data = NULL;
-    int rc = ARGON2_OK;
-
-    /* 1. Allocating space for threads */
-    thread = calloc(instance->lanes, sizeof(argon2_thread_handle_t));
-    if (thread == NULL) {
-        rc = ARGON2_MEMORY_ALLOCATION_ERROR;
-        goto fail;
-    }
-
-    thr_data = calloc(instance->lanes, sizeof(argon2_thread_data));
-    if (thr_data == NULL) {
-        rc = ARGON2_MEMORY_ALLOCATION_ERROR;
-        goto fail;
-    }
+    argon2_thread_data thr_data;
+    int result;
 
+    thr_data.instance_ptr = instance;
     for (r = 0; r < instance->passes; ++r) {
         for (s = 0; s < ARGON2_SYNC_POINTS; ++s) {
-            uint32_t l, ll;
-
-            /* 2. Calling threads */
-            for (l = 0; l < instance->lanes; ++l) {
-                argon2_position_t position;
-
-                /* 2.1 Join a thread if limit is exceeded */
-                if (l >= instance->threads) {
-                    if (argon2_thread_join(thread[l - instance->threads])) {
-                        rc = ARGON2_THREAD_FAIL;
-                        goto fail;
-                    }
-                }
-
-                /* 2.2 Create thread */
-                position.pass = r;
-                position.lane = l;
-                position.slice = (uint8_t)s;
-                position.index = 0;
-                thr_data[l].instance_ptr =
-                    instance; /* preparing the thread input */
-                memcpy(&(thr_data[l].pos), &position,
-                       sizeof(argon2_position_t));
-                if (argon2_thread_create(&thread[l], &fill_segment_thr,
-                                         (void *)&thr_data[l])) {
-                    /* Wait for already running threads */
-                    for (ll = 0; ll < l; ++ll)
-                        argon2_thread_join(thread[ll]);
-                    rc = ARGON2_THREAD_FAIL;
-                    goto fail;
-                }
-
-                /* fill_segment(instance, position); */
-                /*Non-thread equivalent of the lines above */
+            argon2_position_t position = {r, 0, (uint8_t)s, 0};
+            thr_data.pos = position;
+            if (argon2_thread_pool_run(&fill_segment_job, &thr_data,
+                                       instance->lanes, instance->threads)) {
+                return ARGON2_THREAD_FAIL;
             }
-
-            /* 3. Joining remaining threads */
-            for (l = instance->lanes - instance->threads; l < instance->lanes;
-                 ++l) {
-                if (argon2_thread_join(thread[l])) {
-                    rc = ARGON2_THREAD_FAIL;
-                    goto fail;
-                }
+            result = slice_done(instance->context_ptr, r, s);
+            if (result != ARGON2_OK) {
+                return result;
             }
         }
 
@@ -360,15 +333,7 @@ static int fill_memory_blocks_mt(argon2_instance_t *instance) {
         internal_kat(instance, r); /* Print all memory blocks */
 #endif
     }
-
-fail:
-    if (thread != NULL) {
-        free(thread);
-    }
-    if (thr_data != NULL) {
-        free(thr_data);
-    }
-    return rc;
+    return ARGON2_OK;
 }
 
 #endif /* ARGON2_NO_THREADS */
@@ -385,6 +350,80 @@ int fill_memory_blocks(argon2_instance_t *instance) {
 #endif
 }
 
+/* Maps job @index of a batch step onto an instance and one of its lanes */
+typedef struct Argon2_batch_data {
+    argon2_instance_t *instances;
+    uint32_t count;
+    uint32_t pass;
+    uint8_t slice;
+} argon2_batch_data;
+
+static void fill_segment_batch_job(void *job_data, uint32_t index) {
+    argon2_batch_data *my_data = job_data;
+    uint32_t i;
+
+    for (i = 0; i < my_data->count; ++i) {
+        argon2_instance_t *instance = &my_data->instances[i];
+        if (index < instance->lanes) {
+            if (my_data->pass < instance->passes) {
+                argon2_position_t position = {my_data->pass, index,
+                                              my_data->slice, 0};
+                fill_segment(instance, position);
+            }
+            return;
+        }
+        index -= instance->lanes;
+    }
+}
+
+int fill_memory_blocks_batch(argon2_instance_t *instances, uint32_t count) {
+    argon2_batch_data data;
+    uint32_t i, passes = 0, lanes = 0, threads = 0;
+    int result;
+
+    if (instances == NULL || count == 0) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+    for (i = 0; i < count; ++i) {
+        if (instances[i].lanes == 0) {
+            return ARGON2_INCORRECT_PARAMETER;
+        }
+        if (instances[i].passes > passes) {
+            passes = instances[i].passes;
+        }
+        lanes += instances[i].lanes;
+        threads += instances[i].threads;
+    }
+
+    data.instances = instances;
+    data.count = count;
+    for (data.pass = 0; data.pass < passes; ++data.pass) {
+        for (data.slice = 0; data.slice < ARGON2_SYNC_POINTS; ++data.slice) {
+#if defined(ARGON2_NO_THREADS)
+            for (i = 0; i < lanes; ++i) {
+                fill_segment_batch_job(&data, i);
+            }
+#else
+            if (argon2_thread_pool_run(&fill_segment_batch_job, &data, lanes,
+                                       threads)) {
+                return ARGON2_THREAD_FAIL;
+            }
+#endif
+            /* Canceling any instance stops the whole batch */
+            for (i = 0; i < count; ++i) {
+                if (data.pass < instances[i].passes) {
+                    result = slice_done(instances[i].context_ptr, data.pass,
+                                        data.slice);
+                    if (result != ARGON2_OK) {
+                        return result;
+                    }
+                }
+            }
+        }
+    }
+    return ARGON2_OK;
+}
+
 int validate_inputs(const argon2_context *context) {
     if (NULL == context) {
         return ARGON2_INCORRECT_PARAMETER;
@@ -513,26 +552,46 @@ int validate_inputs(const argon2_context *context) {
 }
 
 void fill_first_blocks(uint8_t *blockhash, const argon2_instance_t *instance) {
-    uint32_t l;
     /* Make the first and second block in each lane as G(H0||0||i) or
-       G(H0||1||i) */
-    uint8_t blockhash_bytes[ARGON2_BLOCK_SIZE];
-    for (l = 0; l < instance->lanes; ++l) {
-
-        store32(blockhash + ARGON2_PREHASH_DIGEST_LENGTH, 0);
-        store32(blockhash + ARGON2_PREHASH_DIGEST_LENGTH + 4, l);
-        blake2b_long(blockhash_bytes, ARGON2_BLOCK_SIZE, blockhash,
-                     ARGON2_PREHASH_SEED_LENGTH);
-        load_block(&instance->memory[l * instance->lane_length + 0],
-                   blockhash_bytes);
-
-        store32(blockhash + ARGON2_PREHASH_DIGEST_LENGTH, 1);
-        blake2b_long(blockhash_bytes, ARGON2_BLOCK_SIZE, blockhash,
-                     ARGON2_PREHASH_SEED_LENGTH);
-        load_block(&instance->memory[l * instance->lane_length + 1],
-                   blockhash_bytes);
-    }
-    clear_internal_memory(blockhash_bytes, ARGON2_BLOCK_SIZE);
+       G(H0||1||i). Block j of the 2 * lanes is lane j / 2, index j % 2; the
+       chains are independent, so four of them are hashed at once */
+    uint8_t inputs[4][ARGON2_PREHASH_SEED_LENGTH];
+    uint8_t blockhash_bytes[4][ARGON2_BLOCK_SIZE];
+    void *outs[4];
+    const void *ins[4];
+    uint32_t blocks = 2 * instance->lanes;
+    uint32_t j, k, n;
+
+    for (k = 0; k < 4; ++k) {
+        outs[k] = blockhash_bytes[k];
+        ins[k] = inputs[k];
+    }
+    for (j = 0; j < blocks; j += n) {
+        n = blocks - j < 4 ? blocks - j : 4;
+        for (k = 0; k < n; ++k) {
+            memcpy(inputs[k], blockhash, ARGON2_PREHASH_DIGEST_LENGTH);
+            store32(inputs[k] + ARGON2_PREHASH_DIGEST_LENGTH, (j + k) % 2);
+            store32(inputs[k] + ARGON2_PREHASH_DIGEST_LENGTH + 4,
+                    (j + k) / 2);
+        }
+        if (n == 4) {
+            blake2b_long_x4(outs, ARGON2_BLOCK_SIZE, ins,
+                            ARGON2_PREHASH_SEED_LENGTH);
+        } else {
+            for (k = 0; k < n; ++k) {
+                blake2b_long(blockhash_bytes[k], ARGON2_BLOCK_SIZE,
+                             inputs[k], ARGON2_PREHASH_SEED_LENGTH);
+            }
+        }
+        for (k = 0; k < n; ++k) {
+            load_block(&instance->memory[((j + k) / 2) *
+                                             instance->lane_length +
+                                         (j + k) % 2],
+                       blockhash_bytes[k]);
+        }
+    }
+    clear_internal_memory(inputs, sizeof(inputs));
+    clear_internal_memory(blockhash_bytes, sizeof(blockhash_bytes));
 }
 
 void initial_hash(uint8_t *blockhash, argon2_context *context,
@@ -618,10 +677,13 @@ int initialize(argon2_instance_t *instance, argon2_context *context) {
     instance->context_ptr = context;
 
     /* 1. Memory allocation */
-    result = allocate_memory(context, (uint8_t **)&(instance->memory),
-                             instance->memory_blocks, sizeof(block));
-    if (result != ARGON2_OK) {
-        return result;
+    instance->owns_memory = instance->memory == NULL;
+    if (instance->owns_memory) {
+        result = allocate_memory(context, (uint8_t **)&(instance->memory),
+                                 instance->memory_blocks, sizeof(block));
+        if (result != ARGON2_OK) {
+            return result;
+        }
     }
 
     /* 2. Initial hashing */
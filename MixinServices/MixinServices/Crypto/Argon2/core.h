@@ -62,6 +62,26 @@ void copy_block(block *dst, const block *src);
 /* XOR @src onto @dst bytewise */
 void xor_block(block *dst, const block *src);
 
+/*
+ * Function fills a new memory block and optionally XORs the old block over the
+ * new one. Implemented by fill_block_ref in ref.c and SIMD variants in opt.c.
+ * @next_block must be initialized.
+ * @param prev_block Pointer to the previous block
+ * @param ref_block Pointer to the reference block
+ * @param next_block Pointer to the block to be constructed
+ * @param with_xor Whether to XOR into the new block (1) or just overwrite (0)
+ * @pre all block pointers must be valid
+ */
+typedef void (*fill_block_fn)(const block *prev_block, const block *ref_block,
+                              block *next_block, int with_xor);
+
+void fill_block_ref(const block *prev_block, const block *ref_block,
+                    block *next_block, int with_xor);
+
+/* Returns the fill_block of the implementation chosen by argon2_select_impl,
+ * the fastest one supported by the running CPU by default */
+fill_block_fn selected_fill_block(void);
+
 /*
  * Argon2 instance: memory pointer, number of passes, amount of memory, type,
  * and derived values.
@@ -70,6 +90,7 @@ void xor_block(block *dst, const block *src);
  */
 typedef struct Argon2_instance_t {
     block *memory;          /* Memory pointer */
+    int owns_memory;        /* whether memory is released by finalize */
     uint32_t version;
     uint32_t passes;        /* Number of passes */
     uint32_t memory_blocks; /* Number of blocks in memory */
@@ -80,6 +101,7 @@ typedef struct Argon2_instance_t {
     argon2_type type;
     int print_internals; /* whether to print the memory blocks */
     argon2_context *context_ptr; /* points back to original context */
+    fill_block_fn fill_block;
 } argon2_instance_t;
 
 /*
@@ -123,6 +145,14 @@ int allocate_memory(const argon2_context *context, uint8_t **memory,
 void free_memory(const argon2_context *context, uint8_t *memory,
                  size_t num, size_t size);
 
+/* Hands out the memory of a caller-supplied arena
+ * @param arena Arena created with argon2_arena_create
+ * @param memory Pointer to the block pointer to set
+ * @param blocks Number of blocks the instance needs
+ * @return ARGON2_OK if the arena is large enough
+ */
+int arena_claim(argon2_arena *arena, block **memory, size_t blocks);
+
 /* Function that securely cleans the memory. This ignores any flags set
  * regarding clearing memory. Usually one just calls clear_internal_memory.
  * @param mem Pointer to the memory
@@ -184,7 +214,8 @@ void fill_first_blocks(uint8_t *blockhash, const argon2_instance_t *instance);
 /*
  * Function allocates memory, hashes the inputs with Blake,  and creates first
  * two blocks. Returns the pointer to the main memory with 2 blocks per lane
- * initialized
+ * initialized. If @instance->memory is already set, it is used as is and left
+ * to the caller to release
  * @param  context  Pointer to the Argon2 internal structure containing memory
  * pointer, and parameters for time and space requirements.
  * @param  instance Current Argon2 instance
@@ -221,8 +252,21 @@ void fill_segment(const argon2_instance_t *instance,
  * Function that fills the entire memory t_cost times based on the first two
  * blocks in each lane
  * @param instance Pointer to the current instance
- * @return ARGON2_OK if successful, @context->state
+ * @return ARGON2_OK if successful, ARGON2_CANCELED if the progress callback or
+ * the cancellation flag of the context stopped it between slices,
+ * @context->state
  */
 int fill_memory_blocks(argon2_instance_t *instance);
 
+/*
+ * Function that fills the memory of several independent instances together,
+ * segments of the same pass and slice are filled concurrently across all
+ * instances
+ * @param instances Array of initialized instances
+ * @param count Number of instances
+ * @return ARGON2_OK if successful, ARGON2_CANCELED if any of the instances was
+ * canceled, @context->state
+ */
+int fill_memory_blocks_batch(argon2_instance_t *instances, uint32_t count);
+
 #endif
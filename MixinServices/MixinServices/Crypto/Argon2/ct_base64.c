@@ -0,0 +1,417 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CT_BASE64_HAVE_NEON 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define CT_BASE64_HAVE_SSSE3 1
+#endif
+
+#include "ct_base64.h"
+
+/*
+ * Scalar code after the Base64 functions of encoding.c by Thomas Pornin, with
+ * the two last characters of the alphabet and the padding made variable. The
+ * vector code converts whole blocks, translating between 6-bit values and
+ * characters with comparisons instead of table lookups, and leaves the tail
+ * and the end of the text to the scalar code.
+ */
+
+/*
+ * Constant-time comparisons over values in the 0..255 range. Returned value is
+ * 0x00 on "false", 0xFF on "true".
+ */
+#define EQ(x, y) ((((0U - ((unsigned)(x) ^ (unsigned)(y))) >> 8) & 0xFF) ^ 0xFF)
+#define GT(x, y) ((((unsigned)(y) - (unsigned)(x)) >> 8) & 0xFF)
+#define GE(x, y) (GT(y, x) ^ 0xFF)
+#define LT(x, y) GT(y, x)
+#define LE(x, y) GE(y, x)
+
+typedef struct Ct_base64_alphabet {
+    unsigned char c62; /* character of value 62 */
+    unsigned char c63; /* character of value 63 */
+    int padded;
+} ct_base64_alphabet;
+
+static ct_base64_alphabet alphabet_of(ct_base64_variant variant) {
+    ct_base64_alphabet alphabet;
+
+    if (variant == CT_BASE64_URLSAFE ||
+        variant == CT_BASE64_URLSAFE_NO_PADDING) {
+        alphabet.c62 = '-';
+        alphabet.c63 = '_';
+    } else {
+        alphabet.c62 = '+';
+        alphabet.c63 = '/';
+    }
+    alphabet.padded =
+        variant == CT_BASE64_STANDARD || variant == CT_BASE64_URLSAFE;
+    return alphabet;
+}
+
+/*
+ * Convert value x (0..63) to corresponding Base64 character.
+ */
+static unsigned char byte_to_char(unsigned x,
+                                  const ct_base64_alphabet *alphabet) {
+    return (unsigned char)((LT(x, 26) & (x + 'A')) |
+                           (GE(x, 26) & LT(x, 52) & (x + ('a' - 26))) |
+                           (GE(x, 52) & LT(x, 62) & (x + ('0' - 52))) |
+                           (EQ(x, 62) & alphabet->c62) |
+                           (EQ(x, 63) & alphabet->c63));
+}
+
+/*
+ * Convert character c (0..255) to the corresponding 6-bit value. If character
+ * c is not a Base64 character, then 0xFF (255) is returned.
+ */
+static unsigned char_to_byte(unsigned c, const ct_base64_alphabet *alphabet) {
+    unsigned x;
+
+    x = (GE(c, 'A') & LE(c, 'Z') & (c - 'A')) |
+        (GE(c, 'a') & LE(c, 'z') & (c - ('a' - 26))) |
+        (GE(c, '0') & LE(c, '9') & (c - ('0' - 52))) |
+        (EQ(c, alphabet->c62) & 62) | (EQ(c, alphabet->c63) & 63);
+    return x | (EQ(x, 0) & (EQ(c, 'A') ^ 0xFF));
+}
+
+#if defined(CT_BASE64_HAVE_SSSE3)
+
+/* Characters of 16 values (0..63), the values are small enough for signed
+ * comparisons */
+static __m128i ssse3_to_chars(__m128i v, const ct_base64_alphabet *alphabet) {
+    __m128i c = _mm_add_epi8(v, _mm_set1_epi8('A'));
+    c = _mm_add_epi8(c, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(25)),
+                                      _mm_set1_epi8('a' - 26 - 'A')));
+    c = _mm_add_epi8(c, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(51)),
+                                      _mm_set1_epi8('0' - 52 - ('a' - 26))));
+    c = _mm_add_epi8(c, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(61)),
+                                      _mm_set1_epi8((char)(alphabet->c62 - 62 -
+                                                           ('0' - 52)))));
+    c = _mm_add_epi8(c, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(62)),
+                                      _mm_set1_epi8((char)(alphabet->c63 -
+                                                           alphabet->c62 - 1))));
+    return c;
+}
+
+/* Characters from lo to hi, bytes of 0x80 and above compare as negative */
+#define ssse3_in_range(c, lo, hi)                                              \
+    _mm_and_si128(_mm_cmpgt_epi8((c), _mm_set1_epi8((lo) - 1)),                \
+                  _mm_cmpgt_epi8(_mm_set1_epi8((hi) + 1), (c)))
+
+/* Values of 16 characters, @valid is 0xFF where the character is Base64 */
+static __m128i ssse3_to_values(__m128i c, const ct_base64_alphabet *alphabet,
+                               __m128i *valid) {
+    const __m128i upper = ssse3_in_range(c, 'A', 'Z');
+    const __m128i lower = ssse3_in_range(c, 'a', 'z');
+    const __m128i digit = ssse3_in_range(c, '0', '9');
+    const __m128i c62 = _mm_cmpeq_epi8(c, _mm_set1_epi8((char)alphabet->c62));
+    const __m128i c63 = _mm_cmpeq_epi8(c, _mm_set1_epi8((char)alphabet->c63));
+    __m128i v;
+
+    v = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+    v = _mm_or_si128(
+        v, _mm_and_si128(lower, _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+    v = _mm_or_si128(
+        v, _mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0' - 52))));
+    v = _mm_or_si128(v, _mm_and_si128(c62, _mm_set1_epi8(62)));
+    v = _mm_or_si128(v, _mm_and_si128(c63, _mm_set1_epi8(63)));
+    *valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                          _mm_or_si128(digit, _mm_or_si128(c62, c63)));
+    return v;
+}
+
+/* Encodes blocks of 12 bytes, returns the number of bytes consumed */
+static size_t encode_blocks(char *dst, const unsigned char *src, size_t len,
+                            const ct_base64_alphabet *alphabet) {
+    const __m128i shuffle =
+        _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    size_t i;
+
+    /* 16 bytes are loaded for every 12 encoded */
+    for (i = 0; len - i >= 16; i += 12, dst += 16) {
+        __m128i in = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *)(src + i)), shuffle);
+        /* Move the four 6-bit fields of every 3 bytes into their own byte */
+        __m128i hi = _mm_mulhi_epu16(
+            _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)),
+            _mm_set1_epi32(0x04000040));
+        __m128i lo = _mm_mullo_epi16(
+            _mm_and_si128(in, _mm_set1_epi32(0x003F03F0)),
+            _mm_set1_epi32(0x01000010));
+        _mm_storeu_si128((__m128i *)dst,
+                         ssse3_to_chars(_mm_or_si128(hi, lo), alphabet));
+    }
+    return i;
+}
+
+/*
+ * Decodes blocks of 16 characters up to the first block with a character
+ * outside the alphabet, returns the number of characters consumed. @dst may
+ * be NULL.
+ */
+static size_t decode_blocks(unsigned char *dst, size_t capacity,
+                            const char *src, size_t len,
+                            const ct_base64_alphabet *alphabet) {
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13,
+                                          12, -1, -1, -1, -1);
+    size_t i, out = 0;
+
+    for (i = 0; len - i >= 16 && capacity - out >= 12; i += 16, out += 12) {
+        __m128i valid, packed;
+        __m128i v = ssse3_to_values(
+            _mm_loadu_si128((const __m128i *)(src + i)), alphabet, &valid);
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            break;
+        }
+        /* Join pairs of values into 12 bits, then pairs of those into 24 */
+        packed = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        packed = _mm_madd_epi16(packed, _mm_set1_epi32(0x00011000));
+        packed = _mm_shuffle_epi8(packed, shuffle);
+        if (dst != NULL) {
+            uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+            _mm_storel_epi64((__m128i *)(dst + out), packed);
+            memcpy(dst + out + 8, &last, sizeof(last));
+        }
+    }
+    return i;
+}
+
+#elif defined(CT_BASE64_HAVE_NEON)
+
+static uint8x16_t neon_to_chars(uint8x16_t v,
+                                const ct_base64_alphabet *alphabet) {
+    uint8x16_t c = vaddq_u8(v, vdupq_n_u8('A'));
+    c = vaddq_u8(c, vandq_u8(vcgtq_u8(v, vdupq_n_u8(25)),
+                             vdupq_n_u8((uint8_t)('a' - 26 - 'A'))));
+    c = vaddq_u8(c, vandq_u8(vcgtq_u8(v, vdupq_n_u8(51)),
+                             vdupq_n_u8((uint8_t)('0' - 52 - ('a' - 26)))));
+    c = vaddq_u8(c, vandq_u8(vcgtq_u8(v, vdupq_n_u8(61)),
+                             vdupq_n_u8((uint8_t)(alphabet->c62 - 62 -
+                                                  ('0' - 52)))));
+    c = vaddq_u8(c, vandq_u8(vcgtq_u8(v, vdupq_n_u8(62)),
+                             vdupq_n_u8((uint8_t)(alphabet->c63 -
+                                                  alphabet->c62 - 1))));
+    return c;
+}
+
+#define neon_in_range(c, lo, hi)                                               \
+    vandq_u8(vcgeq_u8((c), vdupq_n_u8(lo)), vcleq_u8((c), vdupq_n_u8(hi)))
+
+static uint8x16_t neon_to_values(uint8x16_t c,
+                                 const ct_base64_alphabet *alphabet,
+                                 uint8x16_t *valid) {
+    const uint8x16_t upper = neon_in_range(c, 'A', 'Z');
+    const uint8x16_t lower = neon_in_range(c, 'a', 'z');
+    const uint8x16_t digit = neon_in_range(c, '0', '9');
+    const uint8x16_t c62 = vceqq_u8(c, vdupq_n_u8(alphabet->c62));
+    const uint8x16_t c63 = vceqq_u8(c, vdupq_n_u8(alphabet->c63));
+    uint8x16_t v;
+
+    v = vandq_u8(upper, vsubq_u8(c, vdupq_n_u8('A')));
+    v = vorrq_u8(v, vandq_u8(lower, vsubq_u8(c, vdupq_n_u8('a' - 26))));
+    v = vorrq_u8(v, vandq_u8(digit, vaddq_u8(c, vdupq_n_u8(52 - '0'))));
+    v = vorrq_u8(v, vandq_u8(c62, vdupq_n_u8(62)));
+    v = vorrq_u8(v, vandq_u8(c63, vdupq_n_u8(63)));
+    *valid = vandq_u8(*valid, vorrq_u8(vorrq_u8(upper, lower),
+                                       vorrq_u8(digit, vorrq_u8(c62, c63))));
+    return v;
+}
+
+/* Encodes blocks of 48 bytes, de-interleaved into the first, second and third
+ * byte of every 3, returns the number of bytes consumed */
+static size_t encode_blocks(char *dst, const unsigned char *src, size_t len,
+                            const ct_base64_alphabet *alphabet) {
+    const uint8x16_t mask = vdupq_n_u8(0x3F);
+    size_t i;
+
+    for (i = 0; len - i >= 48; i += 48, dst += 64) {
+        uint8x16x3_t in = vld3q_u8(src + i);
+        uint8x16x4_t out;
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vandq_u8(
+            vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+        out.val[2] = vandq_u8(
+            vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+        out.val[3] = vandq_u8(in.val[2], mask);
+        out.val[0] = neon_to_chars(out.val[0], alphabet);
+        out.val[1] = neon_to_chars(out.val[1], alphabet);
+        out.val[2] = neon_to_chars(out.val[2], alphabet);
+        out.val[3] = neon_to_chars(out.val[3], alphabet);
+        vst4q_u8((uint8_t *)dst, out);
+    }
+    return i;
+}
+
+/*
+ * Decodes blocks of 64 characters up to the first block with a character
+ * outside the alphabet, returns the number of characters consumed. @dst may
+ * be NULL.
+ */
+static size_t decode_blocks(unsigned char *dst, size_t capacity,
+                            const char *src, size_t len,
+                            const ct_base64_alphabet *alphabet) {
+    size_t i, out = 0;
+
+    for (i = 0; len - i >= 64 && capacity - out >= 48; i += 64, out += 48) {
+        uint8x16x4_t in = vld4q_u8((const uint8_t *)(src + i));
+        uint8x16_t valid = vdupq_n_u8(0xFF);
+        uint8x16_t a = neon_to_values(in.val[0], alphabet, &valid);
+        uint8x16_t b = neon_to_values(in.val[1], alphabet, &valid);
+        uint8x16_t c = neon_to_values(in.val[2], alphabet, &valid);
+        uint8x16_t d = neon_to_values(in.val[3], alphabet, &valid);
+        uint8x16x3_t bytes;
+        if (vminvq_u8(valid) != 0xFF) {
+            break;
+        }
+        bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+        bytes.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+        if (dst != NULL) {
+            vst3q_u8(dst + out, bytes);
+        }
+    }
+    return i;
+}
+
+#else
+
+static size_t encode_blocks(char *dst, const unsigned char *src, size_t len,
+                            const ct_base64_alphabet *alphabet) {
+    (void)dst;
+    (void)src;
+    (void)len;
+    (void)alphabet;
+    return 0;
+}
+
+static size_t decode_blocks(unsigned char *dst, size_t capacity,
+                            const char *src, size_t len,
+                            const ct_base64_alphabet *alphabet) {
+    (void)dst;
+    (void)capacity;
+    (void)src;
+    (void)len;
+    (void)alphabet;
+    return 0;
+}
+
+#endif
+
+size_t ct_base64_encoded_len(size_t bin_len, ct_base64_variant variant) {
+    size_t olen = (bin_len / 3) << 2;
+
+    if (bin_len % 3 != 0) {
+        olen += alphabet_of(variant).padded ? 4 : bin_len % 3 + 1;
+    }
+    return olen;
+}
+
+size_t ct_base64_encode(char *dst, size_t dst_len, const void *src,
+                        size_t src_len, ct_base64_variant variant) {
+    const ct_base64_alphabet alphabet = alphabet_of(variant);
+    const size_t olen = ct_base64_encoded_len(src_len, variant);
+    const unsigned char *buf = (const unsigned char *)src;
+    char *out = dst;
+    unsigned acc, acc_len;
+    size_t i;
+
+    if (dst_len <= olen) {
+        return (size_t)-1;
+    }
+
+    i = encode_blocks(out, buf, src_len, &alphabet);
+    out += (i / 3) << 2;
+
+    acc = 0;
+    acc_len = 0;
+    for (; i < src_len; ++i) {
+        acc = (acc << 8) + buf[i];
+        acc_len += 8;
+        while (acc_len >= 6) {
+            acc_len -= 6;
+            *out++ = (char)byte_to_char((acc >> acc_len) & 0x3F, &alphabet);
+        }
+    }
+    if (acc_len > 0) {
+        *out++ = (char)byte_to_char((acc << (6 - acc_len)) & 0x3F, &alphabet);
+    }
+    while (out < dst + olen) {
+        *out++ = '=';
+    }
+    *out = 0;
+    return olen;
+}
+
+const char *ct_base64_decode(void *dst, size_t *dst_len, const char *src,
+                             size_t src_len, ct_base64_variant variant) {
+    const ct_base64_alphabet alphabet = alphabet_of(variant);
+    const size_t capacity = dst != NULL ? *dst_len : (size_t)-1;
+    unsigned char *buf = (unsigned char *)dst;
+    unsigned acc, acc_len;
+    size_t i, len;
+
+    i = decode_blocks(buf, capacity, src, src_len, &alphabet);
+    len = (i >> 2) * 3;
+
+    acc = 0;
+    acc_len = 0;
+    for (; i < src_len; ++i) {
+        unsigned d = char_to_byte((unsigned char)src[i], &alphabet);
+        if (d == 0xFF) {
+            break;
+        }
+        acc = (acc << 6) + d;
+        acc_len += 6;
+        if (acc_len >= 8) {
+            acc_len -= 8;
+            if (len >= capacity) {
+                return NULL;
+            }
+            if (buf != NULL) {
+                buf[len] = (acc >> acc_len) & 0xFF;
+            }
+            len++;
+        }
+    }
+
+    /*
+     * If the input length is equal to 1 modulo 4 (which is invalid), then
+     * there will remain 6 unprocessed bits; otherwise, only 0, 2 or 4 bits
+     * are buffered. The buffered bits must also all be zero.
+     */
+    if (acc_len > 4 || (acc & (((unsigned)1 << acc_len) - 1)) != 0) {
+        return NULL;
+    }
+
+    /* Padded variants end on a multiple of 4 characters */
+    if (alphabet.padded) {
+        unsigned padding = acc_len / 2;
+        for (; padding > 0; --padding, ++i) {
+            if (i >= src_len || src[i] != '=') {
+                return NULL;
+            }
+        }
+    }
+    *dst_len = len;
+    return src + i;
+}
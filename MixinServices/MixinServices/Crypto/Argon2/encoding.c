@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include "ct_base64.h"
 #include "encoding.h"
 #include "core.h"
 
@@ -68,135 +69,24 @@
  */
 
 /*
- * Some macros for constant-time comparisons. These work over values in
- * the 0..255 range. Returned value is 0x00 on "false", 0xFF on "true".
- */
-#define EQ(x, y) ((((0U - ((unsigned)(x) ^ (unsigned)(y))) >> 8) & 0xFF) ^ 0xFF)
-#define GT(x, y) ((((unsigned)(y) - (unsigned)(x)) >> 8) & 0xFF)
-#define GE(x, y) (GT(y, x) ^ 0xFF)
-#define LT(x, y) GT(y, x)
-#define LE(x, y) GE(y, x)
-
-/*
- * Convert value x (0..63) to corresponding Base64 character.
- */
-static int b64_byte_to_char(unsigned x) {
-    return (LT(x, 26) & (x + 'A')) |
-           (GE(x, 26) & LT(x, 52) & (x + ('a' - 26))) |
-           (GE(x, 52) & LT(x, 62) & (x + ('0' - 52))) | (EQ(x, 62) & '+') |
-           (EQ(x, 63) & '/');
-}
-
-/*
- * Convert character c to the corresponding 6-bit value. If character c
- * is not a Base64 character, then 0xFF (255) is returned.
- */
-static unsigned b64_char_to_byte(int c) {
-    unsigned x;
-
-    x = (GE(c, 'A') & LE(c, 'Z') & (c - 'A')) |
-        (GE(c, 'a') & LE(c, 'z') & (c - ('a' - 26))) |
-        (GE(c, '0') & LE(c, '9') & (c - ('0' - 52))) | (EQ(c, '+') & 62) |
-        (EQ(c, '/') & 63);
-    return x | (EQ(x, 0) & (EQ(c, 'A') ^ 0xFF));
-}
-
-/*
- * Convert some bytes to Base64. 'dst_len' is the length (in characters)
- * of the output buffer 'dst'; if that buffer is not large enough to
- * receive the result (including the terminating 0), then (size_t)-1
- * is returned. Otherwise, the zero-terminated Base64 string is written
- * in the buffer, and the output length (counted WITHOUT the terminating
- * zero) is returned.
+ * The Base64 functions live in ct_base64.c, which vectorizes them and makes
+ * them usable outside of Argon2. Argon2 strings use the standard alphabet
+ * without padding.
  */
 static size_t to_base64(char *dst, size_t dst_len, const void *src,
                         size_t src_len) {
-    size_t olen;
-    const unsigned char *buf;
-    unsigned acc, acc_len;
-
-    olen = (src_len / 3) << 2;
-    switch (src_len % 3) {
-    case 2:
-        olen++;
-    /* fall through */
-    case 1:
-        olen += 2;
-        break;
-    }
-    if (dst_len <= olen) {
-        return (size_t)-1;
-    }
-    acc = 0;
-    acc_len = 0;
-    buf = (const unsigned char *)src;
-    while (src_len-- > 0) {
-        acc = (acc << 8) + (*buf++);
-        acc_len += 8;
-        while (acc_len >= 6) {
-            acc_len -= 6;
-            *dst++ = (char)b64_byte_to_char((acc >> acc_len) & 0x3F);
-        }
-    }
-    if (acc_len > 0) {
-        *dst++ = (char)b64_byte_to_char((acc << (6 - acc_len)) & 0x3F);
-    }
-    *dst++ = 0;
-    return olen;
+    return ct_base64_encode(dst, dst_len, src, src_len,
+                            CT_BASE64_STANDARD_NO_PADDING);
 }
 
 /*
- * Decode Base64 chars into bytes. The '*dst_len' value must initially
- * contain the length of the output buffer '*dst'; when the decoding
- * ends, the actual number of decoded bytes is written back in
- * '*dst_len'.
- *
- * Decoding stops when a non-Base64 character is encountered, or when
- * the output buffer capacity is exceeded. If an error occurred (output
- * buffer is too small, invalid last characters leading to unprocessed
- * buffered bits), then NULL is returned; otherwise, the returned value
- * points to the first non-Base64 character in the source stream, which
- * may be the terminating zero.
+ * Decode Base64 chars into bytes, see ct_base64_decode. Returns a pointer to
+ * the first non-Base64 character, which may be the terminating zero, or NULL
+ * on error.
  */
 static const char *from_base64(void *dst, size_t *dst_len, const char *src) {
-    size_t len;
-    unsigned char *buf;
-    unsigned acc, acc_len;
-
-    buf = (unsigned char *)dst;
-    len = 0;
-    acc = 0;
-    acc_len = 0;
-    for (;;) {
-        unsigned d;
-
-        d = b64_char_to_byte(*src);
-        if (d == 0xFF) {
-            break;
-        }
-        src++;
-        acc = (acc << 6) + d;
-        acc_len += 6;
-        if (acc_len >= 8) {
-            acc_len -= 8;
-            if ((len++) >= *dst_len) {
-                return NULL;
-            }
-            *buf++ = (acc >> acc_len) & 0xFF;
-        }
-    }
-
-    /*
-     * If the input length is equal to 1 modulo 4 (which is
-     * invalid), then there will remain 6 unprocessed bits;
-     * otherwise, only 0, 2 or 4 bits are buffered. The buffered
-     * bits must also all be zero.
-     */
-    if (acc_len > 4 || (acc & (((unsigned)1 << acc_len) - 1)) != 0) {
-        return NULL;
-    }
-    *dst_len = len;
-    return src;
+    return ct_base64_decode(dst, dst_len, src, strlen(src),
+                            CT_BASE64_STANDARD_NO_PADDING);
 }
 
 /*
@@ -253,9 +143,14 @@ static const char *decode_decimal(const char *str, unsigned long *v) {
  *
  * The ctx struct must contain buffers large enough to hold the salt and pwd
  * when it is fed into decode_string.
+ *
+ * With @out_b64 set, the output is validated but left encoded: @out_b64 and
+ * @out_b64_len locate its Base64 text and ctx->outlen gets its decoded length.
  */
 
-int decode_string(argon2_context *ctx, const char *str, argon2_type type) {
+static int decode_fields(argon2_context *ctx, const char *str,
+                         argon2_type type, const char **out_b64,
+                         size_t *out_b64_len) {
 
 /* check for prefix */
 #define CC(prefix)                                                             \
@@ -341,7 +236,19 @@ int decode_string(argon2_context *ctx, const char *str, argon2_type type) {
     CC("$");
     BIN(ctx->salt, maxsaltlen, ctx->saltlen);
     CC("$");
-    BIN(ctx->out, maxoutlen, ctx->outlen);
+    if (out_b64 != NULL) {
+        size_t bin_len = 0;
+        *out_b64 = str;
+        str = ct_base64_decode(NULL, &bin_len, str, strlen(str),
+                               CT_BASE64_STANDARD_NO_PADDING);
+        if (str == NULL || bin_len > maxoutlen) {
+            return ARGON2_DECODING_FAIL;
+        }
+        *out_b64_len = (size_t)(str - *out_b64);
+        ctx->outlen = (uint32_t)bin_len;
+    } else {
+        BIN(ctx->out, maxoutlen, ctx->outlen);
+    }
 
     /* The rest of the fields get the default values */
     ctx->secret = NULL;
@@ -351,6 +258,9 @@ int decode_string(argon2_context *ctx, const char *str, argon2_type type) {
     ctx->allocate_cbk = NULL;
     ctx->free_cbk = NULL;
     ctx->flags = ARGON2_DEFAULT_FLAGS;
+    ctx->progress_cbk = NULL;
+    ctx->progress_ctx = NULL;
+    ctx->cancel = NULL;
 
     /* On return, must have valid context */
     validation_result = validate_inputs(ctx);
@@ -370,6 +280,16 @@ int decode_string(argon2_context *ctx, const char *str, argon2_type type) {
 #undef BIN
 }
 
+int decode_string(argon2_context *ctx, const char *str, argon2_type type) {
+    return decode_fields(ctx, str, type, NULL, NULL);
+}
+
+int decode_string_params(argon2_context *ctx, const char *str,
+                         argon2_type type, const char **out_b64,
+                         size_t *out_b64_len) {
+    return decode_fields(ctx, str, type, out_b64, out_b64_len);
+}
+
 int encode_string(char *dst, size_t dst_len, argon2_context *ctx,
                   argon2_type type) {
 #define SS(str)                                                                \
@@ -438,18 +358,7 @@ int encode_string(char *dst, size_t dst_len, argon2_context *ctx,
 }
 
 size_t b64len(uint32_t len) {
-    size_t olen = ((size_t)len / 3) << 2;
-
-    switch (len % 3) {
-    case 2:
-        olen++;
-    /* fall through */
-    case 1:
-        olen += 2;
-        break;
-    }
-
-    return olen;
+    return ct_base64_encoded_len(len, CT_BASE64_STANDARD_NO_PADDING);
 }
 
 size_t numlen(uint32_t num) {
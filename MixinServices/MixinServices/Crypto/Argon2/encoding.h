@@ -48,6 +48,16 @@ int encode_string(char *dst, size_t dst_len, argon2_context *ctx,
 */
 int decode_string(argon2_context *ctx, const char *str, argon2_type type);
 
+/*
+* Like decode_string, but the output is only validated and left encoded:
+* '*out_b64' points to its Base64 text within 'str', '*out_b64_len' is the
+* number of characters and ctx.outlen its decoded length. ctx.out must still
+* point to a buffer of the maximal output length, it is not written to.
+*/
+int decode_string_params(argon2_context *ctx, const char *str,
+                         argon2_type type, const char **out_b64,
+                         size_t *out_b64_len);
+
 /* Returns the length of the encoded byte stream with length len */
 size_t b64len(uint32_t len);
 
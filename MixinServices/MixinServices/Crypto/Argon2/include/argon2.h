@@ -154,13 +154,23 @@ typedef enum Argon2_ErrorCodes {
 
     ARGON2_DECODING_LENGTH_FAIL = -34,
 
-    ARGON2_VERIFY_MISMATCH = -35
+    ARGON2_VERIFY_MISMATCH = -35,
+
+    ARGON2_CANCELED = -36
 } argon2_error_codes;
 
 /* Memory allocator types --- for external allocation */
 typedef int (*allocate_fptr)(uint8_t **memory, size_t bytes_to_allocate);
 typedef void (*deallocate_fptr)(uint8_t *memory, size_t bytes_to_allocate);
 
+/*
+ * Progress callback, called after every slice of every pass with the pass
+ * (0 to t_cost - 1) and slice (0 to 3) just filled. Returning nonzero cancels
+ * the hash.
+ */
+typedef int (*progress_fptr)(void *progress_ctx, uint32_t pass,
+                             uint32_t slice);
+
 /* Argon2 external data structures */
 
 /*
@@ -178,6 +188,8 @@ typedef void (*deallocate_fptr)(uint8_t *memory, size_t bytes_to_allocate);
  * deallocate the memory (if NULL, memory will be allocated internally).
  * Also, three flags indicate whether to erase password, secret as soon as they
  * are pre-hashed (and thus not needed anymore), and the entire memory
+ * A progress callback and a cancellation flag are checked between slices, a
+ * canceled hash returns ARGON2_CANCELED with its memory already released.
  *****
  * Simplest situation: you have output array out[8], password is stored in
  * pwd[32], salt is stored in salt[16], you do not have keys nor associated
@@ -215,6 +227,10 @@ typedef struct Argon2_Context {
     deallocate_fptr free_cbk;   /* pointer to memory deallocator */
 
     uint32_t flags; /* array of bool options */
+
+    progress_fptr progress_cbk; /* pointer to progress callback, or NULL */
+    void *progress_ctx;         /* passed to progress_cbk */
+    const volatile int *cancel; /* nonzero stops the hash at the next slice */
 } argon2_context;
 
 /* Argon2 primitive type */
@@ -231,6 +247,15 @@ typedef enum Argon2_version {
     ARGON2_VERSION_NUMBER = ARGON2_VERSION_13
 } argon2_version;
 
+/* Implementation of the compression function, see opt.c */
+typedef enum Argon2_impl {
+    Argon2_impl_auto = 0, /* fastest one supported by the running CPU */
+    Argon2_impl_ref = 1,
+    Argon2_impl_sse2 = 2,
+    Argon2_impl_avx2 = 3,
+    Argon2_impl_neon = 4
+} argon2_impl;
+
 /*
  * Function that gives the string representation of an argon2_type.
  * @param type The argon2_type that we want the string for
@@ -239,6 +264,68 @@ typedef enum Argon2_version {
  */
 ARGON2_PUBLIC const char *argon2_type2string(argon2_type type, int uppercase);
 
+/*
+ * Whether an implementation is compiled in and supported by the running CPU.
+ * @param impl The implementation to check
+ * @return Non-zero if it can be selected
+ */
+ARGON2_PUBLIC int argon2_impl_supported(argon2_impl impl);
+
+/*
+ * Selects the implementation used by all subsequent hashes. Every
+ * implementation produces identical output, it only affects performance.
+ * @param impl The implementation, Argon2_impl_auto for the fastest one
+ * @return ARGON2_OK, or ARGON2_INCORRECT_PARAMETER if it is not supported
+ */
+ARGON2_PUBLIC int argon2_select_impl(argon2_impl impl);
+
+/*
+ * Function that gives the implementation currently in use.
+ * @return Never Argon2_impl_auto
+ */
+ARGON2_PUBLIC argon2_impl argon2_selected_impl(void);
+
+/*
+ * Reusable memory for hashing, see argon2_arena_create.
+ */
+typedef struct Argon2_arena argon2_arena;
+
+typedef enum Argon2_arena_flag {
+    /* Map the arena with 2 MiB pages if the system provides them */
+    ARGON2_ARENA_HUGE_PAGES = 0x01,
+    /* Fail instead of falling back to pageable memory if locking fails */
+    ARGON2_ARENA_LOCKED = 0x02
+} argon2_arena_flag;
+
+/*
+ * Creates an arena large enough for hashes of up to @m_cost KiB with @lanes
+ * lanes. The pages are locked into RAM and excluded from core dumps where
+ * supported. Hashes wipe the memory they used before returning, and
+ * argon2_arena_release wipes the whole arena once more.
+ * @param flags ARGON2_ARENA_* flags
+ * @return NULL if the memory can not be mapped, or locked while
+ * ARGON2_ARENA_LOCKED is requested
+ */
+ARGON2_PUBLIC argon2_arena *argon2_arena_create(uint32_t m_cost, uint32_t lanes,
+                                                uint32_t flags);
+
+/*
+ * Function that gives the ARGON2_ARENA_* flags in effect for @arena, telling
+ * whether huge pages were used and the memory is locked.
+ */
+ARGON2_PUBLIC uint32_t argon2_arena_flags(const argon2_arena *arena);
+
+/*
+ * Wipes, unlocks and unmaps the memory of @arena. May be NULL.
+ */
+ARGON2_PUBLIC void argon2_arena_release(argon2_arena *arena);
+
+/*
+ * Function that gives the string representation of an argon2_impl.
+ * @return NULL if invalid impl, otherwise the string representation.
+ */
+ARGON2_PUBLIC const char *argon2_impl2string(argon2_impl impl);
+
 /*
  * Function that performs memory-hard hashing with certain degree of parallelism
  * @param  context  Pointer to the Argon2 internal structure
@@ -246,6 +333,33 @@ ARGON2_PUBLIC const char *argon2_type2string(argon2_type type, int uppercase);
  */
 ARGON2_PUBLIC int argon2_ctx(argon2_context *context, argon2_type type);
 
+/*
+ * Function that performs memory-hard hashing in the memory of an arena
+ * instead of allocating the memory matrix for this hash alone. The memory is
+ * wiped before returning, whether hashing succeeded or not
+ * @param  context  Pointer to the Argon2 internal structure
+ * @param  arena    Arena created with argon2_arena_create, large enough for
+ * the memory cost and lanes of @context. Not to be used by two hashes at once
+ * @return Error code if smth is wrong, ARGON2_OK otherwise
+ */
+ARGON2_PUBLIC int argon2_ctx_arena(argon2_context *context, argon2_type type,
+                                   argon2_arena *arena);
+
+/*
+ * Function that performs several independent memory-hard hashes together.
+ * The memory of all instances is carved out of a single region, and segments
+ * of all instances are filled concurrently on the shared worker pool.
+ * @param  contexts  Array of @count Argon2 contexts, each with its own output
+ * @param  count     Number of contexts
+ * @param  arena     Arena large enough for the memory of all instances, or
+ * NULL to allocate with the allocator of the first context. The memory is
+ * wiped once at the end either way
+ * @return Error code if smth is wrong with any of the contexts, ARGON2_OK
+ * otherwise
+ */
+ARGON2_PUBLIC int argon2_ctx_batch(argon2_context *contexts, uint32_t count,
+                                   argon2_type type, argon2_arena *arena);
+
 /**
  * Hashes a password with Argon2i, producing an encoded hash
  * @param t_cost Number of iterations
@@ -0,0 +1,78 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+#ifndef CT_BASE64_H
+#define CT_BASE64_H
+
+#include <stddef.h>
+
+#include "argon2.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * Constant-time Base64 (RFC 4648). Neither branches nor memory accesses depend
+ * on the value of the bytes being encoded or decoded, only on their length and
+ * on where the encoded text ends, so it is safe for keys, hashes and
+ * signatures. Blocks of 12 or 48 bytes are converted with SSSE3 or NEON.
+ */
+
+typedef enum Ct_base64_variant {
+    CT_BASE64_STANDARD = 0,            /* '+' and '/', padded with '=' */
+    CT_BASE64_STANDARD_NO_PADDING = 1, /* '+' and '/', as in Argon2 strings */
+    CT_BASE64_URLSAFE = 2,             /* '-' and '_', padded with '=' */
+    CT_BASE64_URLSAFE_NO_PADDING = 3   /* '-' and '_' */
+} ct_base64_variant;
+
+/*
+ * Returns the number of characters encoding @bin_len bytes, without the
+ * terminating zero.
+ */
+ARGON2_PUBLIC size_t ct_base64_encoded_len(size_t bin_len,
+                                           ct_base64_variant variant);
+
+/*
+ * Encodes @src_len bytes of @src into @dst, which holds @dst_len characters,
+ * and zero-terminates it. Returns the length of the encoding without the
+ * terminating zero, or (size_t)-1 if @dst is too small.
+ */
+ARGON2_PUBLIC size_t ct_base64_encode(char *dst, size_t dst_len,
+                                      const void *src, size_t src_len,
+                                      ct_base64_variant variant);
+
+/*
+ * Decodes the Base64 text at the start of the first @src_len characters of
+ * @src. Decoding stops at the first character outside the alphabet, or after
+ * the padding of padded variants. @dst_len holds the capacity of @dst on input
+ * and the number of decoded bytes on output. @dst may be NULL to validate the
+ * text and count its bytes only.
+ *
+ * Returns a pointer to the first character after the Base64 text, or NULL if
+ * @dst is too small, the length is impossible, the unused bits of the last
+ * character are not zero or the padding is wrong.
+ */
+ARGON2_PUBLIC const char *ct_base64_decode(void *dst, size_t *dst_len,
+                                           const char *src, size_t src_len,
+                                           ct_base64_variant variant);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * Argon2 reference source code package - reference C implementations
+ *
+ * Copyright 2015
+ * Daniel Dinu, Dmitry Khovratovich, Jean-Philippe Aumasson, and Samuel Neves
+ *
+ * You may use this work under the terms of a Creative Commons CC0 1.0
+ * License/Waiver or the Apache Public License 2.0, at your option. The terms of
+ * these licenses can be found at:
+ *
+ * - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+ * - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * You should have received a copy of both of these licenses along with this
+ * software. If not, they may be obtained at the above URLs.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "argon2.h"
+#include "core.h"
+
+#include "blake2/blamka-round-opt.h"
+
+/*
+ * SIMD implementations of fill_block. They produce exactly the same blocks as
+ * fill_block_ref in ref.c, which stays the fallback for CPUs without any of
+ * them. The implementation is chosen at runtime, see argon2_select_impl.
+ */
+
+#if defined(ARGON2_HAVE_SSE2)
+
+static void fill_block_sse2(const block *prev_block, const block *ref_block,
+                            block *next_block, int with_xor) {
+    __m128i state[ARGON2_OWORDS_IN_BLOCK];
+    __m128i block_tmp[ARGON2_OWORDS_IN_BLOCK];
+    const __m128i *prev = (const __m128i *)prev_block->v;
+    const __m128i *ref = (const __m128i *)ref_block->v;
+    __m128i *next = (__m128i *)next_block->v;
+    unsigned i;
+
+    for (i = 0; i < ARGON2_OWORDS_IN_BLOCK; i++) {
+        state[i] = _mm_xor_si128(_mm_loadu_si128(ref + i),
+                                 _mm_loadu_si128(prev + i));
+        block_tmp[i] = with_xor
+                           ? _mm_xor_si128(state[i], _mm_loadu_si128(next + i))
+                           : state[i];
+    }
+
+    /* Columns: words (0,1,...,15), then (16,17,..31)... */
+    for (i = 0; i < 8; ++i) {
+        BLAKE2_ROUND_OPT(sse2, state[8 * i + 0], state[8 * i + 1],
+                         state[8 * i + 2], state[8 * i + 3], state[8 * i + 4],
+                         state[8 * i + 5], state[8 * i + 6], state[8 * i + 7]);
+    }
+
+    /* Rows: words (0,1,16,17,...112,113), then (2,3,18,19,...,114,115)... */
+    for (i = 0; i < 8; ++i) {
+        BLAKE2_ROUND_OPT(sse2, state[i + 0], state[i + 8], state[i + 16],
+                         state[i + 24], state[i + 32], state[i + 40],
+                         state[i + 48], state[i + 56]);
+    }
+
+    for (i = 0; i < ARGON2_OWORDS_IN_BLOCK; i++) {
+        _mm_storeu_si128(next + i, _mm_xor_si128(state[i], block_tmp[i]));
+    }
+}
+
+#if defined(ARGON2_HAVE_AVX2)
+
+/*
+ * A 256-bit word P[j] holds the 128-bit words 2j and 2j+1 of the block, so
+ * two rounds are done at once, one in each 128-bit lane. Row rounds i and i+1
+ * use P[i/2 + 4k] as they are. Column rounds i and i+1 use words 8i+k and
+ * 8i+8+k, which are regrouped before and after the round.
+ */
+static AVX2_TARGET void fill_block_avx2(const block *prev_block,
+                                        const block *ref_block,
+                                        block *next_block, int with_xor) {
+    __m256i state[ARGON2_HWORDS_IN_BLOCK];
+    __m256i block_tmp[ARGON2_HWORDS_IN_BLOCK];
+    const __m256i *prev = (const __m256i *)prev_block->v;
+    const __m256i *ref = (const __m256i *)ref_block->v;
+    __m256i *next = (__m256i *)next_block->v;
+    unsigned i, k;
+
+    for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
+        state[i] = _mm256_xor_si256(_mm256_loadu_si256(ref + i),
+                                    _mm256_loadu_si256(prev + i));
+        block_tmp[i] = with_xor ? _mm256_xor_si256(
+                                      state[i], _mm256_loadu_si256(next + i))
+                                : state[i];
+    }
+
+    for (i = 0; i < 8; i += 2) {
+        __m256i v[8];
+        for (k = 0; k < 4; k++) {
+            v[2 * k] = _mm256_permute2x128_si256(state[4 * i + k],
+                                                 state[4 * i + 4 + k], 0x20);
+            v[2 * k + 1] = _mm256_permute2x128_si256(
+                state[4 * i + k], state[4 * i + 4 + k], 0x31);
+        }
+        BLAKE2_ROUND_OPT(avx2, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+        for (k = 0; k < 4; k++) {
+            state[4 * i + k] =
+                _mm256_permute2x128_si256(v[2 * k], v[2 * k + 1], 0x20);
+            state[4 * i + 4 + k] =
+                _mm256_permute2x128_si256(v[2 * k], v[2 * k + 1], 0x31);
+        }
+    }
+
+    for (i = 0; i < 4; i++) {
+        BLAKE2_ROUND_OPT(avx2, state[i + 0], state[i + 4], state[i + 8],
+                         state[i + 12], state[i + 16], state[i + 20],
+                         state[i + 24], state[i + 28]);
+    }
+
+    for (i = 0; i < ARGON2_HWORDS_IN_BLOCK; i++) {
+        _mm256_storeu_si256(next + i, _mm256_xor_si256(state[i], block_tmp[i]));
+    }
+}
+
+#endif /* ARGON2_HAVE_AVX2 */
+
+#elif defined(ARGON2_HAVE_NEON)
+
+static void fill_block_neon(const block *prev_block, const block *ref_block,
+                            block *next_block, int with_xor) {
+    uint64x2_t state[ARGON2_OWORDS_IN_BLOCK];
+    uint64x2_t block_tmp[ARGON2_OWORDS_IN_BLOCK];
+    unsigned i;
+
+    for (i = 0; i < ARGON2_OWORDS_IN_BLOCK; i++) {
+        state[i] = veorq_u64(vld1q_u64(ref_block->v + 2 * i),
+                             vld1q_u64(prev_block->v + 2 * i));
+        block_tmp[i] = with_xor
+                           ? veorq_u64(state[i], vld1q_u64(next_block->v + 2 * i))
+                           : state[i];
+    }
+
+    /* Columns: words (0,1,...,15), then (16,17,..31)... */
+    for (i = 0; i < 8; ++i) {
+        BLAKE2_ROUND_OPT(neon, state[8 * i + 0], state[8 * i + 1],
+                         state[8 * i + 2], state[8 * i + 3], state[8 * i + 4],
+                         state[8 * i + 5], state[8 * i + 6], state[8 * i + 7]);
+    }
+
+    /* Rows: words (0,1,16,17,...112,113), then (2,3,18,19,...,114,115)... */
+    for (i = 0; i < 8; ++i) {
+        BLAKE2_ROUND_OPT(neon, state[i + 0], state[i + 8], state[i + 16],
+                         state[i + 24], state[i + 32], state[i + 40],
+                         state[i + 48], state[i + 56]);
+    }
+
+    for (i = 0; i < ARGON2_OWORDS_IN_BLOCK; i++) {
+        vst1q_u64(next_block->v + 2 * i, veorq_u64(state[i], block_tmp[i]));
+    }
+}
+
+#endif
+
+/***************Runtime selection*****************/
+
+static int impl_supported(argon2_impl impl) {
+    switch (impl) {
+    case Argon2_impl_ref:
+        return 1;
+#if defined(ARGON2_HAVE_SSE2)
+    case Argon2_impl_sse2:
+        return 1;
+#endif
+#if defined(ARGON2_HAVE_AVX2)
+    case Argon2_impl_avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+#if defined(ARGON2_HAVE_NEON)
+    case Argon2_impl_neon:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+static fill_block_fn impl_fill_block(argon2_impl impl) {
+    switch (impl) {
+#if defined(ARGON2_HAVE_SSE2)
+    case Argon2_impl_sse2:
+        return fill_block_sse2;
+#endif
+#if defined(ARGON2_HAVE_AVX2)
+    case Argon2_impl_avx2:
+        return fill_block_avx2;
+#endif
+#if defined(ARGON2_HAVE_NEON)
+    case Argon2_impl_neon:
+        return fill_block_neon;
+#endif
+    default:
+        return fill_block_ref;
+    }
+}
+
+static argon2_impl fastest_impl(void) {
+    static const argon2_impl candidates[] = {
+        Argon2_impl_avx2, Argon2_impl_neon, Argon2_impl_sse2
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (impl_supported(candidates[i])) {
+            return candidates[i];
+        }
+    }
+    return Argon2_impl_ref;
+}
+
+/* Zero until resolved. Concurrent resolution stores the same value. */
+static int selected_impl = 0;
+
+int argon2_impl_supported(argon2_impl impl) {
+    return impl == Argon2_impl_auto || impl_supported(impl);
+}
+
+int argon2_select_impl(argon2_impl impl) {
+    if (!argon2_impl_supported(impl)) {
+        return ARGON2_INCORRECT_PARAMETER;
+    }
+    if (impl == Argon2_impl_auto) {
+        impl = fastest_impl();
+    }
+    __atomic_store_n(&selected_impl, (int)impl, __ATOMIC_RELAXED);
+    return ARGON2_OK;
+}
+
+argon2_impl argon2_selected_impl(void) {
+    int impl = __atomic_load_n(&selected_impl, __ATOMIC_RELAXED);
+    if (impl == Argon2_impl_auto) {
+        impl = fastest_impl();
+        __atomic_store_n(&selected_impl, impl, __ATOMIC_RELAXED);
+    }
+    return (argon2_impl)impl;
+}
+
+const char *argon2_impl2string(argon2_impl impl) {
+    switch (impl) {
+    case Argon2_impl_auto:
+        return "auto";
+    case Argon2_impl_ref:
+        return "ref";
+    case Argon2_impl_sse2:
+        return "sse2";
+    case Argon2_impl_avx2:
+        return "avx2";
+    case Argon2_impl_neon:
+        return "neon";
+    }
+    return NULL;
+}
+
+fill_block_fn selected_fill_block(void) {
+    return impl_fill_block(argon2_selected_impl());
+}
@@ -28,16 +28,10 @@
 
 
 /*
- * Function fills a new memory block and optionally XORs the old block over the new one.
- * @next_block must be initialized.
- * @param prev_block Pointer to the previous block
- * @param ref_block Pointer to the reference block
- * @param next_block Pointer to the block to be constructed
- * @param with_xor Whether to XOR into the new block (1) or just overwrite (0)
- * @pre all block pointers must be valid
+ * Portable implementation of fill_block, see core.h
  */
-static void fill_block(const block *prev_block, const block *ref_block,
-                       block *next_block, int with_xor) {
+void fill_block_ref(const block *prev_block, const block *ref_block,
+                    block *next_block, int with_xor) {
     block blockR, block_tmp;
     unsigned i;
 
@@ -80,8 +74,8 @@ static void fill_block(const block *prev_block, const block *ref_block,
     xor_block(next_block, &blockR);
 }
 
-static void next_addresses(block *address_block, block *input_block,
-                           const block *zero_block) {
+static void next_addresses(fill_block_fn fill_block, block *address_block,
+                           block *input_block, const block *zero_block) {
     input_block->v[6]++;
     fill_block(zero_block, input_block, address_block, 0);
     fill_block(zero_block, address_block, address_block, 0);
@@ -96,11 +90,14 @@ void fill_segment(const argon2_instance_t *instance,
     uint32_t starting_index;
     uint32_t i;
     int data_independent_addressing;
+    fill_block_fn fill_block;
 
     if (instance == NULL) {
         return;
     }
 
+    fill_block = instance->fill_block ? instance->fill_block : fill_block_ref;
+
     data_independent_addressing =
         (instance->type == Argon2_i) ||
         (instance->type == Argon2_id && (position.pass == 0) &&
@@ -125,7 +122,8 @@ void fill_segment(const argon2_instance_t *instance,
 
         /* Don't forget to generate the first block of addresses: */
         if (data_independent_addressing) {
-            next_addresses(&address_block, &input_block, &zero_block);
+            next_addresses(fill_block, &address_block, &input_block,
+                           &zero_block);
         }
     }
 
@@ -152,7 +150,8 @@ void fill_segment(const argon2_instance_t *instance,
         /* 1.2.1 Taking pseudo-random value from the previous block */
         if (data_independent_addressing) {
             if (i % ARGON2_ADDRESSES_IN_BLOCK == 0) {
-                next_addresses(&address_block, &input_block, &zero_block);
+                next_addresses(fill_block, &address_block, &input_block,
+                               &zero_block);
             }
             pseudo_rand = address_block.v[i % ARGON2_ADDRESSES_IN_BLOCK];
         } else {
@@ -54,4 +54,225 @@ void argon2_thread_exit(void) {
 #endif
 }
 
+/* Upper bound on pooled workers, the caller always works on a batch too */
+#define ARGON2_POOL_MAX_WORKERS 63
+
+#if defined(_WIN32)
+
+/* No pool on Win32: helper threads are created for each batch */
+typedef struct Argon2_batch {
+    argon2_job_func_t func;
+    void *args;
+    uint32_t count;
+    volatile LONG next;
+} argon2_batch;
+
+static void batch_work(argon2_batch *batch) {
+    LONG index;
+    while ((index = InterlockedIncrement(&batch->next) - 1) <
+           (LONG)batch->count) {
+        batch->func(batch->args, (uint32_t)index);
+    }
+}
+
+static unsigned __stdcall batch_thr(void *args) {
+    batch_work((argon2_batch *)args);
+    return 0;
+}
+
+int argon2_thread_pool_run(argon2_job_func_t func, void *args, uint32_t count,
+                           uint32_t threads) {
+    argon2_thread_handle_t handles[ARGON2_POOL_MAX_WORKERS];
+    argon2_batch batch;
+    uint32_t helpers, i;
+
+    if (func == NULL) {
+        return -1;
+    }
+    batch.func = func;
+    batch.args = args;
+    batch.count = count;
+    batch.next = 0;
+
+    helpers = (threads < count ? threads : count);
+    helpers = helpers > 0 ? helpers - 1 : 0;
+    if (helpers > ARGON2_POOL_MAX_WORKERS) {
+        helpers = ARGON2_POOL_MAX_WORKERS;
+    }
+    for (i = 0; i < helpers; ++i) {
+        if (argon2_thread_create(&handles[i], &batch_thr, &batch)) {
+            break;
+        }
+    }
+    helpers = i;
+    batch_work(&batch);
+    for (i = 0; i < helpers; ++i) {
+        argon2_thread_join(handles[i]);
+    }
+    return 0;
+}
+
+#else
+
+/* A batch posted by a caller, lives on the caller's stack */
+typedef struct Argon2_pool_batch {
+    argon2_job_func_t func;
+    void *args;
+    uint32_t count;
+    uint32_t next;    /* next job to claim */
+    uint32_t pending; /* claimed or unclaimed jobs not yet finished */
+    uint32_t helpers; /* workers that may still join the batch */
+    struct Argon2_pool_batch *link;
+} argon2_pool_batch;
+
+typedef struct Argon2_thread_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t start;  /* signalled when a batch is posted */
+    pthread_cond_t finish; /* signalled when the last job of a batch ends */
+    uint32_t workers;      /* number of workers created so far */
+    uint32_t demand;       /* helpers wanted by all batches in progress */
+
+    /* Batches with unclaimed jobs, in the order they were posted */
+    argon2_pool_batch *head;
+    argon2_pool_batch *tail;
+} argon2_thread_pool;
+
+static argon2_thread_pool pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, 0, 0, NULL, NULL};
+
+/* Removes @batch from the queue once its last job is claimed, called with
+ * the mutex held */
+static void pool_unlink(argon2_pool_batch *batch) {
+    argon2_pool_batch **link = &pool.head;
+    argon2_pool_batch *previous = NULL;
+
+    while (*link != NULL && *link != batch) {
+        previous = *link;
+        link = &(*link)->link;
+    }
+    if (*link == NULL) {
+        return;
+    }
+    *link = batch->link;
+    if (pool.tail == batch) {
+        pool.tail = previous;
+    }
+    batch->link = NULL;
+}
+
+/* Claims and runs jobs of @batch, called with the mutex held. The batch is
+ * not touched once its last job finished, its caller may return then. */
+static void pool_work(argon2_pool_batch *batch) {
+    argon2_job_func_t func = batch->func;
+    void *args = batch->args;
+
+    while (batch->next < batch->count) {
+        uint32_t index = batch->next++;
+        if (batch->next == batch->count) {
+            pool_unlink(batch);
+        }
+
+        pthread_mutex_unlock(&pool.mutex);
+        func(args, index);
+        pthread_mutex_lock(&pool.mutex);
+
+        if (--batch->pending == 0) {
+            pthread_cond_broadcast(&pool.finish);
+        }
+    }
+}
+
+/* The oldest batch a worker may join, called with the mutex held */
+static argon2_pool_batch *pool_joinable(void) {
+    argon2_pool_batch *batch;
+
+    for (batch = pool.head; batch != NULL; batch = batch->link) {
+        if (batch->helpers > 0) {
+            return batch;
+        }
+    }
+    return NULL;
+}
+
+static void *pool_worker(void *args) {
+    argon2_pool_batch *batch;
+    (void)args;
+
+    pthread_mutex_lock(&pool.mutex);
+    for (;;) {
+        while ((batch = pool_joinable()) == NULL) {
+            pthread_cond_wait(&pool.start, &pool.mutex);
+        }
+        batch->helpers--;
+        pool_work(batch);
+    }
+    return NULL;
+}
+
+/* Grows the pool to @wanted workers, called with the mutex held */
+static void pool_grow(uint32_t wanted) {
+    if (wanted > ARGON2_POOL_MAX_WORKERS) {
+        wanted = ARGON2_POOL_MAX_WORKERS;
+    }
+    while (pool.workers < wanted) {
+        argon2_thread_handle_t handle;
+        if (argon2_thread_create(&handle, &pool_worker, NULL)) {
+            break;
+        }
+        pthread_detach(handle);
+        pool.workers++;
+    }
+}
+
+int argon2_thread_pool_run(argon2_job_func_t func, void *args, uint32_t count,
+                           uint32_t threads) {
+    argon2_pool_batch batch;
+
+    if (func == NULL) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (threads > count) {
+        threads = count;
+    }
+
+    batch.func = func;
+    batch.args = args;
+    batch.count = count;
+    batch.next = 0;
+    batch.pending = count;
+    batch.helpers = threads > 0 ? threads - 1 : 0;
+    batch.link = NULL;
+
+    pthread_mutex_lock(&pool.mutex);
+    /* Batches of concurrent hashes queue up and share the workers, the
+     * pool grows so that each of them can still get all its helpers */
+    pool.demand += batch.helpers;
+    pool_grow(pool.demand);
+
+    if (pool.tail != NULL) {
+        pool.tail->link = &batch;
+    } else {
+        pool.head = &batch;
+    }
+    pool.tail = &batch;
+    if (batch.helpers > 0) {
+        pthread_cond_broadcast(&pool.start);
+    }
+
+    pool_work(&batch);
+    while (batch.pending > 0) {
+        pthread_cond_wait(&pool.finish, &pool.mutex);
+    }
+
+    pool.demand -= threads > 0 ? threads - 1 : 0;
+    pthread_mutex_unlock(&pool.mutex);
+    return 0;
+}
+
+#endif
+
 #endif /* ARGON2_NO_THREADS */
@@ -30,6 +30,8 @@
    argon2_thread_func_t,
         and the type of the thread handle---argon2_thread_handle_t.
 */
+#include <stdint.h>
+
 #if defined(_WIN32)
 #include <process.h>
 typedef unsigned(__stdcall *argon2_thread_func_t)(void *);
@@ -63,5 +65,29 @@ int argon2_thread_join(argon2_thread_handle_t handle);
 */
 void argon2_thread_exit(void);
 
+/*
+        On top of the primitives above sits a process-wide pool of worker
+        threads. Workers are created on first use, kept alive across slices
+        and across hashes, and woken once per batch of jobs; the caller
+        takes part in each batch and returns once every job of it finished,
+        which gives the barrier between Argon2 slices.
+*/
+typedef void (*argon2_job_func_t)(void *args, uint32_t index);
+
+/* Runs a batch of jobs on the shared worker pool
+ * @param func Job entry point, called as func(args, i) for i in [0, count).
+ * Must not be NULL.
+ * @param args Pointer that is passed as an argument to @func. May be NULL.
+ * @param count Number of jobs in the batch.
+ * @param threads Maximum number of threads, the caller included, working on
+ * the batch at the same time.
+ * @return 0 once all jobs of the batch have finished, -1 if no job was run.
+ * Batches of concurrent callers are queued and share the workers, which
+ * join the oldest batch that still wants helpers. Each caller works on its
+ * own batch only.
+ */
+int argon2_thread_pool_run(argon2_job_func_t func, void *args, uint32_t count,
+                           uint32_t threads);
+
 #endif /* ARGON2_NO_THREADS */
 #endif
@@ -0,0 +1,63 @@
+import Foundation
+
+// BLAKE2b from the Argon2 sources, compressing with the same vector
+// instructions selected for Argon2
+public enum BLAKE2b {
+    
+    public static let maxOutputCount = Int(BLAKE2B_OUTBYTES.rawValue)
+    public static let maxKeyCount = Int(BLAKE2B_KEYBYTES.rawValue)
+    
+    public struct Hasher {
+        
+        private var state = blake2b_state()
+        
+        public let outputCount: Int
+        
+        // Returns nil if outputCount is not in 1...64, or key is longer than 64 bytes
+        public init?(outputCount: Int = maxOutputCount, key: Data? = nil) {
+            guard (1...BLAKE2b.maxOutputCount).contains(outputCount) else {
+                return nil
+            }
+            let result: Int32
+            if let key, !key.isEmpty {
+                guard key.count <= BLAKE2b.maxKeyCount else {
+                    return nil
+                }
+                result = key.withUnsafeBytes { key in
+                    blake2b_init_key(&state, outputCount, key.baseAddress, key.count)
+                }
+            } else {
+                result = blake2b_init(&state, outputCount)
+            }
+            guard result == 0 else {
+                return nil
+            }
+            self.outputCount = outputCount
+        }
+        
+        public mutating func update(data: Data) {
+            data.withUnsafeBytes { data in
+                _ = blake2b_update(&state, data.baseAddress, data.count)
+            }
+        }
+        
+        // The hasher can't be updated after finalizing
+        public mutating func finalize() -> Data {
+            var output = Data(count: outputCount)
+            output.withUnsafeMutableBytes { output in
+                _ = blake2b_final(&state, output.baseAddress, output.count)
+            }
+            return output
+        }
+        
+    }
+    
+    public static func hash(data: Data, outputCount: Int = 32, key: Data? = nil) -> Data? {
+        guard var hasher = Hasher(outputCount: outputCount, key: key) else {
+            return nil
+        }
+        hasher.update(data: data)
+        return hasher.finalize()
+    }
+    
+}
@@ -0,0 +1,65 @@
+import Foundation
+
+// Base64 from the Argon2 sources. Its running time doesn't depend on the bytes
+// being converted, unlike Foundation's table lookups, so it suits keys, hashes
+// and signatures.
+public enum ConstantTimeBase64 {
+    
+    public enum Variant {
+        
+        // "+" and "/", padded with "="
+        case standard
+        
+        // "+" and "/" without padding, as in Argon2 hash strings
+        case standardUnpadded
+        
+        // "-" and "_", padded with "="
+        case url
+        
+        // "-" and "_" without padding
+        case urlUnpadded
+        
+        fileprivate var variant: ct_base64_variant {
+            switch self {
+            case .standard:
+                CT_BASE64_STANDARD
+            case .standardUnpadded:
+                CT_BASE64_STANDARD_NO_PADDING
+            case .url:
+                CT_BASE64_URLSAFE
+            case .urlUnpadded:
+                CT_BASE64_URLSAFE_NO_PADDING
+            }
+        }
+        
+    }
+    
+    public static func encode(_ data: Data, variant: Variant = .standard) -> String {
+        let count = ct_base64_encoded_len(data.count, variant.variant)
+        var characters = [CChar](repeating: 0, count: count + 1)
+        data.withUnsafeBytes { data in
+            _ = ct_base64_encode(&characters, characters.count, data.baseAddress, data.count, variant.variant)
+        }
+        return String(cString: characters)
+    }
+    
+    // Returns nil unless the whole string is valid Base64 of the variant
+    public static func decode(_ string: String, variant: Variant = .standard) -> Data? {
+        let characters = string.utf8CString
+        let count = characters.count - 1 // Without the terminating zero
+        var data = Data(count: count / 4 * 3 + 2)
+        var decodedCount = data.count
+        let isComplete = data.withUnsafeMutableBytes { data in
+            characters.withUnsafeBufferPointer { characters in
+                let end = ct_base64_decode(data.baseAddress, &decodedCount, characters.baseAddress, count, variant.variant)
+                return end != nil && end == characters.baseAddress?.advanced(by: count)
+            }
+        }
+        guard isComplete else {
+            return nil
+        }
+        data.count = decodedCount
+        return data
+    }
+    
+}
@@ -15,12 +15,18 @@ public class DarwinNotificationManager {
             CFNotificationCenterAddObserver(darwinNotifyCenter, selfAsOpaquePointer, { (_, _, _, _, _) in
                 AppGroupUserDefaults.isProcessingMessagesInAppExtension = ReceiveMessageService.shared.isProcessingMessagesInAppExtension
             }, checkStatusInAppExtensionDarwinNotificationName.rawValue, nil, .deliverImmediately)
+            CFNotificationCenterAddObserver(darwinNotifyCenter, selfAsOpaquePointer, { (_, _, _, _, _) in
+                SignalStoreCache.shared.setNeedsRefresh()
+            }, signalDatabaseDidChangeInMainAppDarwinNotificationName.rawValue, nil, .deliverImmediately)
 		} else {
             CFNotificationCenterAddObserver(darwinNotifyCenter, selfAsOpaquePointer, { (_, _, _, _, _) in
                 DispatchQueue.main.asyncAfter(deadline: .now() + 0.2) {
                     NotificationCenter.default.post(onMainThread: conversationDidChangeNotification, object: nil)
                 }
             }, conversationDidChangeInMainAppDarwinNotificationName.rawValue, nil, .deliverImmediately)
+            CFNotificationCenterAddObserver(darwinNotifyCenter, selfAsOpaquePointer, { (_, _, _, _, _) in
+                SignalStoreCache.shared.setNeedsRefresh()
+            }, signalDatabaseDidChangeInAppExtensionDarwinNotificationName.rawValue, nil, .deliverImmediately)
 		}
     }
 
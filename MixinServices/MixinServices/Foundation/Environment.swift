@@ -32,6 +32,8 @@ public var canProcessMessages: Bool {
 
 public let checkStatusInAppExtensionDarwinNotificationName = CFNotificationName(rawValue: "one.mixin.messenger.darwin.status.check.extension" as CFString)
 public let conversationDidChangeInMainAppDarwinNotificationName = CFNotificationName(rawValue: "one.mixin.messenger.darwin.conversation.did.change" as CFString)
+public let signalDatabaseDidChangeInMainAppDarwinNotificationName = CFNotificationName(rawValue: "one.mixin.messenger.darwin.signal.did.change.app" as CFString)
+public let signalDatabaseDidChangeInAppExtensionDarwinNotificationName = CFNotificationName(rawValue: "one.mixin.messenger.darwin.signal.did.change.extension" as CFString)
 
 public enum Mention {
     
@@ -0,0 +1,51 @@
+#ifdef __cplusplus
+
+#import <deque>
+#import <UIKit/UIKit.h>
+#import "md4c.h"
+#import "MXSMarkdownImage.h"
+
+// Rendering state of MXSMarkdownConverter (AttributedString). Exposed for driving the
+// callbacks below from an md_parse shared with other renderers, C++ only.
+
+static const unsigned int plainTextHeaderLevel = 0;
+
+struct Context {
+    const NSUInteger charactersLimit;
+    const NSUInteger linesLimit;
+    NSMutableAttributedString *const output;
+    NSMutableArray<MXSMarkdownImage *> *const images;
+    unsigned headerLevel;
+    unsigned indentationLevel;
+    std::deque<MD_SPANTYPE> spanTypes;
+    unsigned numberOfLines;
+    bool stop;
+    
+    Context(NSMutableAttributedString *o, NSMutableArray<MXSMarkdownImage *> *i, NSUInteger cl, NSUInteger ll)
+    : charactersLimit(cl)
+    , linesLimit(ll)
+    , output(o)
+    , images(i)
+    , headerLevel(plainTextHeaderLevel)
+    , indentationLevel(0)
+    , numberOfLines(0)
+    , stop(false) { }
+    
+    void detectLimit() {
+        bool reaches = output.length >= charactersLimit || numberOfLines >= linesLimit;
+        if (reaches) {
+            stop = true;
+        }
+    }
+};
+
+int enterBlock(MD_BLOCKTYPE type, void* detail, void* userdata);
+int leaveBlock(MD_BLOCKTYPE type, void* detail, void* userdata);
+int enterSpan(MD_SPANTYPE type, void* detail, void* userdata);
+int leaveSpan(MD_SPANTYPE type, void* detail, void* userdata);
+int enterText(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata);
+
+// Call after md_parse returns, trims trailing whitespaces of the output
+NSAttributedString *attributedStringFromContext(Context *ctx);
+
+#endif
@@ -1,5 +1,6 @@
 #import <Foundation/Foundation.h>
 #import "MXSMarkdownConverter.h"
+#import "MXSMarkdownImage.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -11,6 +12,14 @@ NS_ASSUME_NONNULL_BEGIN
                                           maxNumberOfLines:(NSUInteger)maxNumberOfLines
 NS_SWIFT_NAME(attributedString(from:maxNumberOfCharacters:maxNumberOfLines:));
 
+// Images are represented by placeholder attachments in the returned string. Their sources
+// and locations are returned with images, load them with MarkdownImageLoader when needed
++ (NSAttributedString *)attributedStringFromMarkdownString:(NSString *)markdownString
+                                     maxNumberOfCharacters:(NSUInteger)maxNumberOfCharacters
+                                          maxNumberOfLines:(NSUInteger)maxNumberOfLines
+                                                    images:(NSArray<MXSMarkdownImage *> * _Nullable * _Nullable)images
+NS_SWIFT_NAME(attributedString(from:maxNumberOfCharacters:maxNumberOfLines:images:));
+
 @end
 
 NS_ASSUME_NONNULL_END
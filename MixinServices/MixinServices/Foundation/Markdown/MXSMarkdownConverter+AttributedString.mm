@@ -1,38 +1,10 @@
-#import <deque>
 #import "md4c.h"
 #import "MXSMarkdownConverter+AttributedString.h"
+#import "MXSMarkdownAttributedStringContext.h"
 #import "MXSMarkdownImageAttachment.h"
 
-static const unsigned int plainTextHeaderLevel = 0;
 static const CGFloat plainTextFontSize = 17;
 
-struct Context {
-    const NSUInteger charactersLimit;
-    const NSUInteger linesLimit;
-    NSMutableAttributedString *const output;
-    unsigned headerLevel;
-    unsigned indentationLevel;
-    std::deque<MD_SPANTYPE> spanTypes;
-    unsigned numberOfLines;
-    bool stop;
-    
-    Context(NSMutableAttributedString *o, NSUInteger cl, NSUInteger ll)
-    : charactersLimit(cl)
-    , linesLimit(ll)
-    , output(o)
-    , headerLevel(plainTextHeaderLevel)
-    , indentationLevel(0)
-    , numberOfLines(0)
-    , stop(false) { }
-    
-    void detectLimit() {
-        bool reaches = output.length >= charactersLimit || numberOfLines >= linesLimit;
-        if (reaches) {
-            stop = true;
-        }
-    }
-};
-
 @implementation MXSMarkdownConverter (AttributedString)
 
 + (NSUInteger)unlimitedNumber {
@@ -42,7 +14,18 @@ struct Context {
 + (NSAttributedString *)attributedStringFromMarkdownString:(NSString *)markdownString
                                      maxNumberOfCharacters:(NSUInteger)maxNumberOfCharacters
                                           maxNumberOfLines:(NSUInteger)maxNumberOfLines {
+    return [self attributedStringFromMarkdownString:markdownString
+                              maxNumberOfCharacters:maxNumberOfCharacters
+                                   maxNumberOfLines:maxNumberOfLines
+                                             images:nil];
+}
+
++ (NSAttributedString *)attributedStringFromMarkdownString:(NSString *)markdownString
+                                     maxNumberOfCharacters:(NSUInteger)maxNumberOfCharacters
+                                          maxNumberOfLines:(NSUInteger)maxNumberOfLines
+                                                    images:(NSArray<MXSMarkdownImage *> **)images {
     NSMutableAttributedString *output = [NSMutableAttributedString new];
+    NSMutableArray<MXSMarkdownImage *> *foundImages = images ? [NSMutableArray new] : nil;
     MD_PARSER parser = {
         0,
         MD_DIALECT_GITHUB,
@@ -56,23 +39,15 @@ struct Context {
     };
     const char* str = markdownString.UTF8String;
     const size_t size = strlen(str);
-    Context *const ctx = new Context(output, maxNumberOfCharacters, maxNumberOfLines);
+    Context *const ctx = new Context(output, foundImages, maxNumberOfCharacters, maxNumberOfLines);
     md_parse(str, (MD_SIZE)size, &parser, ctx);
-    NSDictionary *attributes = attributesFromContext(ctx, 1);
+    NSAttributedString *attributedString = attributedStringFromContext(ctx);
     delete ctx;
     
-    NSString *plain = output.string;
-    NSRange range = [plain rangeOfCharacterFromSet:NSCharacterSet.whitespaceAndNewlineCharacterSet
-                                           options:NSBackwardsSearch];
-    while (range.length != 0 && NSMaxRange(range) == plain.length) {
-        [output replaceCharactersInRange:range withString:@""];
-        range = [plain rangeOfCharacterFromSet:NSCharacterSet.whitespaceAndNewlineCharacterSet
-                                       options:NSBackwardsSearch];
+    if (images) {
+        *images = [foundImages copy];
     }
-    auto linebreak = [[NSAttributedString alloc] initWithString:@"\n" attributes:attributes];
-    [output appendAttributedString:linebreak];
-    
-    return [output copy];
+    return attributedString;
 }
 
 NSDictionary *attributesFromContext(Context *ctx, CGFloat lineHeightMultiple) {
@@ -145,6 +120,22 @@ NSDictionary *attributesFromContext(Context *ctx, CGFloat lineHeightMultiple) {
     };
 }
 
+NSAttributedString *attributedStringFromContext(Context *ctx) {
+    NSMutableAttributedString *output = ctx->output;
+    NSDictionary *attributes = attributesFromContext(ctx, 1);
+    NSString *plain = output.string;
+    NSRange range = [plain rangeOfCharacterFromSet:NSCharacterSet.whitespaceAndNewlineCharacterSet
+                                           options:NSBackwardsSearch];
+    while (range.length != 0 && NSMaxRange(range) == plain.length) {
+        [output replaceCharactersInRange:range withString:@""];
+        range = [plain rangeOfCharacterFromSet:NSCharacterSet.whitespaceAndNewlineCharacterSet
+                                       options:NSBackwardsSearch];
+    }
+    auto linebreak = [[NSAttributedString alloc] initWithString:@"\n" attributes:attributes];
+    [output appendAttributedString:linebreak];
+    return [output copy];
+}
+
 void appendLinebreak(Context *context, CGFloat heightMultiple) {
     NSString *plain = context->output.string;
     NSUInteger length = plain.length;
@@ -237,8 +228,18 @@ int enterSpan(MD_SPANTYPE type, void* detail, void* userdata) {
     context->spanTypes.push_back(type);
     if (type == MD_SPAN_IMG) {
         bool hasEnoughTextBeforeImage = context->numberOfLines > 1 || context->output.length > 5;
-        auto *attachment = [MXSMarkdownImageAttachment new];
-        auto *string = [NSAttributedString attributedStringWithAttachment:attachment];
+        if (context->images) {
+            auto *imageDetail = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
+            auto *source = [[NSString alloc] initWithBytes:imageDetail->src.text
+                                                    length:imageDetail->src.size
+                                                  encoding:NSUTF8StringEncoding];
+            if (source) {
+                auto *image = [[MXSMarkdownImage alloc] initWithSource:source
+                                                              location:context->output.length];
+                [context->images addObject:image];
+            }
+        }
+        auto *string = [NSAttributedString attributedStringWithAttachment:[MXSMarkdownImageAttachment new]];
         [context->output appendAttributedString:string];
         if (hasEnoughTextBeforeImage) {
             appendLinebreak(context, 0.7);
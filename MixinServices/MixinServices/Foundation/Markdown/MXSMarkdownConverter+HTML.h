@@ -9,6 +9,10 @@ NS_ASSUME_NONNULL_BEGIN
                                 richFormat:(BOOL)rich
 NS_SWIFT_NAME(htmlString(from:richFormat:));
 
+// Document head and tail wrapping the HTML converted from markdown
++ (const char *)htmlHeaderWithRichFormat:(BOOL)rich NS_SWIFT_UNAVAILABLE("");
++ (const char *)htmlFooter NS_SWIFT_UNAVAILABLE("");
+
 @end
 
 NS_ASSUME_NONNULL_END
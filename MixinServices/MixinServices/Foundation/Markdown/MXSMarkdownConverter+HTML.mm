@@ -47,7 +47,7 @@ const char *plainHeader = R"(
         <article class="post">
 )";
 
-NSString *const footer = @"</article></body></html>";
+const char *footer = "</article></body></html>";
 
 void processHTMLOutput(const MD_CHAR *output, MD_SIZE size, void *userData) {
     if (!output) {
@@ -63,17 +63,21 @@ void processHTMLOutput(const MD_CHAR *output, MD_SIZE size, void *userData) {
     }
 }
 
++ (const char *)htmlHeaderWithRichFormat:(BOOL)rich {
+    return rich ? richHeader : plainHeader;
+}
+
++ (const char *)htmlFooter {
+    return footer;
+}
+
 + (NSString *)htmlStringFromMarkdownString:(NSString *)markdownString richFormat:(BOOL)rich {
-    NSMutableString *output;
-    if (rich) {
-        output = [[NSMutableString alloc] initWithCString:richHeader encoding:NSUTF8StringEncoding];
-    } else {
-        output = [[NSMutableString alloc] initWithCString:plainHeader encoding:NSUTF8StringEncoding];
-    }
+    const char *header = [self htmlHeaderWithRichFormat:rich];
+    NSMutableString *output = [[NSMutableString alloc] initWithCString:header encoding:NSUTF8StringEncoding];
     const char *cMarkdown = [markdownString cStringUsingEncoding:NSUTF8StringEncoding];
     size_t length = strlen(cMarkdown);
     md_html(cMarkdown, (MD_SIZE)length, &processHTMLOutput, (__bridge void *)(output), MD_DIALECT_GITHUB, 0);
-    [output appendString:footer];
+    [output appendString:@(footer)];
     return output;
 }
 
@@ -0,0 +1,35 @@
+#import <UIKit/UIKit.h>
+#import "MXSMarkdownConverter.h"
+#import "MXSMarkdownLayout.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface MXSMarkdownConverter (Layout)
+
+// Lays out attributedString with TextKit, safe to be called from any thread.
+// Results are cached by contentHash and the layout size, callers should make contentHash
+// cover everything affects the attributed string, e.g. the source and the content size category.
+// Image placeholders are measured at their intrinsic 900x338, the same as boundingRect does
++ (MXSMarkdownLayout *)layoutOfAttributedString:(NSAttributedString *)attributedString
+                                    contentHash:(NSUInteger)contentHash
+                                          width:(CGFloat)width
+                                      maxHeight:(CGFloat)maxHeight
+NS_SWIFT_NAME(layout(of:contentHash:width:maxHeight:));
+
+// Performs the layout above on a background queue, completion is called on main queue.
+// A layout being prepared is not laid out again, the call above waits for it instead
++ (void)prepareLayoutOfAttributedString:(NSAttributedString *)attributedString
+                            contentHash:(NSUInteger)contentHash
+                                  width:(CGFloat)width
+                              maxHeight:(CGFloat)maxHeight
+                             completion:(void (^ _Nullable)(MXSMarkdownLayout *layout))completion
+NS_SWIFT_NAME(prepareLayout(of:contentHash:width:maxHeight:completion:));
+
++ (nullable MXSMarkdownLayout *)cachedLayoutForContentHash:(NSUInteger)contentHash
+                                                     width:(CGFloat)width
+                                                 maxHeight:(CGFloat)maxHeight
+NS_SWIFT_NAME(cachedLayout(contentHash:width:maxHeight:));
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,152 @@
+#import "MXSMarkdownConverter+Layout.h"
+#import "MXSMarkdownMeasuringTextContainer.h"
+
+@implementation MXSMarkdownConverter (Layout)
+
+static NSCache<NSString *, MXSMarkdownLayout *> *layoutCache(void) {
+    static NSCache *cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [NSCache new];
+        cache.countLimit = 500;
+    });
+    return cache;
+}
+
+// Layouts being prepared in background, keyed by the cache key. Guarded by pendingLayoutsLock
+static NSMutableDictionary<NSString *, dispatch_group_t> *pendingLayouts;
+static NSLock *pendingLayoutsLock;
+
+static void initPendingLayouts(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pendingLayouts = [NSMutableDictionary new];
+        pendingLayoutsLock = [NSLock new];
+    });
+}
+
+static NSString *layoutCacheKey(NSUInteger contentHash, CGFloat width, CGFloat maxHeight) {
+    return [NSString stringWithFormat:@"%lu-%.1f-%.1f", (unsigned long)contentHash, width, maxHeight];
+}
+
+static MXSMarkdownLayout *layoutFromAttributedString(NSAttributedString *attributedString, CGFloat width, CGFloat maxHeight) {
+    NSTextStorage *storage = [[NSTextStorage alloc] initWithAttributedString:attributedString];
+    NSLayoutManager *layoutManager = [NSLayoutManager new];
+    NSTextContainer *container = [[MXSMarkdownMeasuringTextContainer alloc] initWithSize:CGSizeMake(width, CGFLOAT_MAX)];
+    container.lineFragmentPadding = 0;
+    [layoutManager addTextContainer:container];
+    [storage addLayoutManager:layoutManager];
+    [layoutManager ensureLayoutForTextContainer:container];
+    
+    __block NSUInteger numberOfLines = 0;
+    __block NSUInteger truncationLocation = NSNotFound;
+    NSRange glyphRange = [layoutManager glyphRangeForTextContainer:container];
+    [layoutManager enumerateLineFragmentsForGlyphRange:glyphRange
+                                            usingBlock:^(CGRect rect, CGRect usedRect, NSTextContainer *textContainer, NSRange lineGlyphRange, BOOL *stop) {
+        if (CGRectGetMaxY(rect) > maxHeight) {
+            truncationLocation = [layoutManager characterIndexForGlyphAtIndex:lineGlyphRange.location];
+            *stop = YES;
+        } else {
+            numberOfLines++;
+        }
+    }];
+    
+    CGRect usedRect = [layoutManager usedRectForTextContainer:container];
+    CGSize size = CGSizeMake(ceil(CGRectGetWidth(usedRect)), ceil(CGRectGetHeight(usedRect)));
+    return [[MXSMarkdownLayout alloc] initWithSize:size
+                                     numberOfLines:numberOfLines
+                                truncationLocation:truncationLocation];
+}
+
++ (MXSMarkdownLayout *)layoutOfAttributedString:(NSAttributedString *)attributedString
+                                    contentHash:(NSUInteger)contentHash
+                                          width:(CGFloat)width
+                                      maxHeight:(CGFloat)maxHeight {
+    NSString *key = layoutCacheKey(contentHash, width, maxHeight);
+    MXSMarkdownLayout *layout = [layoutCache() objectForKey:key];
+    if (layout) {
+        return layout;
+    }
+    
+    // Wait for the preparation instead of laying out the same string again
+    initPendingLayouts();
+    [pendingLayoutsLock lock];
+    dispatch_group_t group = pendingLayouts[key];
+    [pendingLayoutsLock unlock];
+    if (group) {
+        dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+        layout = [layoutCache() objectForKey:key];
+        if (layout) {
+            return layout;
+        }
+    }
+    
+    layout = layoutFromAttributedString(attributedString, width, maxHeight);
+    [layoutCache() setObject:layout forKey:key];
+    return layout;
+}
+
++ (void)prepareLayoutOfAttributedString:(NSAttributedString *)attributedString
+                            contentHash:(NSUInteger)contentHash
+                                  width:(CGFloat)width
+                              maxHeight:(CGFloat)maxHeight
+                             completion:(void (^)(MXSMarkdownLayout *))completion {
+    NSString *key = layoutCacheKey(contentHash, width, maxHeight);
+    MXSMarkdownLayout *cachedLayout = [layoutCache() objectForKey:key];
+    if (cachedLayout) {
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(cachedLayout);
+            });
+        }
+        return;
+    }
+    
+    initPendingLayouts();
+    [pendingLayoutsLock lock];
+    dispatch_group_t group = pendingLayouts[key];
+    BOOL isPending = group != nil;
+    if (!isPending) {
+        group = dispatch_group_create();
+        dispatch_group_enter(group);
+        pendingLayouts[key] = group;
+    }
+    [pendingLayoutsLock unlock];
+    
+    if (isPending) {
+        if (completion) {
+            dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+                MXSMarkdownLayout *layout = [self layoutOfAttributedString:attributedString
+                                                               contentHash:contentHash
+                                                                     width:width
+                                                                 maxHeight:maxHeight];
+                completion(layout);
+            });
+        }
+        return;
+    }
+    
+    NSAttributedString *string = [attributedString copy];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        MXSMarkdownLayout *layout = layoutFromAttributedString(string, width, maxHeight);
+        [layoutCache() setObject:layout forKey:key];
+        [pendingLayoutsLock lock];
+        [pendingLayouts removeObjectForKey:key];
+        [pendingLayoutsLock unlock];
+        dispatch_group_leave(group);
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(layout);
+            });
+        }
+    });
+}
+
++ (MXSMarkdownLayout *)cachedLayoutForContentHash:(NSUInteger)contentHash
+                                            width:(CGFloat)width
+                                        maxHeight:(CGFloat)maxHeight {
+    NSString *key = layoutCacheKey(contentHash, width, maxHeight);
+    return [layoutCache() objectForKey:key];
+}
+
+@end
@@ -0,0 +1,21 @@
+#import <Foundation/Foundation.h>
+#import "MXSMarkdownConverter.h"
+#import "MXSMarkdownRendering.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface MXSMarkdownConverter (Rendering)
+
+// Parses markdownString once and renders all requested outputs from the same callbacks.
+// richFormat applies to HTML, limits apply to the attributed string as they do
+// with attributedString(from:maxNumberOfCharacters:maxNumberOfLines:)
++ (MXSMarkdownRendering *)renderMarkdownString:(NSString *)markdownString
+                                       outputs:(MXSMarkdownOutput)outputs
+                                    richFormat:(BOOL)rich
+                         maxNumberOfCharacters:(NSUInteger)maxNumberOfCharacters
+                              maxNumberOfLines:(NSUInteger)maxNumberOfLines
+NS_SWIFT_NAME(render(from:outputs:richFormat:maxNumberOfCharacters:maxNumberOfLines:));
+
+@end
+
+NS_ASSUME_NONNULL_END
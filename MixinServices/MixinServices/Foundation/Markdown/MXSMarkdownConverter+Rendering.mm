@@ -0,0 +1,194 @@
+#import "MXSMarkdownConverter+Rendering.h"
+#import "MXSMarkdownConverter+HTML.h"
+#import "MXSMarkdownAttributedStringContext.h"
+#import "md4c.h"
+#import "md4c-html.h"
+#import "md4c-text.h"
+
+// Forwards callbacks of one md_parse to every renderer. A renderer aborting the parsing
+// is removed from the fan-out, the parsing goes on until all renderers abort.
+struct Fanout {
+    
+    struct Renderer {
+        MD_PARSER parser;
+        void *userdata;
+        bool finished;
+    };
+    
+    static const size_t maxNumberOfRenderers = 3;
+    Renderer renderers[maxNumberOfRenderers];
+    size_t numberOfRenderers;
+    
+    Fanout()
+    : numberOfRenderers(0) { }
+    
+    void add(const MD_PARSER &parser, void *userdata) {
+        renderers[numberOfRenderers++] = { parser, userdata, false };
+    }
+    
+    template <typename Callback>
+    int forward(Callback callback) {
+        bool finished = true;
+        for (size_t i = 0; i < numberOfRenderers; i++) {
+            Renderer &renderer = renderers[i];
+            if (renderer.finished) {
+                continue;
+            }
+            if (callback(renderer) != 0) {
+                renderer.finished = true;
+            } else {
+                finished = false;
+            }
+        }
+        return finished ? -1 : 0;
+    }
+    
+};
+
+static int fanoutEnterBlock(MD_BLOCKTYPE type, void* detail, void* userdata) {
+    return static_cast<Fanout*>(userdata)->forward([=](Fanout::Renderer &r) {
+        return r.parser.enter_block(type, detail, r.userdata);
+    });
+}
+
+static int fanoutLeaveBlock(MD_BLOCKTYPE type, void* detail, void* userdata) {
+    return static_cast<Fanout*>(userdata)->forward([=](Fanout::Renderer &r) {
+        return r.parser.leave_block(type, detail, r.userdata);
+    });
+}
+
+static int fanoutEnterSpan(MD_SPANTYPE type, void* detail, void* userdata) {
+    return static_cast<Fanout*>(userdata)->forward([=](Fanout::Renderer &r) {
+        return r.parser.enter_span(type, detail, r.userdata);
+    });
+}
+
+static int fanoutLeaveSpan(MD_SPANTYPE type, void* detail, void* userdata) {
+    return static_cast<Fanout*>(userdata)->forward([=](Fanout::Renderer &r) {
+        return r.parser.leave_span(type, detail, r.userdata);
+    });
+}
+
+static int fanoutText(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata) {
+    return static_cast<Fanout*>(userdata)->forward([=](Fanout::Renderer &r) {
+        return r.parser.text(type, text, size, r.userdata);
+    });
+}
+
+static void appendHTMLOutput(const MD_CHAR *output, MD_SIZE size, void *userData) {
+    if (!output) {
+        return;
+    }
+    NSMutableData *writeBack = (__bridge NSMutableData *)(userData);
+    [writeBack appendBytes:output length:size];
+}
+
+@implementation MXSMarkdownConverter (Rendering)
+
++ (MXSMarkdownRendering *)renderMarkdownString:(NSString *)markdownString
+                                       outputs:(MXSMarkdownOutput)outputs
+                                    richFormat:(BOOL)rich
+                         maxNumberOfCharacters:(NSUInteger)maxNumberOfCharacters
+                              maxNumberOfLines:(NSUInteger)maxNumberOfLines {
+    const char* md = markdownString.UTF8String;
+    const size_t size = strlen(md);
+    Fanout fanout;
+    
+    NSMutableData *html = nil;
+    MD_HTML htmlRenderer;
+    if (outputs & MXSMarkdownOutputHTML) {
+        const char *header = [self htmlHeaderWithRichFormat:rich];
+        html = [NSMutableData dataWithCapacity:strlen(header) + size * 2];
+        [html appendBytes:header length:strlen(header)];
+        md_html_init(&htmlRenderer, appendHTMLOutput, (__bridge void *)html, 0);
+        MD_PARSER parser;
+        md_html_init_parser(&parser, MD_DIALECT_GITHUB);
+        fanout.add(parser, &htmlRenderer);
+    }
+    
+    Context *attributedRenderer = nullptr;
+    NSMutableArray<MXSMarkdownImage *> *images = nil;
+    if (outputs & MXSMarkdownOutputAttributedString) {
+        NSMutableAttributedString *output = [NSMutableAttributedString new];
+        images = [NSMutableArray new];
+        attributedRenderer = new Context(output, images, maxNumberOfCharacters, maxNumberOfLines);
+        MD_PARSER parser = {
+            0,
+            MD_DIALECT_GITHUB,
+            enterBlock,
+            leaveBlock,
+            enterSpan,
+            leaveSpan,
+            enterText,
+            NULL,
+            NULL
+        };
+        fanout.add(parser, attributedRenderer);
+    }
+    
+    char *text = NULL;
+    MD_TEXT textRenderer;
+    if (outputs & MXSMarkdownOutputPlainText && size > 0) {
+        const MD_SIZE capacity = md_text_capacity(md, (MD_SIZE)size);
+        text = static_cast<char *>(malloc(capacity));
+        if (text) {
+            md_text_init(&textRenderer, text, capacity, 0, 0);
+            MD_PARSER parser;
+            md_text_init_parser(&parser, MD_DIALECT_GITHUB);
+            fanout.add(parser, &textRenderer);
+        }
+    }
+    
+    MD_PARSER parser = {
+        0,
+        MD_DIALECT_GITHUB,
+        fanoutEnterBlock,
+        fanoutLeaveBlock,
+        fanoutEnterSpan,
+        fanoutLeaveSpan,
+        fanoutText,
+        NULL,
+        NULL
+    };
+    if (fanout.numberOfRenderers > 0) {
+        md_parse(md, (MD_SIZE)size, &parser, &fanout);
+    }
+    
+    NSString *htmlString = nil;
+    if (html) {
+        const char *footer = [self htmlFooter];
+        [html appendBytes:footer length:strlen(footer)];
+        htmlString = [[NSString alloc] initWithData:html encoding:NSUTF8StringEncoding];
+    }
+    
+    NSAttributedString *attributedString = nil;
+    if (attributedRenderer) {
+        attributedString = attributedStringFromContext(attributedRenderer);
+        delete attributedRenderer;
+    }
+    
+    NSString *plainText = nil;
+    if (outputs & MXSMarkdownOutputPlainText) {
+        if (text) {
+            MD_SIZE textSize = 0;
+            md_text_finish(&textRenderer, &textSize);
+            plainText = [[NSString alloc] initWithBytesNoCopy:text
+                                                       length:textSize
+                                                     encoding:NSUTF8StringEncoding
+                                                 freeWhenDone:YES];
+            if (!plainText) {
+                free(text);
+            }
+        }
+        if (!plainText) {
+            plainText = @"";
+        }
+    }
+    
+    return [[MXSMarkdownRendering alloc] initWithHTMLString:htmlString
+                                           attributedString:attributedString
+                                                  plainText:plainText
+                                                     images:images];
+}
+
+@end
@@ -8,6 +8,21 @@ NS_SWIFT_NAME(MarkdownConverter)
 + (NSString *)plainTextFromMarkdownString:(NSString *)markdownString
 NS_SWIFT_NAME(plainText(from:));
 
+// Output is cut on a UTF-8 sequence boundary once it reaches maxNumberOfBytes
++ (NSString *)plainTextFromMarkdownString:(NSString *)markdownString
+                         maxNumberOfBytes:(NSUInteger)maxNumberOfBytes
+NS_SWIFT_NAME(plainText(from:maxNumberOfBytes:));
+
+// Characters are counted in UTF-16 code units as NSString does. Parsing stops as soon as
+// the output reaches maxNumberOfCharacters, or the first line ends if singleLine is set.
+// truncated is set to YES if there is more text beyond maxNumberOfCharacters. The cut is
+// on a code point and may split the last grapheme cluster of a truncated output
++ (NSString *)plainTextFromMarkdownString:(NSString *)markdownString
+                    maxNumberOfCharacters:(NSUInteger)maxNumberOfCharacters
+                               singleLine:(BOOL)singleLine
+                                truncated:(nullable BOOL *)truncated
+NS_SWIFT_NAME(plainText(from:maxNumberOfCharacters:singleLine:truncated:));
+
 - (instancetype)init NS_UNAVAILABLE;
 
 @end
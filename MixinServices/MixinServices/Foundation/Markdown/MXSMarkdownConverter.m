@@ -1,49 +1,62 @@
 #import "MXSMarkdownConverter.h"
 #import "md4c.h"
+#import "md4c-text.h"
 
 // Swift doesn't work here because MD_DIALECT_GITHUB is not representable
 @implementation MXSMarkdownConverter
 
-int processPlainTextOutput(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata) {
-    if (!text) {
-        return 0;
+static NSString *plainTextFromMarkdownString(NSString *markdownString, NSUInteger maxNumberOfBytes, MD_SIZE maxLength, unsigned flags, BOOL *truncated) {
+    if (truncated) {
+        *truncated = NO;
+    }
+    const char* md = markdownString.UTF8String;
+    size_t size = strlen(md);
+    if (size == 0) {
+        return @"";
+    }
+    // Large enough for the whole output, this buffer is the only allocation
+    size_t capacity = MIN(md_text_capacity(md, (MD_SIZE)size), maxNumberOfBytes);
+    if (capacity == 0) {
+        return @"";
+    }
+    char *output = malloc(capacity);
+    if (!output) {
+        return @"";
     }
-    NSMutableString *writeBack = (__bridge NSMutableString *)(userdata);
-    NSString *newOutput = [[NSString alloc] initWithBytesNoCopy:(void *)text
-                                                         length:size
-                                                       encoding:NSUTF8StringEncoding
-                                                   freeWhenDone:NO];
-    if (newOutput) {
-        [writeBack appendString:newOutput];
+    MD_SIZE outputSize = 0;
+    int result = md_text(md, (MD_SIZE)size, output, (MD_SIZE)capacity, &outputSize, maxLength, MD_DIALECT_GITHUB, flags);
+    if (truncated) {
+        *truncated = result == 1;
     }
-    return 0;
+    NSString *text = [[NSString alloc] initWithBytesNoCopy:output
+                                                    length:outputSize
+                                                  encoding:NSUTF8StringEncoding
+                                              freeWhenDone:YES];
+    if (!text) {
+        free(output);
+        return @"";
+    }
+    return text;
 }
 
-int processPlainTextBlock(MD_BLOCKTYPE type, void* detail, void* userdata) {
-    return 0;
++ (NSString *)plainTextFromMarkdownString:(NSString *)markdownString {
+    return [self plainTextFromMarkdownString:markdownString maxNumberOfBytes:NSUIntegerMax];
 }
 
-int processPlainTextSpan(MD_SPANTYPE type, void* detail, void* userdata) {
-    return 0;
++ (NSString *)plainTextFromMarkdownString:(NSString *)markdownString
+                         maxNumberOfBytes:(NSUInteger)maxNumberOfBytes {
+    return plainTextFromMarkdownString(markdownString, maxNumberOfBytes, 0, 0, NULL);
 }
 
-+ (NSString *)plainTextFromMarkdownString:(NSString *)markdownString {
-    NSMutableString *output = [NSMutableString new];
-    const char* md = markdownString.UTF8String;
-    size_t size = strlen(md);
-    MD_PARSER parser = {
-        0,
-        MD_DIALECT_GITHUB,
-        processPlainTextBlock,
-        processPlainTextBlock,
-        processPlainTextSpan,
-        processPlainTextSpan,
-        processPlainTextOutput,
-        NULL,
-        NULL
-    };
-    md_parse(md, (MD_SIZE)size, &parser, (__bridge void *)(output));
-    return [output copy];
++ (NSString *)plainTextFromMarkdownString:(NSString *)markdownString
+                    maxNumberOfCharacters:(NSUInteger)maxNumberOfCharacters
+                               singleLine:(BOOL)singleLine
+                                truncated:(BOOL *)truncated {
+    // A UTF-16 code unit takes at most 3 bytes in UTF-8, surrogate pairs take 4 for 2 units
+    NSUInteger maxNumberOfBytes = maxNumberOfCharacters > NSUIntegerMax / 3 ? NSUIntegerMax : maxNumberOfCharacters * 3;
+    MD_SIZE maxLength = maxNumberOfCharacters >= UINT_MAX ? 0 : (MD_SIZE)maxNumberOfCharacters;
+    unsigned flags = singleLine ? MD_TEXT_FLAG_SINGLE_LINE : 0;
+    return plainTextFromMarkdownString(markdownString, maxNumberOfBytes, maxLength, flags, truncated);
 }
 
 @end
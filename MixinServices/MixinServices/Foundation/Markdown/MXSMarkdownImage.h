@@ -0,0 +1,18 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// An image found during conversion. Images are not loaded by the converter,
+// the attributed string only contains a placeholder attachment at location.
+NS_SWIFT_NAME(MarkdownImage)
+@interface MXSMarkdownImage : NSObject
+
+@property (nonatomic, copy, readonly) NSString *source;
+@property (nonatomic, readonly) NSUInteger location;
+
+- (instancetype)initWithSource:(NSString *)source location:(NSUInteger)location;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,14 @@
+#import "MXSMarkdownImage.h"
+
+@implementation MXSMarkdownImage
+
+- (instancetype)initWithSource:(NSString *)source location:(NSUInteger)location {
+    self = [super init];
+    if (self) {
+        _source = [source copy];
+        _location = location;
+    }
+    return self;
+}
+
+@end
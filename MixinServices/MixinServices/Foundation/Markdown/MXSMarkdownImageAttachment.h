@@ -2,6 +2,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Reserves the space of an image before it's loaded. Once image is set, it's
+// laid out with the aspect ratio of the image instead
 @interface MXSMarkdownImageAttachment : NSTextAttachment
 
 @end
@@ -1,4 +1,5 @@
 #import "MXSMarkdownImageAttachment.h"
+#import "MXSMarkdownMeasuringTextContainer.h"
 
 @implementation MXSMarkdownImageAttachment
 
@@ -6,7 +7,12 @@
                       proposedLineFragment:(CGRect)lineFrag
                              glyphPosition:(CGPoint)position
                             characterIndex:(NSUInteger)charIndex {
-    if (textContainer == nil) {
+    CGSize imageSize = self.image.size;
+    if (textContainer && imageSize.width > 0 && imageSize.height > 0) {
+        CGFloat height = round(textContainer.size.width / imageSize.width * imageSize.height);
+        return CGRectMake(0, 0, textContainer.size.width, height);
+    }
+    if (textContainer == nil || [textContainer isKindOfClass:[MXSMarkdownMeasuringTextContainer class]]) {
         return CGRectMake(0, 0, 900, 338);
     }
     CGFloat height = round(textContainer.size.width / 900 * 338);
@@ -0,0 +1,21 @@
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+NS_SWIFT_NAME(MarkdownLayout)
+@interface MXSMarkdownLayout : NSObject
+
+@property (nonatomic, readonly) CGSize size;
+@property (nonatomic, readonly) NSUInteger numberOfLines;
+
+// Location of the first character which doesn't fit into max height, NSNotFound if all fit
+@property (nonatomic, readonly) NSUInteger truncationLocation;
+
+- (instancetype)initWithSize:(CGSize)size
+               numberOfLines:(NSUInteger)numberOfLines
+          truncationLocation:(NSUInteger)truncationLocation;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,17 @@
+#import "MXSMarkdownLayout.h"
+
+@implementation MXSMarkdownLayout
+
+- (instancetype)initWithSize:(CGSize)size
+               numberOfLines:(NSUInteger)numberOfLines
+          truncationLocation:(NSUInteger)truncationLocation {
+    self = [super init];
+    if (self) {
+        _size = size;
+        _numberOfLines = numberOfLines;
+        _truncationLocation = truncationLocation;
+    }
+    return self;
+}
+
+@end
@@ -0,0 +1,11 @@
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Text container used for estimating the size of converted strings. Image placeholders
+// keep their intrinsic bounds in it, as they do when measured with boundingRect
+@interface MXSMarkdownMeasuringTextContainer : NSTextContainer
+
+@end
+
+NS_ASSUME_NONNULL_END
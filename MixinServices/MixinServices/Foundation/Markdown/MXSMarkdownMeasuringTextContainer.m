@@ -0,0 +1,5 @@
+#import "MXSMarkdownMeasuringTextContainer.h"
+
+@implementation MXSMarkdownMeasuringTextContainer
+
+@end
@@ -0,0 +1,31 @@
+#import <Foundation/Foundation.h>
+#import "MXSMarkdownImage.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_OPTIONS(NSUInteger, MXSMarkdownOutput) {
+    MXSMarkdownOutputHTML               = 1 << 0,
+    MXSMarkdownOutputAttributedString   = 1 << 1,
+    MXSMarkdownOutputPlainText          = 1 << 2,
+} NS_SWIFT_NAME(MarkdownOutput);
+
+// Outputs not requested are nil
+NS_SWIFT_NAME(MarkdownRendering)
+@interface MXSMarkdownRendering : NSObject
+
+@property (nonatomic, copy, readonly, nullable) NSString *htmlString;
+@property (nonatomic, copy, readonly, nullable) NSAttributedString *attributedString;
+@property (nonatomic, copy, readonly, nullable) NSString *plainText;
+
+// Images placeheld in attributedString, load them with MarkdownImageLoader when needed
+@property (nonatomic, copy, readonly, nullable) NSArray<MXSMarkdownImage *> *images;
+
+- (instancetype)initWithHTMLString:(nullable NSString *)htmlString
+                  attributedString:(nullable NSAttributedString *)attributedString
+                         plainText:(nullable NSString *)plainText
+                            images:(nullable NSArray<MXSMarkdownImage *> *)images;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
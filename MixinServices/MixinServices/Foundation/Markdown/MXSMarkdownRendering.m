@@ -0,0 +1,19 @@
+#import "MXSMarkdownRendering.h"
+
+@implementation MXSMarkdownRendering
+
+- (instancetype)initWithHTMLString:(NSString *)htmlString
+                  attributedString:(NSAttributedString *)attributedString
+                         plainText:(NSString *)plainText
+                            images:(NSArray<MXSMarkdownImage *> *)images {
+    self = [super init];
+    if (self) {
+        _htmlString = [htmlString copy];
+        _attributedString = [attributedString copy];
+        _plainText = [plainText copy];
+        _images = [images copy];
+    }
+    return self;
+}
+
+@end
@@ -0,0 +1,69 @@
+import UIKit
+import SDWebImage
+
+public enum MarkdownImageLoader {
+    
+    public enum Priority {
+        case visible
+        case prefetching
+    }
+    
+    // Images are decoded by SDWebImage on its coder queue, completion is called on main queue
+    @discardableResult
+    public static func load(
+        _ image: MarkdownImage,
+        priority: Priority,
+        completion: @escaping (MXSMarkdownImageAttachment?) -> Void
+    ) -> SDWebImageCombinedOperation? {
+        guard let url = URL(string: image.source) else {
+            completion(nil)
+            return nil
+        }
+        let options: SDWebImageOptions
+        switch priority {
+        case .visible:
+            options = [.highPriority, .scaleDownLargeImages]
+        case .prefetching:
+            options = [.lowPriority, .scaleDownLargeImages]
+        }
+        return SDWebImageManager.shared.loadImage(with: url, options: options, progress: nil) { (image, _, error, _, _, _) in
+            guard let image = image, error == nil else {
+                completion(nil)
+                return
+            }
+            let attachment = MXSMarkdownImageAttachment()
+            attachment.image = image
+            completion(attachment)
+        }
+    }
+    
+    // Returns the image loaded before if it's still in memory cache. Disk cache is never
+    // read here, it's called when view models are created and must not block on decoding.
+    public static func cachedAttachment(of image: MarkdownImage) -> MXSMarkdownImageAttachment? {
+        guard let url = URL(string: image.source) else {
+            return nil
+        }
+        let key = SDWebImageManager.shared.cacheKey(for: url)
+        guard let image = SDImageCache.shared.imageFromMemoryCache(forKey: key) else {
+            return nil
+        }
+        let attachment = MXSMarkdownImageAttachment()
+        attachment.image = image
+        return attachment
+    }
+    
+    // Replaces the placeholder at image.location with loaded attachment
+    public static func attributedString(
+        _ string: NSAttributedString,
+        replacingPlaceholderOf image: MarkdownImage,
+        with attachment: MXSMarkdownImageAttachment
+    ) -> NSAttributedString {
+        guard image.location < string.length else {
+            return string
+        }
+        let output = NSMutableAttributedString(attributedString: string)
+        output.addAttribute(.attachment, value: attachment, range: NSRange(location: image.location, length: 1))
+        return output
+    }
+    
+}
@@ -47,15 +47,6 @@
 
 
 
-typedef struct MD_HTML_tag MD_HTML;
-struct MD_HTML_tag {
-    void (*process_output)(const MD_CHAR*, MD_SIZE, void*);
-    void* userdata;
-    unsigned flags;
-    int image_nesting_level;
-    char escape_map[256];
-};
-
 #define NEED_HTML_ESC_FLAG   0x1
 #define NEED_URL_ESC_FLAG    0x2
 
@@ -528,36 +519,55 @@ debug_log_callback(const char* msg, void* userdata)
         fprintf(stderr, "MD4C: %s\n", msg);
 }
 
-int
-md_html(const MD_CHAR* input, MD_SIZE input_size,
-        void (*process_output)(const MD_CHAR*, MD_SIZE, void*),
-        void* userdata, unsigned parser_flags, unsigned renderer_flags)
+void
+md_html_init(MD_HTML* r,
+             void (*process_output)(const MD_CHAR*, MD_SIZE, void*),
+             void* userdata, unsigned renderer_flags)
 {
-    MD_HTML render = { process_output, userdata, renderer_flags, 0, { 0 } };
     int i;
 
-    MD_PARSER parser = {
-        0,
-        parser_flags,
-        enter_block_callback,
-        leave_block_callback,
-        enter_span_callback,
-        leave_span_callback,
-        text_callback,
-        debug_log_callback,
-        NULL
-    };
+    r->process_output = process_output;
+    r->userdata = userdata;
+    r->flags = renderer_flags;
+    r->image_nesting_level = 0;
+    memset(r->escape_map, 0, sizeof(r->escape_map));
 
     /* Build map of characters which need escaping. */
     for(i = 0; i < 256; i++) {
         unsigned char ch = (unsigned char) i;
 
         if(strchr("\"&<>", ch) != NULL)
-            render.escape_map[i] |= NEED_HTML_ESC_FLAG;
+            r->escape_map[i] |= NEED_HTML_ESC_FLAG;
 
         if(!ISALNUM(ch)  &&  strchr("-_.+!*(),%#@?=;:/,+$", ch) == NULL)
-            render.escape_map[i] |= NEED_URL_ESC_FLAG;
+            r->escape_map[i] |= NEED_URL_ESC_FLAG;
     }
+}
+
+void
+md_html_init_parser(MD_PARSER* parser, unsigned parser_flags)
+{
+    parser->abi_version = 0;
+    parser->flags = parser_flags;
+    parser->enter_block = enter_block_callback;
+    parser->leave_block = leave_block_callback;
+    parser->enter_span = enter_span_callback;
+    parser->leave_span = leave_span_callback;
+    parser->text = text_callback;
+    parser->debug_log = debug_log_callback;
+    parser->syntax = NULL;
+}
+
+int
+md_html(const MD_CHAR* input, MD_SIZE input_size,
+        void (*process_output)(const MD_CHAR*, MD_SIZE, void*),
+        void* userdata, unsigned parser_flags, unsigned renderer_flags)
+{
+    MD_HTML render;
+    MD_PARSER parser;
+
+    md_html_init(&render, process_output, userdata, renderer_flags);
+    md_html_init_parser(&parser, parser_flags);
 
     /* Consider skipping UTF-8 byte order mark (BOM). */
     if(renderer_flags & MD_HTML_FLAG_SKIP_UTF8_BOM  &&  sizeof(MD_CHAR) == 1) {
@@ -570,4 +580,3 @@ md_html(const MD_CHAR* input, MD_SIZE input_size,
 
     return md_parse(input, input_size, &parser, (void*) &render);
 }
-
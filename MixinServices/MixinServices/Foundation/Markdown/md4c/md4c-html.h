@@ -40,6 +40,16 @@
 #define MD_HTML_FLAG_XHTML                  0x0008
 
 
+typedef struct MD_HTML_tag MD_HTML;
+struct MD_HTML_tag {
+    void (*process_output)(const MD_CHAR*, MD_SIZE, void*);
+    void* userdata;
+    unsigned flags;
+    int image_nesting_level;
+    char escape_map[256];
+};
+
+
 /* Render Markdown into HTML.
  *
  * Note only contents of <body> tag is generated. Caller must generate
@@ -60,6 +70,18 @@ int md_html(const MD_CHAR* input, MD_SIZE input_size,
             void (*process_output)(const MD_CHAR*, MD_SIZE, void*),
             void* userdata, unsigned parser_flags, unsigned renderer_flags);
 
+/* Lower level interface for driving the HTML renderer from an md_parse() call
+ * of the caller, e.g. one shared with other renderers.
+ *
+ * md_html_init() prepares the renderer state 'r' with the same params as
+ * md_html() does. md_html_init_parser() fills 'parser' with the renderer
+ * callbacks, which expect a pointer to the state as their userdata.
+ */
+void md_html_init(MD_HTML* r,
+                  void (*process_output)(const MD_CHAR*, MD_SIZE, void*),
+                  void* userdata, unsigned renderer_flags);
+void md_html_init_parser(MD_PARSER* parser, unsigned parser_flags);
+
 
 #ifdef __cplusplus
     }  /* extern "C" { */
@@ -0,0 +1,266 @@
+/*
+ * MD4C: Markdown parser for C
+ * (http://github.com/mity/md4c)
+ *
+ * Copyright (c) 2016-2019 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "md4c-text.h"
+
+
+/***********************************************
+ ***  Plain text rendering helper functions  ***
+ ***********************************************/
+
+/* Returns the largest length not greater than 'size' which does not split
+ * a UTF-8 sequence of 'text'. */
+static MD_SIZE
+utf8_boundary(const MD_CHAR* text, MD_SIZE size)
+{
+    MD_SIZE off = size;
+
+    while(off > 0  &&  (((unsigned char) text[off]) & 0xc0) == 0x80)
+        off--;
+    return off;
+}
+
+/* Returns the size of the UTF-8 sequence 'text' starts with if it is white
+ * space or a line break, the ones NSCharacterSet.whitespaceAndNewlineCharacterSet
+ * contains. Returns 0 otherwise. */
+static MD_SIZE
+utf8_space(const MD_CHAR* text, MD_SIZE size)
+{
+    const unsigned char* s = (const unsigned char*) text;
+    unsigned cp;
+
+    if(size >= 1  &&  (s[0] == ' '  ||  (s[0] >= 0x09  &&  s[0] <= 0x0d)))
+        return 1;
+    if(size >= 2  &&  s[0] == 0xc2  &&  (s[1] == 0x85  ||  s[1] == 0xa0))
+        return 2;
+    if(size < 3  ||  (s[0] & 0xf0) != 0xe0)
+        return 0;
+
+    cp = ((s[0] & 0x0fu) << 12) | ((s[1] & 0x3fu) << 6) | (s[2] & 0x3fu);
+    if(cp == 0x1680  ||  (cp >= 0x2000  &&  cp <= 0x200a)  ||  cp == 0x2028  ||
+       cp == 0x2029  ||  cp == 0x202f  ||  cp == 0x205f  ||  cp == 0x3000)
+        return 3;
+    return 0;
+}
+
+/* Returns how many leading bytes of 'text' fit into 'max_length' UTF-16 code
+ * units, and accumulates the units consumed into 'length'. */
+static MD_SIZE
+utf16_prefix(const MD_CHAR* text, MD_SIZE size, MD_SIZE max_length, MD_SIZE* length)
+{
+    MD_SIZE off = 0;
+    MD_SIZE len = *length;
+
+    while(off < size) {
+        unsigned char ch = (unsigned char) text[off];
+        MD_SIZE n;
+        MD_SIZE units = 1;
+
+        if(ch < 0x80) {
+            n = 1;
+        } else if(ch < 0xe0) {
+            n = 2;
+        } else if(ch < 0xf0) {
+            n = 3;
+        } else {
+            n = 4;
+            units = 2;      /* Surrogate pair. */
+        }
+
+        if(len + units > max_length)
+            break;
+        if(off + n > size)
+            n = size - off;
+        off += n;
+        len += units;
+    }
+
+    *length = len;
+    return off;
+}
+
+static int
+render_text(MD_TEXT* r, const MD_CHAR* text, MD_SIZE size)
+{
+    MD_SIZE available = r->capacity - r->size;
+
+    if(r->flags & MD_TEXT_FLAG_SINGLE_LINE) {
+        const MD_CHAR* newline = memchr(text, '\n', size);
+        if(newline != NULL) {
+            size = (MD_SIZE) (newline - text);
+            r->line_ended = 1;
+        }
+    }
+
+    if(size > available) {
+        size = utf8_boundary(text, available);
+        r->truncated = 1;
+    }
+
+    if(r->max_length > 0) {
+        MD_SIZE fit = utf16_prefix(text, size, r->max_length, &r->length);
+        if(fit < size) {
+            size = fit;
+            r->truncated = 1;
+        }
+    }
+
+    memcpy(r->output + r->size, text, size);
+    r->size += size;
+    return (r->truncated || r->line_ended);
+}
+
+
+/**************************************
+ ***  Plain text renderer callbacks  ***
+ **************************************/
+
+static int
+enter_block_callback(MD_BLOCKTYPE type, void* detail, void* userdata)
+{
+    return 0;
+}
+
+static int
+leave_block_callback(MD_BLOCKTYPE type, void* detail, void* userdata)
+{
+    return 0;
+}
+
+static int
+enter_span_callback(MD_SPANTYPE type, void* detail, void* userdata)
+{
+    return 0;
+}
+
+static int
+leave_span_callback(MD_SPANTYPE type, void* detail, void* userdata)
+{
+    return 0;
+}
+
+static int
+text_callback(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata)
+{
+    MD_TEXT* r = (MD_TEXT*) userdata;
+
+    if(text == NULL)
+        return 0;
+    return render_text(r, text, size);
+}
+
+MD_SIZE
+md_text_capacity(const MD_CHAR* input, MD_SIZE input_size)
+{
+    const MD_CHAR* end = input + input_size;
+    const MD_CHAR* tab;
+    MD_SIZE capacity = input_size + 1;
+
+    while((tab = memchr(input, '\t', (size_t) (end - input))) != NULL) {
+        capacity += 3;
+        input = tab + 1;
+    }
+    return capacity;
+}
+
+void
+md_text_init(MD_TEXT* r, MD_CHAR* output, MD_SIZE output_capacity,
+             MD_SIZE max_length, unsigned renderer_flags)
+{
+    r->output = output;
+    r->capacity = output_capacity;
+    r->size = 0;
+    r->max_length = max_length;
+    r->length = 0;
+    r->flags = renderer_flags;
+    r->truncated = 0;
+    r->line_ended = 0;
+}
+
+void
+md_text_init_parser(MD_PARSER* parser, unsigned parser_flags)
+{
+    parser->abi_version = 0;
+    parser->flags = parser_flags;
+    parser->enter_block = enter_block_callback;
+    parser->leave_block = leave_block_callback;
+    parser->enter_span = enter_span_callback;
+    parser->leave_span = leave_span_callback;
+    parser->text = text_callback;
+    parser->debug_log = NULL;
+    parser->syntax = NULL;
+}
+
+int
+md_text_finish(MD_TEXT* r, MD_SIZE* output_size)
+{
+    /* Trailing white space left by a cut is meaningless in plain text. */
+    if(r->truncated || r->line_ended) {
+        while(r->size > 0) {
+            MD_SIZE last = utf8_boundary(r->output, r->size - 1);
+            if(utf8_space(r->output + last, r->size - last) != r->size - last)
+                break;
+            r->size = last;
+        }
+    }
+
+    *output_size = r->size;
+    return r->truncated;
+}
+
+int
+md_text(const MD_CHAR* input, MD_SIZE input_size,
+        MD_CHAR* output, MD_SIZE output_capacity, MD_SIZE* output_size,
+        MD_SIZE max_length, unsigned parser_flags, unsigned renderer_flags)
+{
+    MD_TEXT render;
+    MD_PARSER parser;
+    int ret;
+
+    md_text_init(&render, output, output_capacity, max_length, renderer_flags);
+    md_text_init_parser(&parser, parser_flags);
+
+    /* Everything beyond the first line is never rendered in single line mode,
+     * do not make md_parse() analyze it. */
+    if(renderer_flags & MD_TEXT_FLAG_SINGLE_LINE) {
+        const MD_CHAR* newline;
+        MD_SIZE n;
+
+        while((n = utf8_space(input, input_size)) > 0) {
+            input += n;
+            input_size -= n;
+        }
+        newline = memchr(input, '\n', input_size);
+        if(newline != NULL)
+            input_size = (MD_SIZE) (newline - input);
+    }
+
+    ret = md_parse(input, input_size, &parser, (void*) &render);
+    if(md_text_finish(&render, output_size))
+        return 1;
+    return (ret < 0) ? -1 : 0;
+}
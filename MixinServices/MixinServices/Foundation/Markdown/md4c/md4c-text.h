@@ -0,0 +1,119 @@
+/*
+ * MD4C: Markdown parser for C
+ * (http://github.com/mity/md4c)
+ *
+ * Copyright (c) 2016-2017 Martin Mitas
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MD4C_TEXT_H
+#define MD4C_TEXT_H
+
+#include "md4c.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* Stop at the first line break of the output. Only the first non-blank line
+ * of the input is parsed in this mode. */
+#define MD_TEXT_FLAG_SINGLE_LINE            0x0001
+
+
+typedef struct MD_TEXT_tag MD_TEXT;
+struct MD_TEXT_tag {
+    MD_CHAR* output;
+    MD_SIZE capacity;
+    MD_SIZE size;
+    MD_SIZE max_length;
+    MD_SIZE length;
+    unsigned flags;
+    int truncated;
+    int line_ended;
+};
+
+
+/* Returns an upper bound of the plain text size of the Markdown input.
+ *
+ * Plain text is mostly shorter than its source, except that indentation of
+ * code blocks is expanded to spaces, which turns a tab into up to 4 bytes,
+ * and each line of a verbatim block gets a line break, which the last line
+ * of the input may be missing.
+ */
+MD_SIZE md_text_capacity(const MD_CHAR* input, MD_SIZE input_size);
+
+/* Render Markdown into plain text.
+ *
+ * Unlike md_html(), the output is not streamed through a callback. It is
+ * written into the caller-provided buffer, so rendering a document performs
+ * no allocation besides the ones md_parse() does internally.
+ *
+ * Params input and input_size specify the Markdown input.
+ * Param output is the buffer receiving UTF-8 text. It is not zero-terminated.
+ * Param output_capacity is the size of the buffer in bytes. A buffer of
+ * md_text_capacity() bytes is always enough for the complete output.
+ * Param output_size receives the number of bytes written.
+ * Param max_length limits the output in UTF-16 code units, which is what
+ * NSString counts as its length. Zero means no limit.
+ * Param parser_flags are flags from md4c.h propagated to md_parse().
+ * Param renderer_flags is bitmask of MD_TEXT_FLAG_xxxx.
+ *
+ * Output exceeding either output_capacity or max_length is cut on a UTF-8
+ * sequence boundary and the parsing is stopped right away, so the cost of
+ * rendering is bound by the size of the output rather than the input. The
+ * cut may split a grapheme cluster such as a ZWJ emoji sequence or a letter
+ * with combining marks, callers displaying the text have to drop the last
+ * cluster of a truncated output.
+ *
+ * Trailing white space of a cut output is dropped, and so is leading white
+ * space of the input in MD_TEXT_FLAG_SINGLE_LINE mode. Both include Unicode
+ * white space, not only ASCII.
+ *
+ * Returns -1 on error (if md_parse() fails.)
+ * Returns 0 on success.
+ * Returns 1 if the output is truncated by output_capacity or max_length.
+ */
+int md_text(const MD_CHAR* input, MD_SIZE input_size,
+            MD_CHAR* output, MD_SIZE output_capacity, MD_SIZE* output_size,
+            MD_SIZE max_length, unsigned parser_flags, unsigned renderer_flags);
+
+/* Lower level interface for driving the plain text renderer from an md_parse()
+ * call of the caller, e.g. one shared with other renderers.
+ *
+ * md_text_init() prepares the renderer state 'r' with the same params as
+ * md_text() does. md_text_init_parser() fills 'parser' with the renderer
+ * callbacks, which expect a pointer to the state as their userdata.
+ * MD_TEXT_FLAG_SINGLE_LINE does not limit the input through this interface.
+ *
+ * After md_parse() returns, md_text_finish() reports the output size and
+ * returns 1 if the output is truncated, 0 otherwise.
+ */
+void md_text_init(MD_TEXT* r, MD_CHAR* output, MD_SIZE output_capacity,
+                  MD_SIZE max_length, unsigned renderer_flags);
+void md_text_init_parser(MD_PARSER* parser, unsigned parser_flags);
+int md_text_finish(MD_TEXT* r, MD_SIZE* output_size);
+
+
+#ifdef __cplusplus
+    }  /* extern "C" { */
+#endif
+
+#endif  /* MD4C_TEXT_H */
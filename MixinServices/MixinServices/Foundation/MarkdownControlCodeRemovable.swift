@@ -13,23 +13,24 @@ extension MarkdownControlCodeRemovable {
         guard isPostContent, let content = contentBeforeRemovingMarkdownControlCode else {
             return contentBeforeRemovingMarkdownControlCode ?? ""
         }
-        let trimmedContent = content.trimmingCharacters(in: .whitespacesAndNewlines)
-        var endIndex = trimmedContent.endIndex
-        var suffix = ""
-        for (index, char) in trimmedContent.enumerated().lazy {
-            let didMeetLineBreak = char == "\n"
-            let didReachMaxLength = index == 60
-            if didMeetLineBreak || didReachMaxLength {
-                endIndex = trimmedContent.index(trimmedContent.startIndex, offsetBy: index)
-                if didReachMaxLength {
-                    suffix = "..."
-                }
-                break
-            }
+        // The renderer counts UTF-16 units and may cut in the middle of a character,
+        // render enough units for the longest characters and cut on characters here
+        let maxNumberOfCharacters = 60
+        var truncated: ObjCBool = false
+        var text = MarkdownConverter.plainText(from: content,
+                                               maxNumberOfCharacters: UInt(maxNumberOfCharacters * 16),
+                                               singleLine: true,
+                                               truncated: &truncated)
+        if truncated.boolValue, !text.isEmpty {
+            text.removeLast()
+        }
+        if text.count > maxNumberOfCharacters {
+            return String(text.prefix(maxNumberOfCharacters)) + "..."
+        } else if truncated.boolValue {
+            return text + "..."
+        } else {
+            return text
         }
-        let fragment = String(trimmedContent[content.startIndex..<endIndex])
-        let text = MarkdownConverter.plainText(from: fragment)
-        return text + suffix
     }
     
 }
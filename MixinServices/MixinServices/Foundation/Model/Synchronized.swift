@@ -25,4 +25,18 @@ public class Synchronized<Value> {
         }
     }
     
+    public var projectedValue: Synchronized<Value> {
+        self
+    }
+    
+    // Sets a new value and returns the old one in a single step, e.g. to
+    // test and set a flag
+    public func exchange(_ newValue: Value) -> Value {
+        lock.lock()
+        let val = _value
+        _value = newValue
+        lock.unlock()
+        return val
+    }
+    
 }
@@ -1,16 +1,13 @@
 import Foundation
-import GRDB
 
 class MixinIdentityKeyStore: IdentityKeyStore {
     
-    private let lock = NSLock()
-    
     func identityKeyPair() -> KeyPair? {
-        return IdentityDAO.shared.getLocalIdentity()?.getIdentityKeyPair()
+        return SignalStoreCache.shared.localIdentity()?.getIdentityKeyPair()
     }
     
     func localRegistrationId() -> UInt32? {
-        guard let registrationId = IdentityDAO.shared.getLocalIdentity()?.registrationId else {
+        guard let registrationId = SignalStoreCache.shared.localIdentity()?.registrationId else {
             return nil
         }
         return UInt32(registrationId)
@@ -21,24 +18,15 @@ class MixinIdentityKeyStore: IdentityKeyStore {
     }
     
     func save(identity: Data?, for address: SignalAddress) -> Bool {
-        objc_sync_enter(lock)
-        defer {
-            objc_sync_exit(lock)
-        }
         guard let identityKey = identity else {
             reporter.report(error: MixinServicesError.saveIdentity)
             return false
         }
-        IdentityDAO.shared.save(publicKey: identityKey, for: address.name)
-        return true
+        return SignalStoreCache.shared.save(identity: identityKey, for: address.name)
     }
     
     func removeIdentity(address: SignalAddress) {
-        objc_sync_enter(lock)
-        defer {
-            objc_sync_exit(lock)
-        }
-        IdentityDAO.shared.deleteIdentity(address: address.name)
+        SignalStoreCache.shared.removeIdentity(for: address.name)
     }
     
 }
@@ -0,0 +1,606 @@
+import Foundation
+import UIKit
+import GRDB
+
+// libsignal loads and stores a session, identity and maybe a pre-key several
+// times for every message. This keeps recently used records in memory, and
+// stores only mark them pending until `commit()` writes all of them in one
+// transaction. SignalProtocol runs every encryption and decryption in
+// `perform(_:)`, which commits before it returns and throws when the records
+// couldn't be written, so no ratchet state the server has seen is ever lost.
+//
+// The notification service extension writes the same database from another
+// process, and posts a Darwin notification when it did. Only then, or when the
+// app returns to the foreground, `refresh()` compares SQLite's data_version on
+// the writer connection and drops everything cached if it has changed.
+final class SignalStoreCache {
+
+    static let shared = SignalStoreCache()
+
+    // Set to false to go to the database on every call, e.g. to compare
+    @Synchronized(value: true)
+    var isEnabled: Bool
+
+    private let lock = NSLock()
+
+    // Serializes everything that writes to the database, so a commit can't
+    // interleave with a write-through and a caller of commit() doesn't return
+    // while another thread is still writing its records
+    private let commitLock = NSLock()
+
+    private weak var database: SignalDatabase?
+    private var dataVersion: Int?
+    private var needsRefresh = true
+
+    // Bumped when a commit failed and the records it held were dropped
+    private var failedCommitCount: UInt64 = 0
+
+    // Bumped when records are removed behind the cache, a load that raced
+    // with that doesn't fill the cache
+    private var generation: UInt64 = 0
+    private var version: UInt64 = 0
+
+    private var sessions = LRUCache<SessionAddress, Data?>(capacity: 512)
+    private var pendingSessions = [SessionAddress: PendingRecord]()
+    private var identities = LRUCache<String, Data>(capacity: 512)
+    private var pendingIdentities = [String: PendingRecord]()
+    private var cachedLocalIdentity: Identity?
+    private var preKeys = LRUCache<UInt32, Data?>(capacity: 64)
+    private var pendingPreKeyRemovals = Set<UInt32>()
+
+    private init() {
+        // Darwin notifications are not delivered while the app is suspended
+        NotificationCenter.default.addObserver(self,
+                                               selector: #selector(setNeedsRefresh),
+                                               name: UIApplication.willEnterForegroundNotification,
+                                               object: nil)
+    }
+
+    deinit {
+        NotificationCenter.default.removeObserver(self)
+    }
+
+    // Runs body between refresh() and commit(). Throws signalStoreCommitFailed
+    // if the records couldn't be written, also when body threw, as the
+    // records body stored are dropped with the commit. Whatever body worked
+    // on has to be done again, e.g. a message is decrypted again later.
+    func perform<Result>(_ body: () throws -> Result) throws -> Result {
+        refresh()
+        lock.lock()
+        let failedCommitCount = self.failedCommitCount
+        lock.unlock()
+        let result: Result
+        do {
+            result = try body()
+        } catch {
+            guard commit(failedCommitCount: failedCommitCount) else {
+                throw MixinServicesError.signalStoreCommitFailed
+            }
+            throw error
+        }
+        guard commit(failedCommitCount: failedCommitCount) else {
+            throw MixinServicesError.signalStoreCommitFailed
+        }
+        return result
+    }
+
+    // Drops cached records if another process has written the database
+    // since setNeedsRefresh() was called
+    func refresh() {
+        guard isEnabled else {
+            return
+        }
+        lock.lock()
+        validateDatabase()
+        let database = self.database
+        let needsRefresh = self.needsRefresh
+        self.needsRefresh = false
+        lock.unlock()
+        guard needsRefresh, let database = database else {
+            return
+        }
+        let dataVersion = try? database.pool.writeWithoutTransaction { (db) in
+            try Int.fetchOne(db, sql: "PRAGMA data_version")
+        }
+        lock.lock()
+        defer {
+            lock.unlock()
+        }
+        guard let current = dataVersion, self.database === database else {
+            self.needsRefresh = true
+            return
+        }
+        if let known = self.dataVersion, known != current {
+            Logger.general.info(category: "SignalStoreCache", message: "Signal database changed by another process")
+            removeCachedRecords()
+        }
+        self.dataVersion = current
+    }
+
+    @objc func setNeedsRefresh() {
+        lock.lock()
+        needsRefresh = true
+        lock.unlock()
+    }
+
+    // Writes pending records in one transaction. Returns after they are
+    // written, also if another thread took them into its own commit.
+    @discardableResult
+    func commit() -> Bool {
+        commit(failedCommitCount: nil)
+    }
+
+    // Fails without writing if a commit failed since failedCommitCount was
+    // read, the records of the caller may have been dropped with it
+    private func commit(failedCommitCount: UInt64?) -> Bool {
+        guard isEnabled else {
+            return true
+        }
+        commitLock.lock()
+        defer {
+            commitLock.unlock()
+        }
+        lock.lock()
+        validateDatabase()
+        if let count = failedCommitCount, count != self.failedCommitCount {
+            lock.unlock()
+            return false
+        }
+        let database = self.database
+        let sessions = pendingSessions
+        let identities = pendingIdentities
+        let preKeyRemovals = pendingPreKeyRemovals
+        lock.unlock()
+        guard let signalDatabase = database, !(sessions.isEmpty && identities.isEmpty && preKeyRemovals.isEmpty) else {
+            return true
+        }
+
+        let timestamp = Date().timeIntervalSince1970
+        let success = signalDatabase.write { (db) in
+            for (address, pending) in sessions {
+                let condition = Session.column(of: .address) == address.name && Session.column(of: .device) == address.device
+                let assignments = [
+                    Session.column(of: .record).set(to: pending.record),
+                    Session.column(of: .timestamp).set(to: timestamp)
+                ]
+                if try Session.filter(condition).updateAll(db, assignments) == 0 {
+                    try Session(address: address.name, device: address.device, record: pending.record, timestamp: timestamp).insert(db)
+                }
+            }
+            for (address, pending) in identities {
+                let condition = Identity.column(of: .address) == address
+                let assignments = [
+                    Identity.column(of: .publicKey).set(to: pending.record),
+                    Identity.column(of: .timestamp).set(to: timestamp)
+                ]
+                if try Identity.filter(condition).updateAll(db, assignments) == 0 {
+                    let identity = Identity(address: address,
+                                            registrationId: nil,
+                                            publicKey: pending.record,
+                                            privateKey: nil,
+                                            nextPreKeyId: nil,
+                                            timestamp: timestamp)
+                    try identity.insert(db)
+                }
+            }
+            for id in preKeyRemovals {
+                try PreKey.filter(PreKey.column(of: .preKeyId) == Int(id)).deleteAll(db)
+            }
+        }
+        guard success else {
+            // The records derive from each other, none of them are kept. What
+            // is loaded next comes from the database, which is as it was
+            // before the records of the failed callers were stored.
+            lock.lock()
+            if self.database === signalDatabase {
+                pendingSessions = [:]
+                pendingIdentities = [:]
+                pendingPreKeyRemovals = []
+                removeCachedRecords()
+                self.failedCommitCount += 1
+            }
+            lock.unlock()
+            return false
+        }
+        postDatabaseDidChange()
+
+        lock.lock()
+        if self.database === signalDatabase {
+            for (address, pending) in sessions where pendingSessions[address]?.version == pending.version {
+                pendingSessions[address] = nil
+            }
+            for (address, pending) in identities where pendingIdentities[address]?.version == pending.version {
+                pendingIdentities[address] = nil
+            }
+            pendingPreKeyRemovals.subtract(preKeyRemovals)
+        }
+        lock.unlock()
+        return true
+    }
+
+    // Forgets everything including pending records, for logging out
+    func removeAll() {
+        commitLock.lock()
+        lock.lock()
+        pendingSessions = [:]
+        pendingIdentities = [:]
+        pendingPreKeyRemovals = []
+        removeCachedRecords()
+        dataVersion = nil
+        needsRefresh = true
+        lock.unlock()
+        commitLock.unlock()
+    }
+
+}
+
+// MARK: - Sessions
+extension SignalStoreCache {
+
+    func session(for address: SignalAddress) -> Data? {
+        guard isEnabled else {
+            return SessionDAO.shared.getSession(address: address.name, device: address.deviceId)?.record
+        }
+        let key = SessionAddress(name: address.name, device: address.deviceId)
+        lock.lock()
+        validateDatabase()
+        if let record = sessions.value(forKey: key) {
+            lock.unlock()
+            return record
+        }
+        let generation = self.generation
+        lock.unlock()
+
+        let record = SessionDAO.shared.getSession(address: key.name, device: key.device)?.record
+        lock.lock()
+        if generation == self.generation && !sessions.contains(key) {
+            sessions.setValue(record, forKey: key, isPinned: isPendingSession)
+        }
+        lock.unlock()
+        return record
+    }
+
+    func store(session record: Data, for address: SignalAddress) {
+        guard isEnabled else {
+            storeSessionToDatabase(record, for: address)
+            return
+        }
+        let key = SessionAddress(name: address.name, device: address.deviceId)
+        lock.lock()
+        validateDatabase()
+        if let cached = sessions.value(forKey: key), cached == record {
+            lock.unlock()
+            return
+        }
+        version += 1
+        pendingSessions[key] = PendingRecord(record: record, version: version)
+        sessions.setValue(record, forKey: key, isPinned: isPendingSession)
+        lock.unlock()
+    }
+
+    // Includes sessions that are pending
+    func subDeviceSessions(for name: String) -> [Int32] {
+        commit()
+        return SessionDAO.shared.getSubDevices(address: name)
+    }
+
+    func deleteSession(for address: SignalAddress) -> Bool {
+        guard isEnabled else {
+            return SessionDAO.shared.delete(address: address.name, device: address.deviceId)
+        }
+        let key = SessionAddress(name: address.name, device: address.deviceId)
+        commitLock.lock()
+        defer {
+            commitLock.unlock()
+        }
+        lock.lock()
+        validateDatabase()
+        generation += 1
+        pendingSessions[key] = nil
+        sessions.removeValue(forKey: key)
+        lock.unlock()
+        defer {
+            postDatabaseDidChange()
+        }
+        return SessionDAO.shared.delete(address: address.name, device: address.deviceId)
+    }
+
+    func deleteAllSessions(for name: String) -> Int {
+        guard isEnabled else {
+            return SessionDAO.shared.delete(address: name)
+        }
+        commitLock.lock()
+        defer {
+            commitLock.unlock()
+        }
+        lock.lock()
+        validateDatabase()
+        generation += 1
+        pendingSessions = pendingSessions.filter { $0.key.name != name }
+        sessions.removeAll { $0.name == name }
+        lock.unlock()
+        defer {
+            postDatabaseDidChange()
+        }
+        return SessionDAO.shared.delete(address: name)
+    }
+
+    // Includes sessions that are pending
+    func containsSessions(for name: String) -> Bool {
+        commit()
+        return SessionDAO.shared.getSessions(address: name).count > 0
+    }
+
+    private func storeSessionToDatabase(_ record: Data, for address: SignalAddress) {
+        let oldSession = SessionDAO.shared.getSession(address: address.name, device: address.deviceId)
+        if oldSession == nil {
+            let newSession = Session(address: address.name,
+                                     device: address.deviceId,
+                                     record: record,
+                                     timestamp: Date().timeIntervalSince1970)
+            SignalDatabase.current.save(newSession)
+        } else if oldSession!.record != record {
+            let assignments = [
+                Session.column(of: .record).set(to: record),
+                Session.column(of: .timestamp).set(to: Date().timeIntervalSince1970)
+            ]
+            SessionDAO.shared.updateSession(with: address.name,
+                                            device: address.deviceId,
+                                            assignments: assignments)
+        }
+    }
+
+    private func isPendingSession(_ key: SessionAddress) -> Bool {
+        pendingSessions[key] != nil
+    }
+
+}
+
+// MARK: - Identities
+extension SignalStoreCache {
+
+    func localIdentity() -> Identity? {
+        guard isEnabled else {
+            return IdentityDAO.shared.getLocalIdentity()
+        }
+        lock.lock()
+        validateDatabase()
+        if let identity = cachedLocalIdentity {
+            lock.unlock()
+            return identity
+        }
+        let generation = self.generation
+        lock.unlock()
+
+        // Not cached when missing, it is saved right after logging in
+        let identity = IdentityDAO.shared.getLocalIdentity()
+        lock.lock()
+        if generation == self.generation {
+            cachedLocalIdentity = identity
+        }
+        lock.unlock()
+        return identity
+    }
+
+    func save(identity publicKey: Data, for address: String) -> Bool {
+        guard isEnabled else {
+            _ = IdentityDAO.shared.save(publicKey: publicKey, for: address)
+            return true
+        }
+        lock.lock()
+        validateDatabase()
+        if let cached = identities.value(forKey: address), cached == publicKey {
+            lock.unlock()
+            return true
+        }
+        version += 1
+        pendingIdentities[address] = PendingRecord(record: publicKey, version: version)
+        identities.setValue(publicKey, forKey: address) { self.pendingIdentities[$0] != nil }
+        lock.unlock()
+        return true
+    }
+
+    func removeIdentity(for address: String) {
+        guard isEnabled else {
+            IdentityDAO.shared.deleteIdentity(address: address)
+            return
+        }
+        commitLock.lock()
+        defer {
+            commitLock.unlock()
+        }
+        lock.lock()
+        validateDatabase()
+        generation += 1
+        pendingIdentities[address] = nil
+        identities.removeValue(forKey: address)
+        lock.unlock()
+        IdentityDAO.shared.deleteIdentity(address: address)
+        postDatabaseDidChange()
+    }
+
+}
+
+// MARK: - Pre-keys
+extension SignalStoreCache {
+
+    func preKey(with id: UInt32) -> Data? {
+        guard isEnabled else {
+            return PreKeyDAO.shared.getPreKey(with: Int(id))?.record
+        }
+        lock.lock()
+        validateDatabase()
+        if pendingPreKeyRemovals.contains(id) {
+            lock.unlock()
+            return nil
+        }
+        if let record = preKeys.value(forKey: id) {
+            lock.unlock()
+            return record
+        }
+        let generation = self.generation
+        lock.unlock()
+
+        let record = PreKeyDAO.shared.getPreKey(with: Int(id))?.record
+        lock.lock()
+        if generation == self.generation && !preKeys.contains(id) {
+            preKeys.setValue(record, forKey: id) { _ in false }
+        }
+        lock.unlock()
+        return record
+    }
+
+    // Deleted with the session built from the pre-key in the next commit
+    func removePreKey(with id: UInt32) -> Bool {
+        guard isEnabled else {
+            return PreKeyDAO.shared.deletePreKey(with: Int(id))
+        }
+        lock.lock()
+        validateDatabase()
+        pendingPreKeyRemovals.insert(id)
+        preKeys.setValue(nil, forKey: id) { _ in false }
+        lock.unlock()
+        return true
+    }
+
+    // Pre-key IDs wrap around, so new ones replace whatever is cached
+    func store(preKeys newPreKeys: [PreKey]) -> Bool {
+        guard isEnabled else {
+            return PreKeyDAO.shared.savePreKeys(newPreKeys)
+        }
+        commitLock.lock()
+        defer {
+            commitLock.unlock()
+        }
+        lock.lock()
+        validateDatabase()
+        generation += 1
+        for preKey in newPreKeys {
+            let id = UInt32(preKey.preKeyId)
+            pendingPreKeyRemovals.remove(id)
+            preKeys.removeValue(forKey: id)
+        }
+        lock.unlock()
+        defer {
+            postDatabaseDidChange()
+        }
+        return PreKeyDAO.shared.savePreKeys(newPreKeys)
+    }
+
+}
+
+// MARK: - Private works
+extension SignalStoreCache {
+
+    fileprivate struct SessionAddress: Hashable {
+        let name: String
+        let device: Int32
+    }
+
+    fileprivate struct PendingRecord {
+        let record: Data
+        let version: UInt64
+    }
+
+    // Must be called with lock held. Records of a database that was closed
+    // or erased are thrown away with it.
+    private func validateDatabase() {
+        let current: SignalDatabase? = SignalDatabase.current
+        guard database !== current else {
+            return
+        }
+        database = current
+        dataVersion = nil
+        needsRefresh = true
+        pendingSessions = [:]
+        pendingIdentities = [:]
+        pendingPreKeyRemovals = []
+        removeCachedRecords()
+    }
+
+    // The other process refreshes before it uses its records again
+    private func postDatabaseDidChange() {
+        let name = isAppExtension ? signalDatabaseDidChangeInAppExtensionDarwinNotificationName : signalDatabaseDidChangeInMainAppDarwinNotificationName
+        CFNotificationCenterPostNotification(CFNotificationCenterGetDarwinNotifyCenter(), name, nil, nil, true)
+    }
+
+    // Must be called with lock held. Pending records stay cached.
+    private func removeCachedRecords() {
+        generation += 1
+        sessions.removeAll()
+        for (address, pending) in pendingSessions {
+            sessions.setValue(pending.record, forKey: address) { _ in true }
+        }
+        identities.removeAll()
+        for (address, pending) in pendingIdentities {
+            identities.setValue(pending.record, forKey: address) { _ in true }
+        }
+        cachedLocalIdentity = nil
+        preKeys.removeAll()
+    }
+
+}
+
+// A dictionary that drops the least recently used values beyond capacity,
+// except the pinned ones which are yet to be written
+fileprivate struct LRUCache<Key: Hashable, Value> {
+
+    private struct Entry {
+        var value: Value
+        var lastAccess: UInt64
+    }
+
+    private let capacity: Int
+    private var entries = [Key: Entry]()
+    private var clock: UInt64 = 0
+
+    init(capacity: Int) {
+        self.capacity = capacity
+    }
+
+    func contains(_ key: Key) -> Bool {
+        entries[key] != nil
+    }
+
+    mutating func value(forKey key: Key) -> Value? {
+        guard entries[key] != nil else {
+            return nil
+        }
+        clock += 1
+        entries[key]!.lastAccess = clock
+        return entries[key]!.value
+    }
+
+    mutating func setValue(_ value: Value, forKey key: Key, isPinned: (Key) -> Bool) {
+        clock += 1
+        entries[key] = Entry(value: value, lastAccess: clock)
+        if entries.count > capacity {
+            evict(isPinned: isPinned)
+        }
+    }
+
+    mutating func removeValue(forKey key: Key) {
+        entries[key] = nil
+    }
+
+    mutating func removeAll(where shouldBeRemoved: (Key) -> Bool) {
+        entries = entries.filter { !shouldBeRemoved($0.key) }
+    }
+
+    mutating func removeAll() {
+        entries.removeAll(keepingCapacity: true)
+    }
+
+    // Drops an eighth at once so that eviction is amortized over many inserts
+    private mutating func evict(isPinned: (Key) -> Bool) {
+        let count = entries.count - capacity * 7 / 8
+        let victims = entries
+            .filter { !isPinned($0.key) }
+            .sorted { $0.value.lastAccess < $1.value.lastAccess }
+            .prefix(count)
+        for victim in victims {
+            entries[victim.key] = nil
+        }
+    }
+
+}
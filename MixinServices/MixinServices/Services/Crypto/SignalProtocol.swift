@@ -56,19 +56,26 @@ public class SignalProtocol {
     }
 
     func containsUserSession(recipientId: String) -> Bool {
-        return SessionDAO.shared.getSessions(address: recipientId).count > 0
+        return SignalStoreCache.shared.containsSessions(for: recipientId)
     }
 
     func containsSession(recipient: String, deviceId: Int32 = SignalProtocol.shared.DEFAULT_DEVICE_ID) -> Bool {
         let address = SignalAddress(name: recipient, deviceId: deviceId)
+        SignalStoreCache.shared.refresh()
         return store.sessionStore.containsSession(for: address)
     }
 
     func deleteSession(userId: String) {
-        SessionDAO.shared.delete(address: userId)
+        _ = store.sessionStore.deleteAllSessions(for: userId)
     }
 
     func processSession(userId: String, key: SignalKey) throws {
+        try SignalStoreCache.shared.perform {
+            try buildSession(userId: userId, key: key)
+        }
+    }
+
+    private func buildSession(userId: String, key: SignalKey) throws {
         let address = SignalAddress(name: userId, deviceId: key.deviceId)
         let sessionBuilder = SessionBuilder(for: address, in: store)
         let preKeyBundle = SessionPreKeyBundle(registrationId: key.registrationId,
@@ -82,7 +89,7 @@ public class SignalProtocol {
         do {
             try sessionBuilder.process(preKeyBundle: preKeyBundle)
         } catch SignalError.untrustedIdentity {
-            IdentityDAO.shared.deleteIdentity(address: address.name)
+            SignalStoreCache.shared.removeIdentity(for: address.name)
             try sessionBuilder.process(preKeyBundle: preKeyBundle)
         } catch {
             throw error
@@ -101,25 +108,96 @@ public class SignalProtocol {
     }
 
     func encryptSenderKey(conversationId: String, recipientId: String, sessionId: String?) throws -> (String, Bool) {
-        let deviceId = SignalProtocol.convertSessionIdToDeviceId(sessionId)
+        try SignalStoreCache.shared.perform { () -> (String, Bool) in
+            let deviceId = SignalProtocol.convertSessionIdToDeviceId(sessionId)
+            let senderKeyDistributionMessage = try getSenderKeyDistribution(groupId: conversationId, senderId: myUserId)
+            do {
+                let cipherMessage = try encryptSession(content: senderKeyDistributionMessage.message, destination: recipientId, deviceId: deviceId)
+                let compose = ComposeMessageData(keyType: cipherMessage.type.rawValue, cipher: cipherMessage.message, resendMessageId: nil)
+                return (encodeMessageData(data: compose), false)
+            } catch {
+                if let err = error as? SignalError, err == SignalError.untrustedIdentity {
+                    let remoteAddress = SignalAddress(name: recipientId, deviceId: deviceId)
+                    SignalStoreCache.shared.removeIdentity(for: remoteAddress.name)
+                    _ = store.sessionStore.deleteSession(for: remoteAddress)
+                    return ("", true)
+                }
+                throw error
+            }
+        }
+    }
+
+    // Sender key distribution for many recipient sessions at once. The
+    // distribution message is built once and the sessions are encrypted in
+    // parallel, which only serialize on their own address lock. Sessions
+    // with a signal key are built from it first. A nil result means the
+    // recipient needs a fresh session before the sender key can be sent.
+    // After an error no more sessions are started, so few ratchets move on
+    // for messages that are never sent.
+    func encryptSenderKey(conversationId: String, recipients: [BlazeMessageParamSession], signalKeys: [SignalKey]? = nil) throws -> [String?] {
+        guard !recipients.isEmpty else {
+            return []
+        }
+        return try SignalStoreCache.shared.perform {
+            try encryptSenderKeyConcurrently(conversationId: conversationId, recipients: recipients, signalKeys: signalKeys)
+        }
+    }
+
+    private func encryptSenderKeyConcurrently(conversationId: String, recipients: [BlazeMessageParamSession], signalKeys: [SignalKey]?) throws -> [String?] {
         let senderKeyDistributionMessage = try getSenderKeyDistribution(groupId: conversationId, senderId: myUserId)
-        do {
-            let cipherMessage = try encryptSession(content: senderKeyDistributionMessage.message, destination: recipientId, deviceId: deviceId)
-            let compose = ComposeMessageData(keyType: cipherMessage.type.rawValue, cipher: cipherMessage.message, resendMessageId: nil)
-            return (encodeMessageData(data: compose), false)
-        } catch {
-            if let err = error as? SignalError, err == SignalError.untrustedIdentity {
-                let remoteAddress = SignalAddress(name: recipientId, deviceId: deviceId)
-                IdentityDAO.shared.deleteIdentity(address: remoteAddress.name)
+        let lock = NSLock()
+        var cipherTexts = [String?](repeating: nil, count: recipients.count)
+        var firstError: Error?
+        func hasFailed() -> Bool {
+            lock.lock()
+            defer {
+                lock.unlock()
+            }
+            return firstError != nil
+        }
+        DispatchQueue.concurrentPerform(iterations: recipients.count) { index in
+            guard !hasFailed() else {
+                return
+            }
+            let recipient = recipients[index]
+            let deviceId = SignalProtocol.convertSessionIdToDeviceId(recipient.sessionId)
+            do {
+                if let key = signalKeys?[index] {
+                    try buildSession(userId: recipient.userId, key: key)
+                } else if !store.sessionStore.containsSession(for: SignalAddress(name: recipient.userId, deviceId: deviceId)) {
+                    return
+                }
+                guard !hasFailed() else {
+                    return
+                }
+                let cipherMessage = try encryptSession(content: senderKeyDistributionMessage.message, destination: recipient.userId, deviceId: deviceId)
+                let compose = ComposeMessageData(keyType: cipherMessage.type.rawValue, cipher: cipherMessage.message, resendMessageId: nil)
+                let cipherText = encodeMessageData(data: compose)
+                lock.lock()
+                cipherTexts[index] = cipherText
+                lock.unlock()
+            } catch SignalError.untrustedIdentity {
+                let remoteAddress = SignalAddress(name: recipient.userId, deviceId: deviceId)
+                SignalStoreCache.shared.removeIdentity(for: remoteAddress.name)
                 _ = store.sessionStore.deleteSession(for: remoteAddress)
-                return ("", true)
+            } catch {
+                lock.lock()
+                if firstError == nil {
+                    firstError = error
+                }
+                lock.unlock()
             }
+        }
+        if let error = firstError {
             throw error
         }
+        return cipherTexts
     }
 
     func encryptSessionMessageData(recipientId: String, content: String, resendMessageId: String? = nil, sessionId: String? = nil) throws -> String {
-        let cipher = try encryptSession(content: content.data(using: .utf8)!, destination: recipientId, deviceId: SignalProtocol.convertSessionIdToDeviceId(sessionId))
+        let cipher = try SignalStoreCache.shared.perform {
+            try encryptSession(content: content.data(using: .utf8)!, destination: recipientId, deviceId: SignalProtocol.convertSessionIdToDeviceId(sessionId))
+        }
         let data = encodeMessageData(data: ComposeMessageData(keyType: cipher.type.rawValue, cipher: cipher.message, resendMessageId: resendMessageId))
         return data
     }
@@ -147,32 +225,34 @@ public class SignalProtocol {
         return data
     }
 
+    // The callback runs once the records the decryption stored are written.
+    // If they can't be, this throws signalStoreCommitFailed instead and the
+    // message has to be decrypted again later.
     func decrypt(groupId: String, senderId: String, keyType: UInt8, cipherText: Data, category: String, sessionId: String?, callback: @escaping DecryptionCallback) throws {
         let sourceAddress = SignalAddress(name: senderId, deviceId: SignalProtocol.convertSessionIdToDeviceId(sessionId))
-        let sessionCipher = SessionCipher(for: sourceAddress, in: store)
-        if category == MessageCategory.SIGNAL_KEY.rawValue {
-            if keyType == CiphertextMessage.MessageType.preKey.rawValue {
-                _ = try sessionCipher.decrypt(message: CiphertextMessage(type: .preKey, message: cipherText), callback: { (plain) in
-                    SignalProtocol.shared.processGroupSession(groupId: groupId, sender: sourceAddress, data: plain)
-                    callback(plain)
-                })
-
-            } else if keyType == CiphertextMessage.MessageType.signal.rawValue {
-                _ = try sessionCipher.decrypt(message: CiphertextMessage(type: .signal, message: cipherText), callback: { (plain) in
-                    SignalProtocol.shared.processGroupSession(groupId: groupId, sender: sourceAddress, data: plain)
-                    callback(plain)
-                })
-            }
-        } else {
+        let plain = try SignalStoreCache.shared.perform { () -> Data? in
+            let sessionCipher = SessionCipher(for: sourceAddress, in: store)
+            let plain: Data
             if keyType == CiphertextMessage.MessageType.preKey.rawValue {
-                _ = try sessionCipher.decrypt(message: CiphertextMessage(type: .preKey, message: cipherText), callback: callback)
+                plain = try sessionCipher.decrypt(message: CiphertextMessage(type: .preKey, message: cipherText))
             } else if keyType == CiphertextMessage.MessageType.signal.rawValue {
-                _ = try sessionCipher.decrypt(message: CiphertextMessage(type: .signal, message: cipherText), callback: callback)
-            } else if keyType == CiphertextMessage.MessageType.senderKey.rawValue {
+                plain = try sessionCipher.decrypt(message: CiphertextMessage(type: .signal, message: cipherText))
+            } else if keyType == CiphertextMessage.MessageType.senderKey.rawValue && category != MessageCategory.SIGNAL_KEY.rawValue {
                 let senderKeyName = SignalSenderKeyName(groupId: groupId, sender: sourceAddress)
                 let groupCipher = GroupCipher(for: senderKeyName, in: store)
-                _ = try groupCipher.decrypt(CiphertextMessage(type: .senderKey, message: cipherText), callback: callback)
+                plain = try groupCipher.decrypt(CiphertextMessage(type: .senderKey, message: cipherText))
+            } else {
+                return nil
+            }
+            if category == MessageCategory.SIGNAL_KEY.rawValue {
+                // The sender key is processed once the session call returns, libsignal
+                // holds the lock of the 1:1 session while decrypting, not of the sender key
+                SignalProtocol.shared.processGroupSession(groupId: groupId, sender: sourceAddress, data: plain)
             }
+            return plain
+        }
+        if let plain = plain {
+            callback(plain)
         }
     }
 
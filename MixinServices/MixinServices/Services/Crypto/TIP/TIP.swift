@@ -218,6 +218,9 @@ extension TIP {
         let ephemeralSeed = try await ephemeralSeed(pinToken: pinToken)
         Logger.tip.info(category: "TIP", message: "Ephemeral seed ready")
         
+        // Shared by the Argon2 hashes below, released with the flow
+        let arena = Argon2.Arena(memoryCost: Argon2.Arena.defaultMemoryCost, lanes: 2)
+        
         // 1. Change PIN, requires assignee
         // 2. Change PIN interrupted, failure in some of the nodes, requires assignee
         // 3. Change PIN interrupted, all node succeed, does not requires assignee
@@ -225,14 +228,14 @@ extension TIP {
         let watcher: Data
         let assigneePriv: Data?
         if !isCounterBalanced && failedSigners.isEmpty {
-            (identityPriv, watcher) = try await TIPIdentityManager.identityPair(pinData: newPINData, pinToken: pinToken)
+            (identityPriv, watcher) = try await TIPIdentityManager.identityPair(pinData: newPINData, pinToken: pinToken, arena: arena)
             Logger.tip.info(category: "TIP", message: "Identity pair ready")
             assigneePriv = nil
             Logger.tip.info(category: "TIP", message: "No assigneePriv needed")
         } else {
-            (identityPriv, watcher) = try await TIPIdentityManager.identityPair(pinData: oldPINData, pinToken: pinToken)
+            (identityPriv, watcher) = try await TIPIdentityManager.identityPair(pinData: oldPINData, pinToken: pinToken, arena: arena)
             Logger.tip.info(category: "TIP", message: "Identity pair ready")
-            assigneePriv = try await TIPIdentityManager.identityPair(pinData: newPINData, pinToken: pinToken).priv
+            assigneePriv = try await TIPIdentityManager.identityPair(pinData: newPINData, pinToken: pinToken, arena: arena).priv
             Logger.tip.info(category: "TIP", message: "assigneePriv ready")
         }
         
@@ -263,9 +266,10 @@ extension TIP {
         let pinTokenEncryptedSalt: (old: String, new: String)?
         let encryptedSaltToSave: Data?
         if accountBeforeUpdate.hasSafe {
-            let newSaltKey = try saltAESKey(pin: newPINData, tipPriv: tipPriv)
+            let newSaltKey: Data
             if accountBeforeUpdate.isAnonymous {
                 Logger.tip.info(category: "TIP", message: "Update for anonymous user")
+                newSaltKey = try await saltAESKey(pin: newPINData, tipPriv: tipPriv, arena: arena)
                 guard let accountSalt = accountBeforeUpdate.salt else {
                     throw Error.missingAccountSalt
                 }
@@ -279,7 +283,8 @@ extension TIP {
             } else {
                 Logger.tip.info(category: "TIP", message: "Update for phone user")
                 let oldEncryptedSalt = try await custodialEncryptedSalt()
-                let oldSaltKey = try saltAESKey(pin: oldPINData, tipPriv: tipPriv)
+                let oldSaltKey: Data
+                (oldSaltKey, newSaltKey) = try await saltAESKeys(oldPIN: oldPINData, newPIN: newPINData, tipPriv: tipPriv, arena: arena)
                 let salt = try AESCryptor.decrypt(oldEncryptedSalt, with: oldSaltKey)
                 let newEncryptedSalt = try AESCryptor.encrypt(salt, with: newSaltKey)
 #if DEBUG
@@ -467,7 +472,7 @@ extension TIP {
             } else {
                 mnemonics.entropy
             }
-            let saltAESKey = try saltAESKey(pin: pinData, tipPriv: tipPriv)
+            let (saltAESKey, spendSeed) = try await saltAESKeyAndSpendPriv(pin: pinData, salt: mnemonics.entropy, tipPriv: tipPriv)
             step1 += ", salt: \(salt.count), saltAESKey: \(saltAESKey.count)"
             
             let encryptedSalt = try AESCryptor.encrypt(salt, with: saltAESKey)
@@ -476,7 +481,6 @@ extension TIP {
             let pinTokenEncryptedSalt = try AESCryptor.encrypt(encryptedSalt, with: pinToken)
             step1 += ", ptEncryptedSalt: \(pinTokenEncryptedSalt.count)"
             
-            let spendSeed = try spendPriv(salt: mnemonics.entropy, tipPriv: tipPriv)
             step1 += ", spendSeed: \(spendSeed.count)"
             
             let keyPair = try Curve25519.Signing.PrivateKey(rawRepresentation: spendSeed)
@@ -524,7 +528,9 @@ extension TIP {
         }
         let tipPriv = try await getOrRecoverTIPPriv(pin: pin)
         let salt = try await salt(pinData: pinData, tipPriv: tipPriv)
-        return try Argon2i.hash(password: tipPriv, salt: salt)
+        return try await Argon2.Cancellation.withCurrentTask { cancellation in
+            try Argon2.hash(.i, password: tipPriv, salt: salt, cancellation: cancellation)
+        }
     }
     
     public static func salt(pin: String) async throws -> Data {
@@ -541,7 +547,7 @@ extension TIP {
         }
         if let salt = AppGroupKeychain.mnemonics {
             let tipPriv = try await TIP.getOrRecoverTIPPriv(pin: pin)
-            let key = try saltAESKey(pin: pinData, tipPriv: tipPriv)
+            let key = try await saltAESKey(pin: pinData, tipPriv: tipPriv)
             return try AESCryptor.encrypt(salt, with: key)
         } else if let account = LoginManager.shared.account {
             if account.isAnonymous {
@@ -586,7 +592,7 @@ extension TIP {
         }
         let encryptedSalt = try await custodialEncryptedSalt()
         let tipPriv = try await TIP.getOrRecoverTIPPriv(pin: pin)
-        let key = try saltAESKey(pin: pinData, tipPriv: tipPriv)
+        let key = try await saltAESKey(pin: pinData, tipPriv: tipPriv)
         return try AESCryptor.decrypt(encryptedSalt, with: key)
     }
     
@@ -598,7 +604,7 @@ extension TIP {
                 throw Error.noSalt
             } else {
                 let encryptedSalt = try await custodialEncryptedSalt()
-                let key = try saltAESKey(pin: pinData, tipPriv: tipPriv)
+                let key = try await saltAESKey(pin: pinData, tipPriv: tipPriv)
                 return try AESCryptor.decrypt(encryptedSalt, with: key)
             }
         } else {
@@ -795,12 +801,31 @@ extension TIP {
         return signature.base64RawURLEncodedString()
     }
     
-    private static func spendPriv(salt: Data, tipPriv: Data) throws -> Data {
-        try Argon2i.hash(password: tipPriv, salt: salt)
+    // Hashes below stop with the task that's waiting for them
+    private static func saltAESKey(pin: Data, tipPriv: Data, arena: Argon2.Arena? = nil) async throws -> Data {
+        try await Argon2.Cancellation.withCurrentTask { cancellation in
+            try Argon2.hash(.i, password: pin, salt: tipPriv, arena: arena, cancellation: cancellation)
+        }
+    }
+    
+    private static func saltAESKeys(oldPIN: Data, newPIN: Data, tipPriv: Data, arena: Argon2.Arena?) async throws -> (old: Data, new: Data) {
+        let keys = try await Argon2.Cancellation.withCurrentTask { cancellation in
+            try Argon2.hash(.i, batch: [
+                (password: oldPIN, salt: tipPriv),
+                (password: newPIN, salt: tipPriv),
+            ], arena: arena, cancellation: cancellation)
+        }
+        return (old: keys[0], new: keys[1])
     }
     
-    private static func saltAESKey(pin: Data, tipPriv: Data) throws -> Data {
-        try Argon2i.hash(password: pin, salt: tipPriv)
+    private static func saltAESKeyAndSpendPriv(pin: Data, salt: Data, tipPriv: Data) async throws -> (saltAESKey: Data, spendPriv: Data) {
+        let hashes = try await Argon2.Cancellation.withCurrentTask { cancellation in
+            try Argon2.hash(.i, batch: [
+                (password: pin, salt: tipPriv),
+                (password: tipPriv, salt: salt),
+            ], cancellation: cancellation)
+        }
+        return (saltAESKey: hashes[0], spendPriv: hashes[1])
     }
     
 }
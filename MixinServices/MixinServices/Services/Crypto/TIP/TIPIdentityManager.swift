@@ -6,10 +6,12 @@ enum TIPIdentityManager {
         case identitySeedHash
     }
     
-    static func identityPair(pinData: Data, pinToken: Data) async throws -> (priv: Data, watcher: Data) {
+    static func identityPair(pinData: Data, pinToken: Data, arena: Argon2.Arena? = nil) async throws -> (priv: Data, watcher: Data) {
         Logger.tip.info(category: "TIPIdentityManager", message: "Generating identity pair")
         let identitySeed = try await identitySeed(pinToken: pinToken)
-        let identityPriv = try Argon2i.hash(password: pinData, salt: identitySeed)
+        let identityPriv = try await Argon2.Cancellation.withCurrentTask { cancellation in
+            try Argon2.hash(.i, password: pinData, salt: identitySeed, arena: arena, cancellation: cancellation)
+        }
         let watcher = try watcher(pinToken: pinToken, identitySeed: identitySeed)
         return (identityPriv, watcher)
     }
@@ -121,6 +121,7 @@ public final class LoginManager {
                 AppGroupKeychain.removeItemsForCurrentSession()
                 RequestSigning.removeCachedKey()
                 SignalDatabase.current.erase()
+                SignalStoreCache.shared.removeAll()
                 PropertiesDAO.shared.removeValue(forKey: .iterator)
                 AppGroupUserDefaults.Crypto.clearAll()
                 BadgeManager.shared.prepareForAccountChange()
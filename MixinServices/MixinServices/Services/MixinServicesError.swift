@@ -37,6 +37,7 @@ public enum MixinServicesError: Error {
     case encryptBotMessage([String: Any])
     case decryptBotMessage([String: Any])
     case databaseCorrupted(database: String, isAppExtension: Bool, error: Error?, fileSize: Int64?, fileCreationDate: Date?)
+    case signalStoreCommitFailed
     
 }
 
@@ -98,6 +99,8 @@ extension MixinServicesError: CustomNSError {
             return 26
         case .databaseCorrupted:
             return 27
+        case .signalStoreCommitFailed:
+            return 28
         }
     }
     
@@ -5,6 +5,10 @@ open class JobQueue {
     
     public let queue = OperationQueue()
     
+    // Jobs are added from receiving lanes concurrently, keeps the check for
+    // an existing job and the addition together
+    private let additionLock = NSLock()
+    
     public init(maxConcurrentOperationCount: Int) {
         queue.maxConcurrentOperationCount = maxConcurrentOperationCount
     }
@@ -27,10 +31,13 @@ open class JobQueue {
             return false
         }
         let jobId = job.getJobId()
+        additionLock.lock()
         guard !isExistJob(jodId: jobId) else {
+            additionLock.unlock()
             return false
         }
         queue.addOperation(job)
+        additionLock.unlock()
         if WebSocketService.shared.isConnected && queue.isSuspended {
             resume()
         }
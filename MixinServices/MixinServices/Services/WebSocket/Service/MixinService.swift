@@ -17,7 +17,9 @@ public class MixinService {
     
     public static var callMessageCoordinator: CallMessageCoordinator!
 
-    public static var isStopProcessMessages = false
+    // Read by every receiving lane while app state changes set it
+    @Synchronized(value: false)
+    public static var isStopProcessMessages: Bool
 
     @Synchronized(value: false)
     public internal(set) var processing: Bool
@@ -49,36 +51,34 @@ public class MixinService {
 
         var requestSignalKeyUsers = [BlazeMessageParamSession]()
         var signalKeyMessages = [TransferMessage]()
-        for p in participants {
-            if SignalProtocol.shared.containsSession(recipient: p.userId, deviceId: SignalProtocol.convertSessionIdToDeviceId(p.sessionId)) {
-                let (cipherText, isError) = try SignalProtocol.shared.encryptSenderKey(conversationId: conversationId, recipientId: p.userId, sessionId: p.sessionId)
-                if isError {
-                    requestSignalKeyUsers.append(BlazeMessageParamSession(userId: p.userId, sessionId: p.sessionId))
-                } else {
-                    signalKeyMessages.append(TransferMessage(recipientId: p.userId, data: cipherText, sessionId: p.sessionId))
-                }
+        let recipients = participants.map { BlazeMessageParamSession(userId: $0.userId, sessionId: $0.sessionId) }
+        let cipherTexts = try SignalProtocol.shared.encryptSenderKey(conversationId: conversationId, recipients: recipients)
+        for (recipient, cipherText) in zip(recipients, cipherTexts) {
+            if let cipherText = cipherText {
+                signalKeyMessages.append(TransferMessage(recipientId: recipient.userId, data: cipherText, sessionId: recipient.sessionId))
             } else {
-                requestSignalKeyUsers.append(BlazeMessageParamSession(userId: p.userId, sessionId: p.sessionId))
+                requestSignalKeyUsers.append(recipient)
             }
         }
 
         var noKeyList = [BlazeMessageParamSession]()
 
         if !requestSignalKeyUsers.isEmpty {
-            let signalKeys = signalKeysChannel(requestSignalKeyUsers: requestSignalKeyUsers)
+            let signalKeys = signalKeysChannel(requestSignalKeyUsers: requestSignalKeyUsers).filter { $0.userId != nil }
             Logger.conversation(id: conversationId).info(category: "CheckSessionSenderKey", message: "Created Signal Keys: \(signalKeys.map { "{\($0.userId ?? "(null)")}" }.joined(separator: ","))")
-            var keys = [String]()
-            for signalKey in signalKeys {
-                guard let recipientId = signalKey.userId else {
-                    continue
+            let keyRecipients = signalKeys.map { BlazeMessageParamSession(userId: $0.userId!, sessionId: $0.sessionId) }
+            let keyCipherTexts = try SignalProtocol.shared.encryptSenderKey(conversationId: conversationId, recipients: keyRecipients, signalKeys: signalKeys)
+            var keys = Set<String>()
+            for (recipient, cipherText) in zip(keyRecipients, keyCipherTexts) {
+                // A key with an untrusted identity gives no cipher text, the
+                // recipient is left without a key like those with no key at all
+                if let cipherText = cipherText {
+                    signalKeyMessages.append(TransferMessage(recipientId: recipient.userId, data: cipherText, sessionId: recipient.sessionId))
+                    keys.insert(recipient.userId)
                 }
-                try SignalProtocol.shared.processSession(userId: recipientId, key: signalKey)
-                let (cipherText, _) = try SignalProtocol.shared.encryptSenderKey(conversationId: conversationId, recipientId: recipientId, sessionId: signalKey.sessionId)
-                signalKeyMessages.append(TransferMessage(recipientId: recipientId, data: cipherText, sessionId: signalKey.sessionId))
-                keys.append(recipientId)
             }
 
-            noKeyList = requestSignalKeyUsers.filter{!keys.contains($0.userId)}
+            noKeyList = requestSignalKeyUsers.filter { !keys.contains($0.userId) }
             if !noKeyList.isEmpty {
                 let sentSenderKeys = noKeyList.map {
                     ParticipantSession.Sent(conversationId: conversationId,
@@ -94,25 +94,58 @@ public class MixinService {
             return
         }
         let checksum = ConversationChecksumCalculator.checksum(conversationId: conversationId)
-        let param = BlazeMessageParam(conversationId: conversationId, messages: signalKeyMessages, checksum: checksum)
-        let blazeMessage = BlazeMessage(params: param, action: BlazeMessageAction.createSignalKeyMessage.rawValue)
-        let (success, _, retry) = deliverNoThrow(blazeMessage: blazeMessage)
-        if success {
-            let sentSenderKeys = signalKeyMessages.map {
-                ParticipantSession.Sent(conversationId: conversationId,
-                                        userId: $0.recipientId!,
-                                        sessionId: $0.sessionId!,
-                                        sentToServer: SenderKeyStatus.SENT.rawValue)
+        for frame in senderKeyFrames(of: signalKeyMessages) {
+            let param = BlazeMessageParam(conversationId: conversationId, messages: frame, checksum: checksum)
+            let blazeMessage = BlazeMessage(params: param, action: BlazeMessageAction.createSignalKeyMessage.rawValue)
+            let (success, _, retry) = deliverNoThrow(blazeMessage: blazeMessage)
+            if success {
+                let sentSenderKeys = frame.map {
+                    ParticipantSession.Sent(conversationId: conversationId,
+                                            userId: $0.recipientId!,
+                                            sessionId: $0.sessionId!,
+                                            sentToServer: SenderKeyStatus.SENT.rawValue)
+                }
+                ParticipantSessionDAO.shared.updateParticipantSessionSent(sentSenderKeys)
+            } else if retry {
+                // Frames already delivered are marked as sent, so only the rest goes again
+                return try checkSessionSenderKey(conversationId: conversationId)
+            }
+            
+            let messages = frame.map { tm in
+                "\(tm.messageId):\(tm.recipientId ?? ""):\(tm.sessionId ?? "")"
+            }
+            Logger.conversation(id: conversationId).info(category: "CheckSessionSenderKey", message: "Signal Key Message delivered: \(success), retry: \(retry), messages: \(messages.joined(separator: ", "))")
+            guard success else {
+                return
             }
-            ParticipantSessionDAO.shared.updateParticipantSessionSent(sentSenderKeys)
-        } else if retry {
-            return try checkSessionSenderKey(conversationId: conversationId)
         }
-        
-        let messages = signalKeyMessages.map { tm in
-            "\(tm.messageId):\(tm.recipientId ?? ""):\(tm.sessionId ?? "")"
+    }
+
+    // Messages of 2MB or more gzipped are dropped by WebSocketService, and
+    // ciphertexts barely compress. Keys of large groups are packed greedily
+    // into as few frames as fit this budget instead of a single message.
+    private static let senderKeyFrameBudget = 1024 * 1024
+
+    private func senderKeyFrames(of messages: [TransferMessage]) -> [[TransferMessage]] {
+        // JSON keys and UUIDs of each TransferMessage
+        let overhead = 160
+        var frames = [[TransferMessage]]()
+        var frame = [TransferMessage]()
+        var frameSize = 0
+        for message in messages {
+            let size = overhead + (message.data?.utf8.count ?? 0) + (message.recipientId?.utf8.count ?? 0) + (message.sessionId?.utf8.count ?? 0)
+            if !frame.isEmpty && frameSize + size > Self.senderKeyFrameBudget {
+                frames.append(frame)
+                frame = []
+                frameSize = 0
+            }
+            frame.append(message)
+            frameSize += size
+        }
+        if !frame.isEmpty {
+            frames.append(frame)
         }
-        Logger.conversation(id: conversationId).info(category: "CheckSessionSenderKey", message: "Signal Key Message delivered: \(success), retry: \(retry), messages: \(messages.joined(separator: ", "))")
+        return frames
     }
 
     internal func syncConversation(conversationId: String) {
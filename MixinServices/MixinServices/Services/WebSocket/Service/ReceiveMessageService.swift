@@ -21,9 +21,12 @@ public class ReceiveMessageService: MixinService {
     private let receiveDispatchQueue = DispatchQueue(label: "one.mixin.services.queue.receive")
     
     let messageDispatchQueue = DispatchQueue(label: "one.mixin.services.queue.messages")
-    var refreshRefreshOneTimePreKeys = [String: TimeInterval]()
+    @Synchronized(value: [String: TimeInterval]())
+    var refreshRefreshOneTimePreKeys: [String: TimeInterval]
 
+    private let refreshKeysLock = NSLock()
     private lazy var processOperationQueue = OperationQueue(maxConcurrentOperationCount: 1)
+    private lazy var decryptOperationQueue = OperationQueue(maxConcurrentOperationCount: min(4, ProcessInfo.processInfo.activeProcessorCount))
 	private var queueObservation : NSKeyValueObservation?
 
 	override init() {
@@ -103,7 +106,10 @@ public class ReceiveMessageService: MixinService {
                                 callback(nil)
                                 return
                             }
-                            ReceiveMessageService.shared.processReceiveMessage(data: data)
+                            guard ReceiveMessageService.shared.processReceiveMessage(data: data) else {
+                                callback(nil)
+                                return
+                            }
                             if data.messageId == messageId {
                                 callback(MessageDAO.shared.getFullMessage(messageId: messageId))
                                 return
@@ -128,10 +134,9 @@ public class ReceiveMessageService: MixinService {
         guard !MixinService.isStopProcessMessages else {
             return
         }
-        guard !processing else {
+        guard !$processing.exchange(true) else {
             return
         }
-        processing = true
 
         processDispatchQueue.async {
             var displaySyncProcess = false
@@ -179,11 +184,9 @@ public class ReceiveMessageService: MixinService {
                                                     userInfo: [Self.UserInfoKey.progress: progress])
                 }
 
-                for data in blazeMessageDatas {
-                    if MixinService.isStopProcessMessages {
-                        return
-                    }
-                    ReceiveMessageService.shared.processReceiveMessage(data: data)
+                let isProcessed = ReceiveMessageService.shared.processReceiveMessagesConcurrently(blazeMessageDatas)
+                if MixinService.isStopProcessMessages || !isProcessed {
+                    return
                 }
 
                 finishedJobCount += blazeMessageDatas.count
@@ -201,14 +204,110 @@ public class ReceiveMessageService: MixinService {
         RatchetSenderKeyDAO.shared.setRatchetSenderKeyStatus(groupId: conversationId, senderId: recipientId, status: RatchetStatus.REQUESTING.rawValue, sessionId: sessionId)
     }
     
-    private func processReceiveMessage(data: BlazeMessageData) {
+    // Signal messages are decrypted on several threads. Messages that share a
+    // conversation or a sender session go to the same lane, so both keep their
+    // order: a pre key message sets up the session that later messages in
+    // other conversations decrypt with. Any other message may touch state of
+    // all conversations, it waits for the lanes and is processed alone.
+    // Each message is removed from the queue as soon as it's processed, a
+    // ratchet that has moved on can't decrypt it again after a relaunch.
+    // Returns false when a message stays queued, the lanes stop there and the
+    // remaining messages wait for the next run.
+    private func processReceiveMessagesConcurrently(_ blazeMessageDatas: [BlazeMessageData]) -> Bool {
+        var signalMessageDatas = [BlazeMessageData]()
+        @Synchronized(value: true)
+        var isProcessed: Bool
+
+        func processSignalMessages() {
+            let lanes = Self.lanes(of: signalMessageDatas)
+            signalMessageDatas.removeAll()
+            if lanes.count == 1 {
+                for data in lanes[0] {
+                    guard !MixinService.isStopProcessMessages else {
+                        return
+                    }
+                    guard processReceiveMessage(data: data) else {
+                        isProcessed = false
+                        return
+                    }
+                }
+            } else if lanes.count > 1 {
+                let operations = lanes.map { lane in
+                    BlockOperation {
+                        for data in lane {
+                            guard !MixinService.isStopProcessMessages, isProcessed else {
+                                return
+                            }
+                            guard ReceiveMessageService.shared.processReceiveMessage(data: data) else {
+                                isProcessed = false
+                                return
+                            }
+                        }
+                    }
+                }
+                decryptOperationQueue.addOperations(operations, waitUntilFinished: true)
+            }
+        }
+
+        for data in blazeMessageDatas {
+            if data.category.hasPrefix("SIGNAL_") {
+                signalMessageDatas.append(data)
+            } else {
+                processSignalMessages()
+                guard !MixinService.isStopProcessMessages, isProcessed else {
+                    return isProcessed
+                }
+                processReceiveMessage(data: data)
+            }
+        }
+        processSignalMessages()
+        return isProcessed
+    }
+
+    // Connected components of messages linked by conversation or sender session,
+    // each in the original order
+    private static func lanes(of blazeMessageDatas: [BlazeMessageData]) -> [[BlazeMessageData]] {
+        var parents = [String: String]()
+        func root(of key: String) -> String {
+            var key = key
+            while let parent = parents[key], parent != key {
+                parents[key] = parents[parent] ?? parent
+                key = parent
+            }
+            return key
+        }
+
+        for data in blazeMessageDatas {
+            let conversation = root(of: "c:" + data.conversationId)
+            let session = root(of: "s:" + data.userId + ":" + data.sessionId)
+            parents[conversation] = conversation
+            parents[session] = conversation
+        }
+
+        var laneIndices = [String: Int]()
+        var lanes = [[BlazeMessageData]]()
+        for data in blazeMessageDatas {
+            let key = root(of: "c:" + data.conversationId)
+            if let index = laneIndices[key] {
+                lanes[index].append(data)
+            } else {
+                laneIndices[key] = lanes.count
+                lanes.append([data])
+            }
+        }
+        return lanes
+    }
+
+    // Returns false if the message stays queued to be processed again
+    @discardableResult
+    private func processReceiveMessage(data: BlazeMessageData) -> Bool {
         guard LoginManager.shared.isLoggedIn else {
-            return
+            return true
         }
 
         if MessageDAO.shared.isExist(messageId: data.messageId) || MessageHistoryDAO.shared.isExist(messageId: data.messageId) {
             ReceiveMessageService.shared.processBadMessage(data: data)
-            return
+            return true
         }
 
         if data.category != MessageCategory.SYSTEM_USER.rawValue && data.category != MessageCategory.SYSTEM_CONVERSATION.rawValue {
@@ -217,13 +316,15 @@ public class ReceiveMessageService: MixinService {
         ReceiveMessageService.shared.checkSession(data: data)
 
         if MixinService.isStopProcessMessages {
-            return
+            return true
         }
 
         if MessageCategory.isLegal(category: data.category) {
             ReceiveMessageService.shared.processSystemMessage(data: data)
             ReceiveMessageService.shared.processPlainMessage(data: data)
-            ReceiveMessageService.shared.processSignalMessage(data: data)
+            guard ReceiveMessageService.shared.processSignalMessage(data: data) else {
+                return false
+            }
             ReceiveMessageService.shared.processEncryptedMessage(data: data)
             ReceiveMessageService.shared.processAppButton(data: data)
             ReceiveMessageService.shared.processAppCard(data: data)
@@ -235,6 +336,7 @@ public class ReceiveMessageService: MixinService {
             ReceiveMessageService.shared.updateRemoteMessageStatus(messageId: data.messageId, status: .DELIVERED)
         }
         BlazeMessageDAO.shared.delete(data: data)
+        return true
     }
 
     private func checkSession(data: BlazeMessageData) {
@@ -420,16 +522,19 @@ public class ReceiveMessageService: MixinService {
         }
     }
 
-    private func processSignalMessage(data: BlazeMessageData) {
+    // Returns false if the ratchet state couldn't be saved, the message is
+    // decrypted again from the state in the database later
+    private func processSignalMessage(data: BlazeMessageData) -> Bool {
         guard data.category.hasPrefix("SIGNAL_") else {
-            return
+            return true
         }
 
         let username = UserDAO.shared.getUser(userId: data.userId)?.fullName ?? data.userId
 
+        // The history of a key message is written once it's decrypted or has
+        // failed, a message that stays queued must not look processed
         if data.category == MessageCategory.SIGNAL_KEY.rawValue {
             updateRemoteMessageStatus(messageId: data.messageId, status: .READ)
-            MessageHistoryDAO.shared.replaceMessageHistory(messageId: data.messageId)
         } else {
             updateRemoteMessageStatus(messageId: data.messageId, status: .DELIVERED)
         }
@@ -463,6 +568,9 @@ public class ReceiveMessageService: MixinService {
                     }
                 }
             })
+            if data.category == MessageCategory.SIGNAL_KEY.rawValue {
+                MessageHistoryDAO.shared.replaceMessageHistory(messageId: data.messageId)
+            }
             let status = RatchetSenderKeyDAO.shared.getRatchetSenderKeyStatus(groupId: data.conversationId, senderId: data.userId, sessionId: data.sessionId)
             let info: Logger.UserInfo = [
                 "username": username,
@@ -477,7 +585,14 @@ public class ReceiveMessageService: MixinService {
             if status == RatchetStatus.REQUESTING.rawValue {
                 self.requestResendMessage(conversationId: data.conversationId, userId: data.userId, sessionId: data.sessionId)
             }
+        } catch MixinServicesError.signalStoreCommitFailed {
+            Logger.conversation(id: data.conversationId).error(category: "ProcessSignalMessage", message: "Failed to save signal records for: \(data.messageId)")
+            reporter.report(error: MixinServicesError.signalStoreCommitFailed)
+            return false
         } catch {
+            if data.category == MessageCategory.SIGNAL_KEY.rawValue {
+                MessageHistoryDAO.shared.replaceMessageHistory(messageId: data.messageId)
+            }
             let info: Logger.UserInfo = [
                 "username": username,
                 "category": data.category,
@@ -513,10 +628,10 @@ public class ReceiveMessageService: MixinService {
             
             guard !MessageDAO.shared.isExist(messageId: data.messageId) else {
                 reporter.report(error: MixinServicesError.duplicatedMessage)
-                return
+                return true
             }
             guard decoded.resendMessageId == nil else {
-                return
+                return true
             }
             if (data.category == MessageCategory.SIGNAL_KEY.rawValue) {
                 RatchetSenderKeyDAO.shared.deleteRatchetSenderKey(groupId: data.conversationId, senderId: data.userId, sessionId: data.sessionId)
@@ -530,6 +645,7 @@ public class ReceiveMessageService: MixinService {
                 }
             }
         }
+        return true
     }
     
     private func processEncryptedMessage(data: BlazeMessageData) {
@@ -567,6 +683,10 @@ public class ReceiveMessageService: MixinService {
     }
     
     private func refreshKeys(conversationId: String) {
+        refreshKeysLock.lock()
+        defer {
+            refreshKeysLock.unlock()
+        }
         let now = Date().timeIntervalSince1970
         guard now - (refreshRefreshOneTimePreKeys[conversationId] ?? 0) > 60 else {
             return
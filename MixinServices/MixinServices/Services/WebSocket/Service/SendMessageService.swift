@@ -17,7 +17,8 @@ public class SendMessageService: MixinService {
     
     private let dispatchQueue = DispatchQueue(label: "one.mixin.services.queue.send.messages")
     private let httpDispatchQueue = DispatchQueue(label: "one.mixin.services.queue.send.http.messages")
-    private var httpProcessing = false
+    @Synchronized(value: false)
+    private var httpProcessing: Bool
     
     public func sendPinMessages(items: [MessageItem], conversationId: String, action: TransferPinAction) {
         DispatchQueue.global().async {
@@ -323,10 +324,10 @@ public class SendMessageService: MixinService {
     }
     
     public func processHttpMessages() {
-        guard !httpProcessing else {
+        // Called from every receiving lane, only one of them starts the loop
+        guard !$httpProcessing.exchange(true) else {
             return
         }
-        httpProcessing = true
         
         httpDispatchQueue.async {
             defer {
@@ -391,10 +392,9 @@ public class SendMessageService: MixinService {
     }
     
     public func processWebSocketMessages() {
-        guard !processing else {
+        guard !$processing.exchange(true) else {
             return
         }
-        processing = true
         
         dispatchQueue.async {
             defer {
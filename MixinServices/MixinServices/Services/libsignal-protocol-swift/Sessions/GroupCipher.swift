@@ -56,9 +56,11 @@ public final class GroupCipher {
 
         // Encrypt message
         var encryptedMessage: OpaquePointer? = nil
-        result = message.withUnsafeUInt8Pointer { mPtr in
-            withUnsafeMutablePointer(to: &encryptedMessage) {
-                group_cipher_encrypt(cipher, mPtr, message.count, $0)
+        result = Signal.withLock(on: remoteAddress) {
+            message.withUnsafeUInt8Pointer { mPtr in
+                withUnsafeMutablePointer(to: &encryptedMessage) {
+                    group_cipher_encrypt(cipher, mPtr, message.count, $0)
+                }
             }
         }
         guard result == 0 else { throw SignalError(value: result) }
@@ -142,8 +144,10 @@ public final class GroupCipher {
         // Decrypt message
         var plaintext: OpaquePointer? = nil
         let rawSelf = UnsafeMutableRawPointer(Unmanaged.passUnretained(self).toOpaque())
-        result = withUnsafeMutablePointer(to: &plaintext) {
-            group_cipher_decrypt(cipher, senderKeyMessage, rawSelf, $0)
+        result = Signal.withLock(on: remoteAddress) {
+            withUnsafeMutablePointer(to: &plaintext) {
+                group_cipher_decrypt(cipher, senderKeyMessage, rawSelf, $0)
+            }
         }
 
         guard result == 0 else { throw SignalError(value: result) }
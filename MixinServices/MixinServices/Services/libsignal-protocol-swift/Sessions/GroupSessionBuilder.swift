@@ -79,7 +79,9 @@ public final class GroupSessionBuilder {
         defer { group_session_builder_free(builder) }
 
         // Process message
-        result = group_session_builder_process_session(builder, remoteAddress.pointer, messagePtr)
+        result = Signal.withLock(on: remoteAddress) {
+            group_session_builder_process_session(builder, remoteAddress.pointer, messagePtr)
+        }
         guard result == 0 else { throw SignalError(value: result) }
     }
 
@@ -104,8 +106,10 @@ public final class GroupSessionBuilder {
 
         // Create message
         var message: OpaquePointer? = nil
-        result = withUnsafeMutablePointer(to: &message) {
-            group_session_builder_create_session(builder, $0, localAddress.pointer)
+        result = Signal.withLock(on: localAddress) {
+            withUnsafeMutablePointer(to: &message) {
+                group_session_builder_create_session(builder, $0, localAddress.pointer)
+            }
         }
         guard result == 0 else { throw SignalError(value: result) }
         defer { sender_key_distribution_message_destroy(message) }
@@ -133,8 +137,10 @@ public final class GroupSessionBuilder {
 
         // get message
         var message: OpaquePointer? = nil
-        result = withUnsafeMutablePointer(to: &message) {
-            get_sender_key_distribution_message(builder, $0, localAddress.pointer)
+        result = Signal.withLock(on: localAddress) {
+            withUnsafeMutablePointer(to: &message) {
+                get_sender_key_distribution_message(builder, $0, localAddress.pointer)
+            }
         }
         guard result == 0 else { throw SignalError(value: result) }
         defer { sender_key_distribution_message_destroy(message) }
@@ -160,8 +166,10 @@ public final class GroupSessionBuilder {
 
         // get public key
         var message: OpaquePointer? = nil
-        result = withUnsafeMutablePointer(to: &message) {
-            get_sender_key_public(builder, $0, localAddress.pointer)
+        result = Signal.withLock(on: localAddress) {
+            withUnsafeMutablePointer(to: &message) {
+                get_sender_key_public(builder, $0, localAddress.pointer)
+            }
         }
         guard result == 0 else { throw SignalError(value: result) }
         defer { signal_type_unref(message) }
@@ -59,7 +59,9 @@ public final class SessionBuilder {
         let bundle = try preKeyBundle.pointer()
         defer { session_pre_key_bundle_destroy(bundle) }
 
-        result = session_builder_process_pre_key_bundle(builder, bundle)
+        result = Signal.withLock(on: remoteAddress) {
+            session_builder_process_pre_key_bundle(builder, bundle)
+        }
         guard result == 0 else { throw SignalError(value: result) }
     }
 }
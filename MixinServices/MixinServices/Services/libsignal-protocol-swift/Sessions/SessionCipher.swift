@@ -60,9 +60,11 @@ public final class SessionCipher {
 
         var ciphertext: OpaquePointer? = nil
 
-        let result = message.withUnsafeUInt8Pointer { mPtr in
-            withUnsafeMutablePointer(to: &ciphertext) { cPtr in
-                session_cipher_encrypt(cipher, mPtr, message.count, cPtr)
+        let result = Signal.withLock(on: remoteAddress) {
+            message.withUnsafeUInt8Pointer { mPtr in
+                withUnsafeMutablePointer(to: &ciphertext) { cPtr in
+                    session_cipher_encrypt(cipher, mPtr, message.count, cPtr)
+                }
             }
         }
         guard result == SG_SUCCESS else { throw SignalError(value: result) }
@@ -157,8 +159,10 @@ public final class SessionCipher {
 
         var plaintextPtr: OpaquePointer? = nil
         let rawSelf = UnsafeMutableRawPointer(Unmanaged.passUnretained(self).toOpaque())
-        result = withUnsafeMutablePointer(to: &plaintextPtr) {
-            session_cipher_decrypt_pre_key_signal_message(cipher, messagePtr, rawSelf, $0)
+        result = Signal.withLock(on: remoteAddress) {
+            withUnsafeMutablePointer(to: &plaintextPtr) {
+                session_cipher_decrypt_pre_key_signal_message(cipher, messagePtr, rawSelf, $0)
+            }
         }
         guard result == SG_SUCCESS else { throw SignalError(value: result) }
         defer { signal_buffer_free(plaintextPtr) }
@@ -204,8 +208,10 @@ public final class SessionCipher {
 
         var plaintextPtr: OpaquePointer? = nil
         let rawSelf = UnsafeMutableRawPointer(Unmanaged.passUnretained(self).toOpaque())
-        result = withUnsafeMutablePointer(to: &plaintextPtr) {
-            session_cipher_decrypt_signal_message(cipher, messagePtr, rawSelf, $0)
+        result = Signal.withLock(on: remoteAddress) {
+            withUnsafeMutablePointer(to: &plaintextPtr) {
+                session_cipher_decrypt_signal_message(cipher, messagePtr, rawSelf, $0)
+            }
         }
         guard result == SG_SUCCESS else { throw SignalError(value: result) }
         defer { signal_buffer_free(plaintextPtr) }
@@ -131,3 +131,28 @@ public extension Signal {
         return try SessionSignedPreKey(pointer: keyPtr!)
     }
 }
+
+extension Signal {
+
+    /**
+     Run a libsignal call for a 1:1 session. It only serializes with
+     other calls for the same address instead of with every call.
+     */
+    static func withLock<Result>(on address: SignalAddress, _ body: () throws -> Result) rethrows -> Result {
+        let pointee = address.signalAddress.pointee
+        let outerScope = address_lock_scope_enter(nil, 0, pointee.name, pointee.name_len, pointee.device_id)
+        defer { address_lock_scope_leave(outerScope) }
+        return try body()
+    }
+
+    /**
+     Run a libsignal call for the sender key of a group member. It only
+     serializes with other calls for the same sender key name.
+     */
+    static func withLock<Result>(on senderKeyName: SignalSenderKeyName, _ body: () throws -> Result) rethrows -> Result {
+        let pointee = senderKeyName.pointer.pointee
+        let outerScope = address_lock_scope_enter(pointee.group_id, pointee.group_id_len, pointee.sender.name, pointee.sender.name_len, pointee.sender.device_id)
+        defer { address_lock_scope_leave(outerScope) }
+        return try body()
+    }
+}
@@ -0,0 +1,149 @@
+//
+//  address_lock.c
+//  libsignal-protocol-swift iOS
+//
+
+#include "address_lock.h"
+
+#include <pthread.h>
+
+// Scoped calls hold the global lock shared plus their shard, unscoped ones
+// hold the global lock exclusively
+#define ADDRESS_LOCK_SHARDS 64
+#define ADDRESS_LOCK_MAX_DEPTH 32
+
+static pthread_rwlock_t global_lock;
+static pthread_mutex_t shard_locks[ADDRESS_LOCK_SHARDS];
+
+static _Thread_local int scope_shard = -1;
+static _Thread_local int exclusive = 0;
+static _Thread_local uint64_t held_shards = 0;
+static _Thread_local unsigned int lock_depth = 0;
+// The shard each acquire took, -1 for ones that took nothing
+static _Thread_local int8_t taken_shards[ADDRESS_LOCK_MAX_DEPTH];
+
+int address_lock_init(void) {
+    int i;
+
+    if(pthread_rwlock_init(&global_lock, 0) != 0) {
+        return -1;
+    }
+    for(i = 0; i < ADDRESS_LOCK_SHARDS; i++) {
+        if(pthread_mutex_init(&shard_locks[i], 0) != 0) {
+            while(i-- > 0) {
+                pthread_mutex_destroy(&shard_locks[i]);
+            }
+            pthread_rwlock_destroy(&global_lock);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void address_lock_destroy(void) {
+    int i;
+
+    for(i = 0; i < ADDRESS_LOCK_SHARDS; i++) {
+        pthread_mutex_destroy(&shard_locks[i]);
+    }
+    pthread_rwlock_destroy(&global_lock);
+}
+
+void address_lock_acquire(void *user_data) {
+    int taken = -1;
+
+    if(lock_depth == 0) {
+        if(scope_shard < 0) {
+            pthread_rwlock_wrlock(&global_lock);
+            exclusive = 1;
+        }
+        else {
+            // The shard goes first, so a thread never blocks on a shard while
+            // holding the global lock shared
+            pthread_mutex_lock(&shard_locks[scope_shard]);
+            pthread_rwlock_rdlock(&global_lock);
+            taken = scope_shard;
+        }
+    }
+    else if(!exclusive && scope_shard >= 0 && !(held_shards & (UINT64_C(1) << scope_shard))) {
+        // A call for another scope made from inside a libsignal call, e.g. from
+        // a decryption callback. Waiting for the shard could deadlock with a
+        // thread nesting the other way round, so it's only tried. If it's
+        // busy, this thread becomes exclusive instead: the shared hold is
+        // dropped and the global lock taken for writing. Shards already held
+        // are kept, and a thread waiting for one of them holds nothing else.
+        if(pthread_mutex_trylock(&shard_locks[scope_shard]) == 0) {
+            taken = scope_shard;
+        }
+        else {
+            pthread_rwlock_unlock(&global_lock);
+            pthread_rwlock_wrlock(&global_lock);
+            exclusive = 1;
+        }
+    }
+
+    // Shards taken too deep to remember are released when the thread leaves
+    // libsignal
+    if(lock_depth < ADDRESS_LOCK_MAX_DEPTH) {
+        taken_shards[lock_depth] = (int8_t) taken;
+    }
+    if(taken >= 0) {
+        held_shards |= UINT64_C(1) << taken;
+    }
+    lock_depth++;
+}
+
+void address_lock_release(void *user_data) {
+    int i;
+
+    lock_depth--;
+    if(lock_depth < ADDRESS_LOCK_MAX_DEPTH && taken_shards[lock_depth] >= 0) {
+        int taken = taken_shards[lock_depth];
+        held_shards &= ~(UINT64_C(1) << taken);
+        pthread_mutex_unlock(&shard_locks[taken]);
+    }
+    if(lock_depth == 0) {
+        pthread_rwlock_unlock(&global_lock);
+        exclusive = 0;
+        for(i = 0; held_shards != 0 && i < ADDRESS_LOCK_SHARDS; i++) {
+            if(held_shards & (UINT64_C(1) << i)) {
+                pthread_mutex_unlock(&shard_locks[i]);
+            }
+        }
+        held_shards = 0;
+    }
+}
+
+// FNV-1a
+static uint32_t address_hash(uint32_t hash, const char *bytes, size_t len) {
+    size_t i;
+
+    for(i = 0; i < len; i++) {
+        hash ^= (uint8_t) bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+int address_lock_scope_enter(const char *group_id, size_t group_id_len,
+                             const char *name, size_t name_len,
+                             int32_t device_id) {
+    int outer_shard = scope_shard;
+    uint32_t hash = 2166136261u;
+    uint8_t separator = group_id ? 1 : 0;
+
+    if(group_id) {
+        hash = address_hash(hash, group_id, group_id_len);
+    }
+    hash = address_hash(hash, (const char *) &separator, 1);
+    hash = address_hash(hash, name, name_len);
+    hash = address_hash(hash, (const char *) &device_id, sizeof(device_id));
+    // Fold the high bits in, the low ones of FNV-1a mix poorly
+    hash ^= hash >> 16;
+    scope_shard = (int) (hash % ADDRESS_LOCK_SHARDS);
+    return outer_shard;
+}
+
+void address_lock_scope_leave(int outer_scope) {
+    scope_shard = outer_scope;
+}
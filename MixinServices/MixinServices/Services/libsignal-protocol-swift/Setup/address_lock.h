@@ -0,0 +1,42 @@
+//
+//  address_lock.h
+//  libsignal-protocol-swift iOS
+//
+
+#ifndef address_lock_h
+#define address_lock_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The libsignal lock, sharded by the address a call works on.
+//
+// libsignal takes one lock around every session, group and builder call but
+// doesn't say which conversation it is for. Callers announce that with a
+// scope before calling in; scoped calls only serialize with calls for
+// addresses in the same shard, and calls made without a scope are exclusive
+// like with a single global lock. The lock is recursive per thread.
+
+int address_lock_init(void);
+void address_lock_destroy(void);
+
+// The locking functions installed into the signal context
+void address_lock_acquire(void *user_data);
+void address_lock_release(void *user_data);
+
+// Scopes libsignal calls made by this thread to a 1:1 session, when group_id
+// is NULL, or to the sender key of a group member. Returns the scope it
+// replaces, pass it to address_lock_scope_leave to restore that one.
+//
+// A scope entered inside a libsignal call, e.g. from a decryption callback,
+// takes its own shard too if it's free. If it's busy, the thread gives up its
+// shared hold and waits to run exclusively, so nesting in any order can't
+// deadlock. An exclusive call may then run between the outer call loading its
+// records and storing them, prefer calling into libsignal for another address
+// after the outer call returns.
+int address_lock_scope_enter(const char *group_id, size_t group_id_len,
+                             const char *name, size_t name_len,
+                             int32_t device_id);
+void address_lock_scope_leave(int outer_scope);
+
+#endif /* address_lock_h */
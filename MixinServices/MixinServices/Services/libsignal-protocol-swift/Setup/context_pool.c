@@ -0,0 +1,103 @@
+//
+//  context_pool.c
+//  libsignal-protocol-swift iOS
+//
+
+#include "context_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A ratchet step keeps a handful of contexts alive at once, more than that
+// are just freed
+#define CONTEXT_POOL_DEPTH 8
+
+typedef struct {
+    void *objects[CONTEXT_POOL_DEPTH];
+    size_t count;
+    context_pool_destroy_func destroy;
+} context_pool_list;
+
+typedef struct {
+    context_pool_list lists[CONTEXT_POOL_COUNT];
+} context_pool_thread;
+
+static pthread_once_t context_pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t context_pool_key;
+
+static void context_pool_thread_destroy(void *state) {
+    context_pool_thread *thread = state;
+    int i;
+    size_t j;
+
+    for(i = 0; i < CONTEXT_POOL_COUNT; i++) {
+        context_pool_list *list = &thread->lists[i];
+        for(j = 0; j < list->count; j++) {
+            list->destroy(list->objects[j]);
+        }
+    }
+    free(thread);
+}
+
+static void context_pool_init_once(void) {
+    pthread_key_create(&context_pool_key, context_pool_thread_destroy);
+}
+
+static context_pool_thread *context_pool_current(int create) {
+    context_pool_thread *thread;
+
+    pthread_once(&context_pool_once, context_pool_init_once);
+    thread = pthread_getspecific(context_pool_key);
+    if(thread || !create) {
+        return thread;
+    }
+
+    thread = calloc(1, sizeof(context_pool_thread));
+    if(!thread) {
+        return NULL;
+    }
+    if(pthread_setspecific(context_pool_key, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void *context_pool_acquire(context_pool_id pool) {
+    context_pool_thread *thread = context_pool_current(0);
+    if(!thread) {
+        return NULL;
+    }
+
+    context_pool_list *list = &thread->lists[pool];
+    if(list->count == 0) {
+        return NULL;
+    }
+    list->count--;
+    void *object = list->objects[list->count];
+    list->objects[list->count] = NULL;
+    return object;
+}
+
+void context_pool_release(context_pool_id pool, void *object, context_pool_destroy_func destroy) {
+    if(!object) {
+        return;
+    }
+
+    context_pool_thread *thread = context_pool_current(1);
+    if(!thread || thread->lists[pool].count == CONTEXT_POOL_DEPTH) {
+        destroy(object);
+        return;
+    }
+
+    context_pool_list *list = &thread->lists[pool];
+    list->objects[list->count] = object;
+    list->count++;
+    list->destroy = destroy;
+}
+
+void context_pool_wipe(void *object, size_t size) {
+    static void *(*const volatile memset_sec)(void *, int, size_t) = &memset;
+    memset_sec(object, 0, size);
+}
@@ -0,0 +1,36 @@
+//
+//  context_pool.h
+//  libsignal-protocol-swift iOS
+//
+
+#ifndef context_pool_h
+#define context_pool_h
+
+#include <stddef.h>
+
+// Per-thread free lists of crypto contexts, so the per-message HMAC and
+// digest operations of libsignal don't go to the heap. No locks are taken,
+// each thread only ever touches its own lists.
+
+typedef enum {
+    CONTEXT_POOL_HMAC_SHA256,
+    CONTEXT_POOL_SHA512,
+    CONTEXT_POOL_CIPHER,
+    CONTEXT_POOL_COUNT
+} context_pool_id;
+
+typedef void (*context_pool_destroy_func)(void *object);
+
+// Returns a context previously released into pool on this thread, or NULL if
+// there is none and the caller has to create one.
+void *context_pool_acquire(context_pool_id pool);
+
+// Keeps object for reuse by this thread. The caller wipes or resets it first,
+// pooled objects must not hold any key material. Objects that don't fit,
+// and those left over when the thread exits, are passed to destroy.
+void context_pool_release(context_pool_id pool, void *object, context_pool_destroy_func destroy);
+
+// Zeroes memory in a way the compiler can't elide
+void context_pool_wipe(void *object, size_t size);
+
+#endif /* context_pool_h */
@@ -0,0 +1,26 @@
+//
+//  crypto_backend.h
+//  libsignal-protocol-swift iOS
+//
+
+#ifndef crypto_backend_h
+#define crypto_backend_h
+
+// Selects the library behind the signal_crypto_provider vtable. Apple builds
+// use CommonCrypto, everything else a libcrypto (OpenSSL 1.1+, BoringSSL or
+// LibreSSL). Either can be forced with -DSIGNAL_CRYPTO_BACKEND_COMMONCRYPTO=1
+// or -DSIGNAL_CRYPTO_BACKEND_OPENSSL=1.
+
+#if !defined(SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO) && !defined(SIGNAL_CRYPTO_BACKEND_OPENSSL)
+#if defined(__APPLE__)
+#define SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO 1
+#else
+#define SIGNAL_CRYPTO_BACKEND_OPENSSL 1
+#endif
+#endif
+
+#if defined(SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO) && defined(SIGNAL_CRYPTO_BACKEND_OPENSSL)
+#error "Only one of SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO and SIGNAL_CRYPTO_BACKEND_OPENSSL can be defined"
+#endif
+
+#endif /* crypto_backend_h */
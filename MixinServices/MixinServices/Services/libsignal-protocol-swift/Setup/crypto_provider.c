@@ -6,7 +6,13 @@
 //  Copyright © 2018 User. All rights reserved.
 //
 
+#include "crypto_backend.h"
+
+#if defined(SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO)
+
 #include "setup.h"
+#include "random_generator.h"
+#include "context_pool.h"
 
 #include <libsignal_protocol_c/signal_protocol.h>
 
@@ -62,34 +68,20 @@ int setup_crypto_provider(void *context) {
 }
 
 int test_random_generator(uint8_t *data, size_t len, void *user_data) {
-    /*
-     * Apple's documentation recommends this method for generating secure
-     * random numbers.
-     */
-    int result = 0;
-
-    FILE *fp = fopen("/dev/random", "r");
-    if(!fp) {
-        result = SG_ERR_UNKNOWN;
-        goto complete;
-    }
-
-    size_t n = fread(data, 1, len, fp);
-    if(n != len) {
-        result = SG_ERR_UNKNOWN;
-        goto complete;
-    }
-
-complete:
-    if(fp) {
-        fclose(fp);
+    // Served from a per-thread ChaCha20 buffer seeded by the kernel, so bulk
+    // key generation doesn't open /dev/random for every request.
+    if(random_generator_fill(data, len) != 0) {
+        return SG_ERR_UNKNOWN;
     }
-    return result;
+    return 0;
 }
 
 int test_hmac_sha256_init(void **hmac_context, const uint8_t *key, size_t key_len, void *user_data)
 {
-    CCHmacContext *ctx = malloc(sizeof(CCHmacContext));
+    CCHmacContext *ctx = context_pool_acquire(CONTEXT_POOL_HMAC_SHA256);
+    if(!ctx) {
+        ctx = malloc(sizeof(CCHmacContext));
+    }
     if(!ctx) {
         return SG_ERR_NOMEM;
     }
@@ -127,7 +119,8 @@ void test_hmac_sha256_cleanup(void *hmac_context, void *user_data)
 {
     if(hmac_context) {
         CCHmacContext *ctx = hmac_context;
-        free(ctx);
+        context_pool_wipe(ctx, sizeof(CCHmacContext));
+        context_pool_release(CONTEXT_POOL_HMAC_SHA256, ctx, free);
     }
 }
 
@@ -135,7 +128,10 @@ int test_sha512_digest_init(void **digest_context, void *user_data)
 {
     int result = 0;
 
-    CC_SHA512_CTX *ctx = malloc(sizeof(CC_SHA512_CTX));
+    CC_SHA512_CTX *ctx = context_pool_acquire(CONTEXT_POOL_SHA512);
+    if(!ctx) {
+        ctx = malloc(sizeof(CC_SHA512_CTX));
+    }
     if(!ctx) {
         result = SG_ERR_NOMEM;
         goto complete;
@@ -150,7 +146,8 @@ int test_sha512_digest_init(void **digest_context, void *user_data)
 complete:
     if(result < 0) {
         if(ctx) {
-            free(ctx);
+            context_pool_wipe(ctx, sizeof(CC_SHA512_CTX));
+            context_pool_release(CONTEXT_POOL_SHA512, ctx, free);
         }
     }
     else {
@@ -208,7 +205,8 @@ void test_sha512_digest_cleanup(void *digest_context, void *user_data)
 {
     if(digest_context) {
         CC_SHA512_CTX *ctx = digest_context;
-        free(ctx);
+        context_pool_wipe(ctx, sizeof(CC_SHA512_CTX));
+        context_pool_release(CONTEXT_POOL_SHA512, ctx, free);
     }
 }
 
@@ -234,23 +232,35 @@ int cc_status_to_result(CCCryptorStatus status)
     }
 }
 
-int test_encrypt(signal_buffer **output,
-                 int cipher,
-                 const uint8_t *key, size_t key_len,
-                 const uint8_t *iv, size_t iv_len,
-                 const uint8_t *plaintext, size_t plaintext_len,
-                 void *user_data)
+// Plaintexts up to this size are decrypted on the stack before being copied
+// into the output, longer ones go through the heap
+#define AES_STACK_OUTPUT_SIZE 1024
+
+// libsignal derives a new key for every message, so a cryptor is created for
+// each call. What's saved is the output copy: encryption, and decryption in
+// CTR mode, know the output length up front and write straight into the
+// signal_buffer.
+static int aes_crypt(signal_buffer **output,
+                     CCOperation op,
+                     int cipher,
+                     const uint8_t *key, size_t key_len,
+                     const uint8_t *iv, size_t iv_len,
+                     const uint8_t *input, size_t input_len)
 {
     int result = 0;
+    uint8_t stack_buf[AES_STACK_OUTPUT_SIZE];
+    uint8_t *heap_buf = 0;
     uint8_t *out_buf = 0;
+    size_t available_len = 0;
+    signal_buffer *output_buffer = 0;
     CCCryptorStatus status = kCCSuccess;
     CCCryptorRef ref = 0;
 
     if(cipher == SG_CIPHER_AES_CBC_PKCS5) {
-        status = CCCryptorCreate(kCCEncrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key, key_len, iv, &ref);
+        status = CCCryptorCreate(op, kCCAlgorithmAES, kCCOptionPKCS7Padding, key, key_len, iv, &ref);
     }
     else if(cipher == SG_CIPHER_AES_CTR_NOPADDING) {
-        status = CCCryptorCreateWithMode(kCCEncrypt, kCCModeCTR, kCCAlgorithmAES, ccNoPadding,
+        status = CCCryptorCreateWithMode(op, kCCModeCTR, kCCAlgorithmAES, ccNoPadding,
                                          iv, key, key_len, 0, 0, 0, kCCModeOptionCTR_BE, &ref);
     }
     else {
@@ -261,16 +271,30 @@ int test_encrypt(signal_buffer **output,
         goto complete;
     }
 
-    size_t available_len = CCCryptorGetOutputLength(ref, plaintext_len, 1);
-    out_buf = malloc(available_len);
-    if(!out_buf) {
-        fprintf(stderr, "cannot allocate output buffer\n");
-        result = SG_ERR_NOMEM;
-        goto complete;
+    available_len = CCCryptorGetOutputLength(ref, input_len, 1);
+    if(op == kCCEncrypt || cipher == SG_CIPHER_AES_CTR_NOPADDING) {
+        output_buffer = signal_buffer_alloc(available_len);
+        if(!output_buffer) {
+            result = SG_ERR_NOMEM;
+            goto complete;
+        }
+        out_buf = signal_buffer_data(output_buffer);
+    }
+    else if(available_len <= sizeof(stack_buf)) {
+        out_buf = stack_buf;
+    }
+    else {
+        heap_buf = malloc(available_len);
+        out_buf = heap_buf;
+        if(!heap_buf) {
+            fprintf(stderr, "cannot allocate output buffer\n");
+            result = SG_ERR_NOMEM;
+            goto complete;
+        }
     }
 
     size_t update_moved_len = 0;
-    status = CCCryptorUpdate(ref, plaintext, plaintext_len, out_buf, available_len, &update_moved_len);
+    status = CCCryptorUpdate(ref, input, input_len, out_buf, available_len, &update_moved_len);
     if(status != kCCSuccess) {
         result = cc_status_to_result(status);
         goto complete;
@@ -283,24 +307,49 @@ int test_encrypt(signal_buffer **output,
         goto complete;
     }
 
-    signal_buffer *output_buffer = signal_buffer_create(out_buf, update_moved_len + final_moved_len);
-    if(!output_buffer) {
-        result = SG_ERR_NOMEM;
-        goto complete;
+    size_t moved_len = update_moved_len + final_moved_len;
+    if(!output_buffer || moved_len != available_len) {
+        signal_buffer *copy = signal_buffer_create(out_buf, moved_len);
+        if(!copy) {
+            result = SG_ERR_NOMEM;
+            goto complete;
+        }
+        if(output_buffer) {
+            signal_buffer_free(output_buffer);
+        }
+        output_buffer = copy;
     }
 
     *output = output_buffer;
+    output_buffer = 0;
 
 complete:
     if(ref) {
         CCCryptorRelease(ref);
     }
-    if(out_buf) {
-        free(out_buf);
+    if(out_buf == stack_buf) {
+        context_pool_wipe(stack_buf, sizeof(stack_buf));
+    }
+    if(heap_buf) {
+        context_pool_wipe(heap_buf, available_len);
+        free(heap_buf);
+    }
+    if(output_buffer) {
+        signal_buffer_free(output_buffer);
     }
     return result;
 }
 
+int test_encrypt(signal_buffer **output,
+                 int cipher,
+                 const uint8_t *key, size_t key_len,
+                 const uint8_t *iv, size_t iv_len,
+                 const uint8_t *plaintext, size_t plaintext_len,
+                 void *user_data)
+{
+    return aes_crypt(output, kCCEncrypt, cipher, key, key_len, iv, iv_len, plaintext, plaintext_len);
+}
+
 int test_decrypt(signal_buffer **output,
                  int cipher,
                  const uint8_t *key, size_t key_len,
@@ -308,61 +357,7 @@ int test_decrypt(signal_buffer **output,
                  const uint8_t *ciphertext, size_t ciphertext_len,
                  void *user_data)
 {
-    int result = 0;
-    uint8_t *out_buf = 0;
-    CCCryptorStatus status = kCCSuccess;
-    CCCryptorRef ref = 0;
-
-    if(cipher == SG_CIPHER_AES_CBC_PKCS5) {
-        status = CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES, kCCOptionPKCS7Padding, key, key_len, iv, &ref);
-    }
-    else if(cipher == SG_CIPHER_AES_CTR_NOPADDING) {
-        status = CCCryptorCreateWithMode(kCCDecrypt, kCCModeCTR, kCCAlgorithmAES, ccNoPadding,
-                                         iv, key, key_len, 0, 0, 0, kCCModeOptionCTR_BE, &ref);
-    }
-    else {
-        status = kCCParamError;
-    }
-    if(status != kCCSuccess) {
-        result = cc_status_to_result(status);
-        goto complete;
-    }
-
-    out_buf = malloc(sizeof(uint8_t) * ciphertext_len);
-    if(!out_buf) {
-        fprintf(stderr, "cannot allocate output buffer\n");
-        result = SG_ERR_UNKNOWN;
-        goto complete;
-    }
-
-    size_t update_moved_len = 0;
-    status = CCCryptorUpdate(ref, ciphertext, ciphertext_len, out_buf, ciphertext_len, &update_moved_len);
-    if(status != kCCSuccess) {
-        result = cc_status_to_result(status);
-        goto complete;
-    }
-
-    size_t final_moved_len = 0;
-    status = CCCryptorFinal(ref, out_buf + update_moved_len, ciphertext_len - update_moved_len, &final_moved_len);
-    if(status != kCCSuccess) {
-        result = cc_status_to_result(status);
-        goto complete;
-    }
-
-    signal_buffer *output_buffer = signal_buffer_create(out_buf, update_moved_len + final_moved_len);
-    if(!output_buffer) {
-        result = SG_ERR_NOMEM;
-        goto complete;
-    }
-
-    *output = output_buffer;
-
-complete:
-    if(ref) {
-        CCCryptorRelease(ref);
-    }
-    if(out_buf) {
-        free(out_buf);
-    }
-    return result;
+    return aes_crypt(output, kCCDecrypt, cipher, key, key_len, iv, iv_len, ciphertext, ciphertext_len);
 }
+
+#endif /* SIGNAL_CRYPTO_BACKEND_COMMONCRYPTO */
@@ -0,0 +1,426 @@
+//
+//  crypto_provider_openssl.c
+//  libsignal-protocol-swift iOS
+//
+
+#include "crypto_backend.h"
+
+#if defined(SIGNAL_CRYPTO_BACKEND_OPENSSL)
+
+#include "setup.h"
+#include "random_generator.h"
+#include "context_pool.h"
+
+#include <libsignal_protocol_c/signal_protocol.h>
+
+// HMAC_CTX is deprecated by OpenSSL 3 in favour of EVP_MAC, which neither
+// BoringSSL nor LibreSSL provide. It is the one API all of them share.
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Same provider as crypto_provider.c, implemented with libcrypto so the
+// Signal layer builds off Apple platforms.
+
+int test_random_generator(uint8_t *data, size_t len, void *user_data);
+int test_hmac_sha256_init(void **hmac_context, const uint8_t *key, size_t key_len, void *user_data);
+int test_hmac_sha256_update(void *hmac_context, const uint8_t *data, size_t data_len, void *user_data);
+int test_hmac_sha256_final(void *hmac_context, signal_buffer **output, void *user_data);
+void test_hmac_sha256_cleanup(void *hmac_context, void *user_data);
+int test_sha512_digest_init(void **digest_context, void *user_data);
+int test_sha512_digest_update(void *digest_context, const uint8_t *data, size_t data_len, void *user_data);
+int test_sha512_digest_final(void *digest_context, signal_buffer **output, void *user_data);
+void test_sha512_digest_cleanup(void *digest_context, void *user_data);
+
+int test_encrypt(signal_buffer **output,
+                 int cipher,
+                 const uint8_t *key, size_t key_len,
+                 const uint8_t *iv, size_t iv_len,
+                 const uint8_t *plaintext, size_t plaintext_len,
+                 void *user_data);
+int test_decrypt(signal_buffer **output,
+                 int cipher,
+                 const uint8_t *key, size_t key_len,
+                 const uint8_t *iv, size_t iv_len,
+                 const uint8_t *ciphertext, size_t ciphertext_len,
+                 void *user_data);
+
+int setup_crypto_provider(void *context) {
+    signal_crypto_provider provider = {
+        .random_func = test_random_generator,
+        .hmac_sha256_init_func = test_hmac_sha256_init,
+        .hmac_sha256_update_func = test_hmac_sha256_update,
+        .hmac_sha256_final_func = test_hmac_sha256_final,
+        .hmac_sha256_cleanup_func = test_hmac_sha256_cleanup,
+        .sha512_digest_init_func = test_sha512_digest_init,
+        .sha512_digest_update_func = test_sha512_digest_update,
+        .sha512_digest_final_func = test_sha512_digest_final,
+        .sha512_digest_cleanup_func = test_sha512_digest_cleanup,
+        .encrypt_func = test_encrypt,
+        .decrypt_func = test_decrypt,
+        .user_data = 0
+    };
+
+    return signal_context_set_crypto_provider(context, &provider);
+}
+
+int test_random_generator(uint8_t *data, size_t len, void *user_data) {
+    if(random_generator_fill(data, len) != 0) {
+        return SG_ERR_UNKNOWN;
+    }
+    return 0;
+}
+
+static void hmac_ctx_destroy(void *object)
+{
+    HMAC_CTX_free(object);
+}
+
+static void md_ctx_destroy(void *object)
+{
+    EVP_MD_CTX_free(object);
+}
+
+// The reset functions cleanse the key and digest state before pooling
+static void hmac_ctx_release(HMAC_CTX *ctx)
+{
+    if(HMAC_CTX_reset(ctx) != 1) {
+        HMAC_CTX_free(ctx);
+        return;
+    }
+    context_pool_release(CONTEXT_POOL_HMAC_SHA256, ctx, hmac_ctx_destroy);
+}
+
+static void md_ctx_release(EVP_MD_CTX *ctx)
+{
+    if(EVP_MD_CTX_reset(ctx) != 1) {
+        EVP_MD_CTX_free(ctx);
+        return;
+    }
+    context_pool_release(CONTEXT_POOL_SHA512, ctx, md_ctx_destroy);
+}
+
+int test_hmac_sha256_init(void **hmac_context, const uint8_t *key, size_t key_len, void *user_data)
+{
+    HMAC_CTX *ctx = context_pool_acquire(CONTEXT_POOL_HMAC_SHA256);
+    if(!ctx) {
+        ctx = HMAC_CTX_new();
+    }
+    if(!ctx) {
+        return SG_ERR_NOMEM;
+    }
+
+    if(HMAC_Init_ex(ctx, key, (int) key_len, EVP_sha256(), 0) != 1) {
+        hmac_ctx_release(ctx);
+        return SG_ERR_UNKNOWN;
+    }
+    *hmac_context = ctx;
+
+    return 0;
+}
+
+int test_hmac_sha256_update(void *hmac_context, const uint8_t *data, size_t data_len, void *user_data)
+{
+    HMAC_CTX *ctx = hmac_context;
+    int result = HMAC_Update(ctx, data, data_len);
+    return (result == 1) ? SG_SUCCESS : SG_ERR_UNKNOWN;
+}
+
+int test_hmac_sha256_final(void *hmac_context, signal_buffer **output, void *user_data)
+{
+    HMAC_CTX *ctx = hmac_context;
+    unsigned int len = 0;
+
+    signal_buffer *output_buffer = signal_buffer_alloc(EVP_MD_size(EVP_sha256()));
+    if(!output_buffer) {
+        return SG_ERR_NOMEM;
+    }
+
+    if(HMAC_Final(ctx, signal_buffer_data(output_buffer), &len) != 1) {
+        signal_buffer_free(output_buffer);
+        return SG_ERR_UNKNOWN;
+    }
+
+    *output = output_buffer;
+
+    return 0;
+}
+
+void test_hmac_sha256_cleanup(void *hmac_context, void *user_data)
+{
+    if(hmac_context) {
+        HMAC_CTX *ctx = hmac_context;
+        hmac_ctx_release(ctx);
+    }
+}
+
+int test_sha512_digest_init(void **digest_context, void *user_data)
+{
+    int result = 0;
+
+    EVP_MD_CTX *ctx = context_pool_acquire(CONTEXT_POOL_SHA512);
+    if(!ctx) {
+        ctx = EVP_MD_CTX_new();
+    }
+    if(!ctx) {
+        result = SG_ERR_NOMEM;
+        goto complete;
+    }
+
+    result = EVP_DigestInit_ex(ctx, EVP_sha512(), 0);
+    if(result != 1) {
+        result = SG_ERR_UNKNOWN;
+        goto complete;
+    }
+    result = SG_SUCCESS;
+
+complete:
+    if(result < 0) {
+        if(ctx) {
+            md_ctx_release(ctx);
+        }
+    }
+    else {
+        *digest_context = ctx;
+    }
+    return result;
+}
+
+int test_sha512_digest_update(void *digest_context, const uint8_t *data, size_t data_len, void *user_data)
+{
+    EVP_MD_CTX *ctx = digest_context;
+
+    int result = EVP_DigestUpdate(ctx, data, data_len);
+
+    return (result == 1) ? SG_SUCCESS : SG_ERR_UNKNOWN;
+}
+
+int test_sha512_digest_final(void *digest_context, signal_buffer **output, void *user_data)
+{
+    int result = 0;
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    EVP_MD_CTX *ctx = digest_context;
+
+    result = EVP_DigestFinal_ex(ctx, md, &len);
+    if(result == 1) {
+        result = SG_SUCCESS;
+    }
+    else {
+        result = SG_ERR_UNKNOWN;
+        goto complete;
+    }
+
+    // libsignal keeps using the context after final, like CC_SHA512_Init
+    result = EVP_DigestInit_ex(ctx, EVP_sha512(), 0);
+    if(result == 1) {
+        result = SG_SUCCESS;
+    }
+    else {
+        result = SG_ERR_UNKNOWN;
+        goto complete;
+    }
+
+    signal_buffer *output_buffer = signal_buffer_create(md, len);
+    if(!output_buffer) {
+        result = SG_ERR_NOMEM;
+        goto complete;
+    }
+
+    *output = output_buffer;
+
+complete:
+    return result;
+}
+
+void test_sha512_digest_cleanup(void *digest_context, void *user_data)
+{
+    if(digest_context) {
+        EVP_MD_CTX *ctx = digest_context;
+        md_ctx_release(ctx);
+    }
+}
+
+static const EVP_CIPHER *aes_cipher(int cipher, size_t key_len)
+{
+    if(cipher == SG_CIPHER_AES_CBC_PKCS5) {
+        switch(key_len) {
+            case 16:
+                return EVP_aes_128_cbc();
+            case 24:
+                return EVP_aes_192_cbc();
+            case 32:
+                return EVP_aes_256_cbc();
+        }
+    }
+    else if(cipher == SG_CIPHER_AES_CTR_NOPADDING) {
+        switch(key_len) {
+            case 16:
+                return EVP_aes_128_ctr();
+            case 24:
+                return EVP_aes_192_ctr();
+            case 32:
+                return EVP_aes_256_ctr();
+        }
+    }
+    return 0;
+}
+
+// Plaintexts up to this size are decrypted on the stack before being copied
+// into the output, longer ones go through the heap
+#define AES_STACK_OUTPUT_SIZE 1024
+
+static void cipher_ctx_destroy(void *object)
+{
+    EVP_CIPHER_CTX_free(object);
+}
+
+// Runs one whole AES operation; CBC pads with PKCS#7 and CTR increments the
+// full 128-bit IV big-endian, matching kCCModeOptionCTR_BE. Cipher contexts
+// are reused through the pool and every output length but that of CBC
+// decryption is known up front, so those are written straight into the
+// output buffer.
+static int aes_crypt(signal_buffer **output,
+                     int enc,
+                     int cipher,
+                     const uint8_t *key, size_t key_len,
+                     const uint8_t *iv, size_t iv_len,
+                     const uint8_t *input, size_t input_len)
+{
+    int result = 0;
+    uint8_t stack_buf[AES_STACK_OUTPUT_SIZE];
+    uint8_t *heap_buf = 0;
+    uint8_t *out_buf = 0;
+    size_t available_len = 0;
+    signal_buffer *output_buffer = 0;
+    EVP_CIPHER_CTX *ctx = 0;
+
+    const EVP_CIPHER *evp_cipher = aes_cipher(cipher, key_len);
+    if(!evp_cipher || iv_len != 16 || input_len > INT32_MAX - 32) {
+        result = SG_ERR_INVAL;
+        goto complete;
+    }
+
+    ctx = context_pool_acquire(CONTEXT_POOL_CIPHER);
+    if(!ctx) {
+        ctx = EVP_CIPHER_CTX_new();
+    }
+    if(!ctx) {
+        result = SG_ERR_NOMEM;
+        goto complete;
+    }
+
+    if(EVP_CipherInit_ex(ctx, evp_cipher, 0, key, iv, enc) != 1) {
+        result = SG_ERR_UNKNOWN;
+        goto complete;
+    }
+
+    int decrypting_cbc = !enc && cipher == SG_CIPHER_AES_CBC_PKCS5;
+    if(cipher == SG_CIPHER_AES_CTR_NOPADDING) {
+        available_len = input_len;
+    }
+    else if(enc) {
+        available_len = (input_len / 16 + 1) * 16;
+    }
+    else {
+        // Update may hold back one block when decrypting with padding
+        available_len = input_len + 16;
+    }
+
+    if(!decrypting_cbc) {
+        output_buffer = signal_buffer_alloc(available_len);
+        if(!output_buffer) {
+            result = SG_ERR_NOMEM;
+            goto complete;
+        }
+        out_buf = signal_buffer_data(output_buffer);
+    }
+    else if(available_len <= sizeof(stack_buf)) {
+        out_buf = stack_buf;
+    }
+    else {
+        heap_buf = malloc(available_len);
+        out_buf = heap_buf;
+        if(!heap_buf) {
+            fprintf(stderr, "cannot allocate output buffer\n");
+            result = SG_ERR_NOMEM;
+            goto complete;
+        }
+    }
+
+    int update_moved_len = 0;
+    if(EVP_CipherUpdate(ctx, out_buf, &update_moved_len, input, (int) input_len) != 1) {
+        result = SG_ERR_UNKNOWN;
+        goto complete;
+    }
+
+    int final_moved_len = 0;
+    if(EVP_CipherFinal_ex(ctx, out_buf + update_moved_len, &final_moved_len) != 1) {
+        result = SG_ERR_UNKNOWN;
+        goto complete;
+    }
+
+    size_t moved_len = (size_t) update_moved_len + (size_t) final_moved_len;
+    if(!output_buffer || moved_len != available_len) {
+        signal_buffer *copy = signal_buffer_create(out_buf, moved_len);
+        if(!copy) {
+            result = SG_ERR_NOMEM;
+            goto complete;
+        }
+        if(output_buffer) {
+            signal_buffer_free(output_buffer);
+        }
+        output_buffer = copy;
+    }
+
+    *output = output_buffer;
+    output_buffer = 0;
+
+complete:
+    if(ctx) {
+        // Reset cleanses the key schedule before the context is pooled
+        if(EVP_CIPHER_CTX_reset(ctx) == 1) {
+            context_pool_release(CONTEXT_POOL_CIPHER, ctx, cipher_ctx_destroy);
+        }
+        else {
+            EVP_CIPHER_CTX_free(ctx);
+        }
+    }
+    if(out_buf == stack_buf) {
+        context_pool_wipe(stack_buf, sizeof(stack_buf));
+    }
+    if(heap_buf) {
+        context_pool_wipe(heap_buf, available_len);
+        free(heap_buf);
+    }
+    if(output_buffer) {
+        signal_buffer_free(output_buffer);
+    }
+    return result;
+}
+
+int test_encrypt(signal_buffer **output,
+                 int cipher,
+                 const uint8_t *key, size_t key_len,
+                 const uint8_t *iv, size_t iv_len,
+                 const uint8_t *plaintext, size_t plaintext_len,
+                 void *user_data)
+{
+    return aes_crypt(output, 1, cipher, key, key_len, iv, iv_len, plaintext, plaintext_len);
+}
+
+int test_decrypt(signal_buffer **output,
+                 int cipher,
+                 const uint8_t *key, size_t key_len,
+                 const uint8_t *iv, size_t iv_len,
+                 const uint8_t *ciphertext, size_t ciphertext_len,
+                 void *user_data)
+{
+    return aes_crypt(output, 0, cipher, key, key_len, iv, iv_len, ciphertext, ciphertext_len);
+}
+
+#endif /* SIGNAL_CRYPTO_BACKEND_OPENSSL */
@@ -0,0 +1,206 @@
+//
+//  random_generator.c
+//  libsignal-protocol-swift iOS
+//
+
+#include "random_generator.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <sys/random.h>
+#endif
+
+// A ChaCha20 keystream with fast key erasure: every refill produces a batch
+// of blocks, the first 32 bytes become the next key and the rest is handed
+// out. Bytes are wiped as soon as they are returned, so neither the state
+// nor the buffer reveal earlier output. Each thread owns its generator, and
+// reseeds it from the kernel after RANDOM_RESEED_BYTES or after a fork.
+
+#define RANDOM_KEY_BYTES 32
+#define RANDOM_BLOCK_BYTES 64
+#define RANDOM_BUFFER_BLOCKS 16
+#define RANDOM_BUFFER_BYTES (RANDOM_BLOCK_BYTES * RANDOM_BUFFER_BLOCKS)
+#define RANDOM_RESEED_BYTES (1024 * 1024)
+
+typedef struct {
+    uint32_t key[8];
+    uint64_t nonce;
+    uint8_t buffer[RANDOM_BUFFER_BYTES];
+    size_t available;            // unused bytes at the end of buffer
+    size_t output_since_reseed;
+    unsigned long fork_generation;
+} random_generator;
+
+static pthread_once_t random_once = PTHREAD_ONCE_INIT;
+static pthread_key_t random_key;
+static volatile unsigned long random_fork_generation = 0;
+
+static void random_wipe(void *v, size_t n) {
+    static void *(*const volatile memset_sec)(void *, int, size_t) = &memset;
+    memset_sec(v, 0, n);
+}
+
+// MARK: ChaCha20
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTERROUND(a, b, c, d) \
+    do { \
+        a += b; d ^= a; d = ROTL32(d, 16); \
+        c += d; b ^= c; b = ROTL32(b, 12); \
+        a += b; d ^= a; d = ROTL32(d, 8); \
+        c += d; b ^= c; b = ROTL32(b, 7); \
+    } while(0)
+
+static void store32_le(uint8_t *out, uint32_t v) {
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)(v >> 16);
+    out[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t load32_le(const uint8_t *in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// Block function with the original 64-bit counter and 64-bit nonce layout
+static void chacha20_block(const uint32_t key[8], uint64_t counter, uint64_t nonce, uint8_t out[RANDOM_BLOCK_BYTES]) {
+    uint32_t input[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+        key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+        (uint32_t)counter, (uint32_t)(counter >> 32), (uint32_t)nonce, (uint32_t)(nonce >> 32)
+    };
+    uint32_t x[16];
+    int i;
+
+    memcpy(x, input, sizeof(x));
+    for(i = 0; i < 10; i++) {
+        QUARTERROUND(x[0], x[4], x[8], x[12]);
+        QUARTERROUND(x[1], x[5], x[9], x[13]);
+        QUARTERROUND(x[2], x[6], x[10], x[14]);
+        QUARTERROUND(x[3], x[7], x[11], x[15]);
+        QUARTERROUND(x[0], x[5], x[10], x[15]);
+        QUARTERROUND(x[1], x[6], x[11], x[12]);
+        QUARTERROUND(x[2], x[7], x[8], x[13]);
+        QUARTERROUND(x[3], x[4], x[9], x[14]);
+    }
+    for(i = 0; i < 16; i++) {
+        store32_le(out + 4 * i, x[i] + input[i]);
+    }
+    random_wipe(x, sizeof(x));
+    random_wipe(input, sizeof(input));
+}
+
+// MARK: Generator
+
+static void random_fork_child(void) {
+    random_fork_generation++;
+}
+
+static void random_destroy(void *state) {
+    random_wipe(state, sizeof(random_generator));
+    free(state);
+}
+
+static void random_init_once(void) {
+    pthread_key_create(&random_key, random_destroy);
+    pthread_atfork(NULL, NULL, random_fork_child);
+}
+
+static int random_entropy(uint8_t *seed, size_t len) {
+    if(getentropy(seed, len) == 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    arc4random_buf(seed, len);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+// Mixes fresh kernel entropy into the key and drops any buffered output
+static int random_reseed(random_generator *generator) {
+    uint8_t seed[RANDOM_KEY_BYTES];
+    int i;
+
+    if(random_entropy(seed, sizeof(seed)) != 0) {
+        return -1;
+    }
+    for(i = 0; i < 8; i++) {
+        generator->key[i] ^= load32_le(seed + 4 * i);
+    }
+    random_wipe(seed, sizeof(seed));
+    random_wipe(generator->buffer, sizeof(generator->buffer));
+    generator->available = 0;
+    generator->output_since_reseed = 0;
+    generator->fork_generation = random_fork_generation;
+    return 0;
+}
+
+static void random_refill(random_generator *generator) {
+    int i;
+
+    for(i = 0; i < RANDOM_BUFFER_BLOCKS; i++) {
+        chacha20_block(generator->key, (uint64_t)i, generator->nonce, generator->buffer + i * RANDOM_BLOCK_BYTES);
+    }
+    generator->nonce++;
+    // Fast key erasure, the first bytes are never handed out
+    for(i = 0; i < 8; i++) {
+        generator->key[i] = load32_le(generator->buffer + 4 * i);
+    }
+    random_wipe(generator->buffer, RANDOM_KEY_BYTES);
+    generator->available = RANDOM_BUFFER_BYTES - RANDOM_KEY_BYTES;
+}
+
+static random_generator *random_thread_generator(void) {
+    random_generator *generator;
+
+    pthread_once(&random_once, random_init_once);
+    generator = pthread_getspecific(random_key);
+    if(generator) {
+        return generator;
+    }
+
+    generator = calloc(1, sizeof(random_generator));
+    if(!generator) {
+        return NULL;
+    }
+    if(random_reseed(generator) != 0 || pthread_setspecific(random_key, generator) != 0) {
+        random_destroy(generator);
+        return NULL;
+    }
+    return generator;
+}
+
+int random_generator_fill(uint8_t *data, size_t len) {
+    random_generator *generator = random_thread_generator();
+    if(!generator) {
+        return -1;
+    }
+
+    if(generator->fork_generation != random_fork_generation || generator->output_since_reseed >= RANDOM_RESEED_BYTES) {
+        if(random_reseed(generator) != 0) {
+            return -1;
+        }
+    }
+
+    while(len > 0) {
+        if(generator->available == 0) {
+            random_refill(generator);
+        }
+        size_t n = len < generator->available ? len : generator->available;
+        uint8_t *bytes = generator->buffer + RANDOM_BUFFER_BYTES - generator->available;
+        memcpy(data, bytes, n);
+        random_wipe(bytes, n);
+        generator->available -= n;
+        generator->output_since_reseed += n;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+//
+//  random_generator.h
+//  libsignal-protocol-swift iOS
+//
+
+#ifndef random_generator_h
+#define random_generator_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fills data with len cryptographically secure random bytes from a per-thread
+// ChaCha20 generator, seeded and periodically reseeded from the kernel.
+// Returns 0 on success, -1 if the kernel provides no entropy.
+int random_generator_fill(uint8_t *data, size_t len);
+
+#endif /* random_generator_h */
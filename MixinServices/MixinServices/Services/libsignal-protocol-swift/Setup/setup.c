@@ -7,13 +7,10 @@
 //
 
 #include "setup.h"
+#include "address_lock.h"
+#include "signal_log.h"
 #include <libsignal_protocol_c/signal_protocol.h>
 
-#include <pthread.h>
-
-pthread_mutex_t global_mutex;
-pthread_mutexattr_t global_mutex_attr;
-
 signal_protocol_store_context* setup_store_context(signal_context *global_context);
 int set_locking(signal_context *global_context);
 void test_log(int level, const char *message, size_t len, void *user_data);
@@ -36,13 +33,17 @@ void *signal_setup(void) {
     result = setup_crypto_provider(global_context);
     if (result != 0) {
         signal_context_destroy(global_context);
-        pthread_mutex_destroy(&global_mutex);
-        pthread_mutexattr_destroy(&global_mutex_attr);
+        address_lock_destroy();
         return 0;
     }
 
-    signal_context_set_log_function(global_context, test_log);
-    
+#if SIGNAL_LOG_MAX_LEVEL >= 0
+    // Without a log function libsignal skips formatting its messages
+    if (signal_log_start() == 0) {
+        signal_context_set_log_function(global_context, test_log);
+    }
+#endif
+
     return (void*) global_context;
 }
 
@@ -50,50 +51,31 @@ void signal_destroy(void *global_context) {
 
     signal_context_destroy((signal_context*) global_context);
 
-    pthread_mutex_destroy(&global_mutex);
-    pthread_mutexattr_destroy(&global_mutex_attr);
+    address_lock_destroy();
+
+    signal_log_stop();
 }
 
 // MARK: Locking functions
 
-void test_lock(void *user_data) {
-    pthread_mutex_lock(&global_mutex);
-}
-
-void test_unlock(void *user_data) {
-    pthread_mutex_unlock(&global_mutex);
-}
+// Calls scoped with address_lock_scope_enter only serialize with calls for
+// the same conversation, see address_lock.h
 
 int set_locking(signal_context *global_context) {
-    pthread_mutexattr_init(&global_mutex_attr);
-    pthread_mutexattr_settype(&global_mutex_attr, PTHREAD_MUTEX_RECURSIVE);
-    pthread_mutex_init(&global_mutex, &global_mutex_attr);
+    int result = address_lock_init();
+    if (result != 0) {
+        return SG_ERR_UNKNOWN;
+    }
 
-    return signal_context_set_locking_functions(global_context, test_lock, test_unlock);
+    result = signal_context_set_locking_functions(global_context, address_lock_acquire, address_lock_release);
+    if (result != 0) {
+        address_lock_destroy();
+    }
+    return result;
 }
 
+// Runs inside libsignal's lock, so it only queues the message. The drain
+// thread in signal_log.c writes it to stderr and printSignalLog.
 void test_log(int level, const char *message, size_t len, void *user_data) {
-    switch(level) {
-        case SG_LOG_ERROR:
-            fprintf(stderr, "[ERROR] %s\n", message);
-            break;
-        case SG_LOG_WARNING:
-            fprintf(stderr, "[WARNING] %s\n", message);
-            break;
-        case SG_LOG_NOTICE:
-            fprintf(stderr, "[NOTICE] %s\n", message);
-            break;
-        case SG_LOG_INFO:
-            fprintf(stderr, "[INFO] %s\n", message);
-            break;
-        case SG_LOG_DEBUG:
-            fprintf(stderr, "[DEBUG] %s\n", message);
-            break;
-        default:
-            fprintf(stderr, "[%d] %s\n", level, message);
-            break;
-    }
-    if (printSignalLog) {
-        printSignalLog(message);
-    }
+    signal_log_enqueue(level, message, len);
 }
@@ -17,4 +17,12 @@ int setup_crypto_provider(void *context);
 
 extern void (*printSignalLog)(const char *);
 
+// Drops libsignal messages above level, an SG_LOG_* value, before they are
+// queued. Pass -1 to drop all of them.
+void signal_log_set_level(int level);
+
+// Keeps only one in every rate messages of level. Defaults to 1 for all
+// levels.
+void signal_log_set_sampling(int level, unsigned int rate);
+
 #endif /* setup_h */
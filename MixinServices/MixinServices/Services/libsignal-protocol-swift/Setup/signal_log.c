@@ -0,0 +1,213 @@
+//
+//  signal_log.c
+//  libsignal-protocol-swift iOS
+//
+
+#include "signal_log.h"
+#include "setup.h"
+
+#include <libsignal_protocol_c/signal_protocol.h>
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// A bounded multi-producer queue after Dmitry Vyukov's design. Each slot
+// carries a sequence number that tells producers and the consumer whose
+// turn it is, so enqueueing is a CAS on the tail and never waits.
+#define SIGNAL_LOG_SLOTS 256
+#define SIGNAL_LOG_MESSAGE_SIZE 240
+#define SIGNAL_LOG_LEVELS 5
+
+typedef struct {
+    atomic_size_t sequence;
+    int level;
+    size_t len;
+    char message[SIGNAL_LOG_MESSAGE_SIZE];
+} signal_log_slot;
+
+static signal_log_slot slots[SIGNAL_LOG_SLOTS];
+static atomic_size_t enqueue_position;
+static size_t dequeue_position;
+static atomic_size_t dropped_count;
+
+static atomic_int runtime_level = SIGNAL_LOG_MAX_LEVEL;
+static atomic_uint sampling_rates[SIGNAL_LOG_LEVELS] = { 1, 1, 1, 1, 1 };
+static atomic_uint sampling_counters[SIGNAL_LOG_LEVELS];
+
+static pthread_t drain_thread;
+static pthread_mutex_t drain_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t drain_cond = PTHREAD_COND_INITIALIZER;
+static atomic_int wake_pending;
+static int stopping;
+static int running;
+
+void signal_log_set_level(int level) {
+    atomic_store_explicit(&runtime_level, level, memory_order_relaxed);
+}
+
+void signal_log_set_sampling(int level, unsigned int rate) {
+    if(level < 0 || level >= SIGNAL_LOG_LEVELS) {
+        return;
+    }
+    atomic_store_explicit(&sampling_rates[level], rate > 0 ? rate : 1, memory_order_relaxed);
+}
+
+static int signal_log_sampled(int level) {
+    if(level < 0 || level >= SIGNAL_LOG_LEVELS) {
+        return 1;
+    }
+    unsigned int rate = atomic_load_explicit(&sampling_rates[level], memory_order_relaxed);
+    if(rate <= 1) {
+        return 1;
+    }
+    unsigned int count = atomic_fetch_add_explicit(&sampling_counters[level], 1, memory_order_relaxed);
+    return count % rate == 0;
+}
+
+static void signal_log_wake(void) {
+    // Only the first message after a drain pays for the signal
+    if(atomic_exchange_explicit(&wake_pending, 1, memory_order_acq_rel) == 0) {
+        pthread_mutex_lock(&drain_mutex);
+        pthread_cond_signal(&drain_cond);
+        pthread_mutex_unlock(&drain_mutex);
+    }
+}
+
+void signal_log_enqueue(int level, const char *message, size_t len) {
+    if(level > SIGNAL_LOG_MAX_LEVEL || level > atomic_load_explicit(&runtime_level, memory_order_relaxed)) {
+        return;
+    }
+    if(!signal_log_sampled(level)) {
+        return;
+    }
+
+    signal_log_slot *slot;
+    size_t position = atomic_load_explicit(&enqueue_position, memory_order_relaxed);
+    for(;;) {
+        slot = &slots[position % SIGNAL_LOG_SLOTS];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+        if(difference == 0) {
+            if(atomic_compare_exchange_weak_explicit(&enqueue_position, &position, position + 1,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if(difference < 0) {
+            atomic_fetch_add_explicit(&dropped_count, 1, memory_order_relaxed);
+            return;
+        }
+        else {
+            position = atomic_load_explicit(&enqueue_position, memory_order_relaxed);
+        }
+    }
+
+    if(len >= SIGNAL_LOG_MESSAGE_SIZE) {
+        len = SIGNAL_LOG_MESSAGE_SIZE - 1;
+    }
+    memcpy(slot->message, message, len);
+    slot->message[len] = 0;
+    slot->len = len;
+    slot->level = level;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+    signal_log_wake();
+}
+
+static void signal_log_write(int level, const char *message) {
+    switch(level) {
+        case SG_LOG_ERROR:
+            fprintf(stderr, "[ERROR] %s\n", message);
+            break;
+        case SG_LOG_WARNING:
+            fprintf(stderr, "[WARNING] %s\n", message);
+            break;
+        case SG_LOG_NOTICE:
+            fprintf(stderr, "[NOTICE] %s\n", message);
+            break;
+        case SG_LOG_INFO:
+            fprintf(stderr, "[INFO] %s\n", message);
+            break;
+        case SG_LOG_DEBUG:
+            fprintf(stderr, "[DEBUG] %s\n", message);
+            break;
+        default:
+            fprintf(stderr, "[%d] %s\n", level, message);
+            break;
+    }
+    if(printSignalLog) {
+        printSignalLog(message);
+    }
+}
+
+static void signal_log_drain(void) {
+    for(;;) {
+        signal_log_slot *slot = &slots[dequeue_position % SIGNAL_LOG_SLOTS];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if(sequence != dequeue_position + 1) {
+            break;
+        }
+        signal_log_write(slot->level, slot->message);
+        atomic_store_explicit(&slot->sequence, dequeue_position + SIGNAL_LOG_SLOTS, memory_order_release);
+        dequeue_position++;
+    }
+
+    size_t dropped = atomic_exchange_explicit(&dropped_count, 0, memory_order_relaxed);
+    if(dropped > 0) {
+        char message[64];
+        snprintf(message, sizeof(message), "%zu log messages dropped", dropped);
+        signal_log_write(SG_LOG_WARNING, message);
+    }
+}
+
+static void *signal_log_run(void *arg) {
+    for(;;) {
+        pthread_mutex_lock(&drain_mutex);
+        while(!atomic_load_explicit(&wake_pending, memory_order_acquire) && !stopping) {
+            pthread_cond_wait(&drain_cond, &drain_mutex);
+        }
+        int stop = stopping;
+        atomic_store_explicit(&wake_pending, 0, memory_order_release);
+        pthread_mutex_unlock(&drain_mutex);
+
+        signal_log_drain();
+        if(stop) {
+            return 0;
+        }
+    }
+}
+
+int signal_log_start(void) {
+    size_t i;
+
+    if(running) {
+        return 0;
+    }
+    for(i = 0; i < SIGNAL_LOG_SLOTS; i++) {
+        atomic_init(&slots[i].sequence, i);
+    }
+    atomic_store(&enqueue_position, 0);
+    dequeue_position = 0;
+    stopping = 0;
+    if(pthread_create(&drain_thread, 0, signal_log_run, 0) != 0) {
+        return -1;
+    }
+    running = 1;
+    return 0;
+}
+
+// Writes out what is still queued before returning
+void signal_log_stop(void) {
+    if(!running) {
+        return;
+    }
+    pthread_mutex_lock(&drain_mutex);
+    stopping = 1;
+    pthread_cond_signal(&drain_cond);
+    pthread_mutex_unlock(&drain_mutex);
+    pthread_join(drain_thread, 0);
+    running = 0;
+}
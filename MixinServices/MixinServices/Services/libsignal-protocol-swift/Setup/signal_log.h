@@ -0,0 +1,29 @@
+//
+//  signal_log.h
+//  libsignal-protocol-swift iOS
+//
+
+#ifndef signal_log_h
+#define signal_log_h
+
+#include <stddef.h>
+
+// Logging of libsignal off the calling thread. Messages are filtered by
+// level and sampled, then copied into a lock-free ring buffer that a
+// background thread drains to stderr and printSignalLog, so log I/O never
+// runs while libsignal holds its lock.
+
+// Levels above this are compiled out, -1 compiles out logging altogether and
+// libsignal doesn't even format its messages. Levels are the SG_LOG_* values.
+#ifndef SIGNAL_LOG_MAX_LEVEL
+#define SIGNAL_LOG_MAX_LEVEL 4
+#endif
+
+int signal_log_start(void);
+void signal_log_stop(void);
+
+// Queues a message, never blocks. Returns without copying anything when
+// the level is filtered or the message is sampled out.
+void signal_log_enqueue(int level, const char *message, size_t len);
+
+#endif /* signal_log_h */
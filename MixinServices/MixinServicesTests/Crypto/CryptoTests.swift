@@ -30,4 +30,155 @@ class CryptoTests: XCTestCase {
         XCTAssertEqual(hash2, "3b79832a520ae9e1263fa5b28023e4e944a5b5920a6995a865b33306b68e788f")
     }
     
+    func testBLAKE2b() throws {
+        let abc = try XCTUnwrap(BLAKE2b.hash(data: "abc".data(using: .utf8)!, outputCount: 64))
+        XCTAssertEqual(abc.hexEncodedString(), "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d17d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923")
+        let empty = try XCTUnwrap(BLAKE2b.hash(data: Data()))
+        XCTAssertEqual(empty.hexEncodedString(), "0e5751c026e543b2e8ab2eb06099daa1d1e5df47778f7787faab45cdf12fe3a8")
+        
+        let message = Data((0..<200).map(UInt8.init))
+        let key = "key".data(using: .utf8)!
+        let keyed = try XCTUnwrap(BLAKE2b.hash(data: message, key: key))
+        XCTAssertEqual(keyed.hexEncodedString(), "74c17649877afba956436013ede019258e11b85fee801ad08f2da78527901663")
+        var hasher = try XCTUnwrap(BLAKE2b.Hasher(outputCount: 32, key: key))
+        hasher.update(data: message[0..<100])
+        hasher.update(data: message[100...])
+        XCTAssertEqual(hasher.finalize(), keyed)
+        
+        XCTAssertNil(BLAKE2b.hash(data: message, outputCount: 65))
+        XCTAssertNil(BLAKE2b.hash(data: message, key: Data(count: 65)))
+    }
+    
+    func testConstantTimeBase64() throws {
+        for count in [0, 1, 2, 3, 32, 47, 48, 49, 64, 65, 200, 1000] {
+            let data = Data(withNumberOfSecuredRandomBytes: count) ?? Data()
+            let standard = ConstantTimeBase64.encode(data)
+            XCTAssertEqual(standard, data.base64EncodedString())
+            XCTAssertEqual(ConstantTimeBase64.decode(standard), data)
+            let url = ConstantTimeBase64.encode(data, variant: .urlUnpadded)
+            XCTAssertEqual(url, data.base64RawURLEncodedString())
+            XCTAssertEqual(ConstantTimeBase64.decode(url, variant: .urlUnpadded), data)
+        }
+        XCTAssertNil(ConstantTimeBase64.decode("QQ"))
+        XCTAssertNil(ConstantTimeBase64.decode("QQ==$"))
+        XCTAssertNil(ConstantTimeBase64.decode("QR", variant: .standardUnpadded))
+        XCTAssertNil(ConstantTimeBase64.decode("-_8=", variant: .standard))
+        XCTAssertEqual(ConstantTimeBase64.decode("-_8=", variant: .url), Data([0xfb, 0xff]))
+        
+        let encoded = "$argon2i$v=19$m=65536,t=2,p=1$c29tZXNhbHQ$wWKIMhR9lyDFvRz9YTZweHKfbftvj+qf+YFY4NeBbtA"
+        XCTAssertEqual(argon2_verify(encoded, "password", 8, Argon2_i), ARGON2_OK.rawValue)
+        XCTAssertEqual(argon2_verify(encoded, "passwore", 8, Argon2_i), ARGON2_VERIFY_MISMATCH.rawValue)
+    }
+    
+    func testArgon2iImplementations() throws {
+        defer {
+            argon2_select_impl(Argon2_impl_auto)
+        }
+        let password = "password".data(using: .utf8)!
+        let salt = "somesaltsomesalt".data(using: .utf8)!
+        let impls = [Argon2_impl_ref, Argon2_impl_sse2, Argon2_impl_avx2, Argon2_impl_neon]
+        for impl in impls where argon2_impl_supported(impl) != 0 {
+            XCTAssertEqual(argon2_select_impl(impl), ARGON2_OK.rawValue)
+            let hash = try Argon2.hash(.i, password: password, salt: salt)
+            XCTAssertEqual(hash.hexEncodedString(), "d4b5548e1b1e34b02d6bc9fcd9fbb4340f18f5d863c7d28002028472e808e3e4")
+        }
+    }
+    
+    func testArgon2id() throws {
+        let password = "password".data(using: .utf8)!
+        let hash = try Argon2.hash(.id, password: password, salt: "somesaltsomesalt".data(using: .utf8)!)
+        XCTAssertEqual(hash.hexEncodedString(), "0334a9cf4d24036dbe26e2bc1090883071e484b316759a43254f340b0280dba9")
+        let reference = try Argon2.hash(.id, timeCost: 2, memoryCost: 1 << 16, parallelism: 1, password: password, salt: "somesalt".data(using: .utf8)!)
+        XCTAssertEqual(reference.hexEncodedString(), "09316115d5cf24ed5a15a31a3ba326e5cf32edc24702987c02b6566f61913cf7")
+    }
+    
+    func testArgon2iBatch() throws {
+        let inputs = [
+            (password: "password".data(using: .utf8)!, salt: "somesaltsomesalt".data(using: .utf8)!),
+            (password: "123456".data(using: .utf8)!, salt: Data(repeating: 0x2a, count: 32)),
+            (password: Data(repeating: 0x01, count: 32), salt: "anothersaltsalt!".data(using: .utf8)!),
+        ]
+        let hashes = try Argon2.hash(.i, batch: inputs)
+        XCTAssertEqual(hashes.count, inputs.count)
+        XCTAssertEqual(hashes[0].hexEncodedString(), "d4b5548e1b1e34b02d6bc9fcd9fbb4340f18f5d863c7d28002028472e808e3e4")
+        for (input, hash) in zip(inputs, hashes) {
+            XCTAssertEqual(hash, try Argon2.hash(.i, password: input.password, salt: input.salt))
+        }
+    }
+    
+    func testArgon2iArena() throws {
+        let password = "password".data(using: .utf8)!
+        let salt = "somesaltsomesalt".data(using: .utf8)!
+        let arena = try XCTUnwrap(Argon2.Arena(memoryCost: 1024, lanes: 2))
+        for _ in 0..<3 {
+            let hash = try Argon2.hash(.i, password: password, salt: salt, arena: arena)
+            XCTAssertEqual(hash.hexEncodedString(), "d4b5548e1b1e34b02d6bc9fcd9fbb4340f18f5d863c7d28002028472e808e3e4")
+        }
+        let allocated = try Argon2.hash(.i, password: password, salt: salt, arena: nil)
+        XCTAssertEqual(allocated.hexEncodedString(), "d4b5548e1b1e34b02d6bc9fcd9fbb4340f18f5d863c7d28002028472e808e3e4")
+        // Falls back to allocation when the arena is too small
+        let hashes = try Argon2.hash(.i, batch: [(password, salt), (password, salt)], arena: arena)
+        XCTAssertEqual(hashes[0], allocated)
+        XCTAssertEqual(hashes[1], allocated)
+    }
+
+    func testArgon2ConcurrentHashes() throws {
+        let password = "password".data(using: .utf8)!
+        let salt = "somesaltsomesalt".data(using: .utf8)!
+        let lock = NSLock()
+        var hashes = [Data]()
+        // Batches of all hashes share the worker pool
+        DispatchQueue.concurrentPerform(iterations: 8) { _ in
+            if let hash = try? Argon2.hash(.i, password: password, salt: salt) {
+                lock.lock()
+                hashes.append(hash)
+                lock.unlock()
+            }
+        }
+        XCTAssertEqual(hashes.count, 8)
+        XCTAssertTrue(hashes.allSatisfy { $0.hexEncodedString() == "d4b5548e1b1e34b02d6bc9fcd9fbb4340f18f5d863c7d28002028472e808e3e4" })
+    }
+
+    func testArgon2Cancellation() throws {
+        let password = "password".data(using: .utf8)!
+        let salt = "somesaltsomesalt".data(using: .utf8)!
+        var reports: [Argon2.Progress] = []
+        let hash = try Argon2.hash(.i, password: password, salt: salt) { progress in
+            reports.append(progress)
+        }
+        XCTAssertEqual(hash.hexEncodedString(), "d4b5548e1b1e34b02d6bc9fcd9fbb4340f18f5d863c7d28002028472e808e3e4")
+        XCTAssertEqual(reports.map(\.pass), [0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3])
+        XCTAssertEqual(reports.map(\.slice), [0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3])
+        XCTAssertEqual(reports.last?.fractionCompleted, 1)
+        
+        let cancellation = Argon2.Cancellation()
+        var slices = 0
+        XCTAssertThrowsError(try Argon2.hash(.i, password: password, salt: salt, cancellation: cancellation) { progress in
+            slices += 1
+            if progress.pass == 1 {
+                cancellation.cancel()
+            }
+        }) { error in
+            XCTAssertTrue((error as? Argon2.Error)?.isCanceled ?? false)
+        }
+        XCTAssertEqual(slices, 5)
+    }
+    
+    func testArgon2TaskCancellation() async throws {
+        let password = "password".data(using: .utf8)!
+        let salt = "somesaltsomesalt".data(using: .utf8)!
+        let task = Task {
+            try await Argon2.Cancellation.withCurrentTask { cancellation in
+                try Argon2.hash(.i, password: password, salt: salt, cancellation: cancellation)
+            }
+        }
+        task.cancel()
+        do {
+            _ = try await task.value
+            XCTFail("Hashing should be canceled with the task")
+        } catch {
+            XCTAssertTrue((error as? Argon2.Error)?.isCanceled ?? false)
+        }
+    }
+    
 }
@@ -318,4 +318,123 @@ class SignalTests: XCTestCase {
         XCTAssertTrue(isKeyGroupEqual(kg3, kg4))
     }
     
+    func testPreKeyGeneration() throws {
+        let keys = try Signal.generatePreKeys(start: 1, count: 100)
+        XCTAssertEqual(keys.count, 100)
+        XCTAssertEqual(Set(keys.map(\.keyPair.privateKey)).count, keys.count)
+        XCTAssertEqual(Set(keys.map(\.keyPair.publicKey)).count, keys.count)
+        
+        let otherThreadKeys = try DispatchQueue.global().sync {
+            try Signal.generatePreKeys(start: 101, count: 100)
+        }
+        let privateKeys = Set(keys.map(\.keyPair.privateKey))
+        XCTAssertTrue(otherThreadKeys.allSatisfy { !privateKeys.contains($0.keyPair.privateKey) })
+    }
+    
+    func testStoreCache() throws {
+        let cache = SignalStoreCache.shared
+        let address = SignalAddress(name: UUID().uuidString.lowercased(), deviceId: 1)
+        
+        XCTAssertNil(cache.session(for: address))
+        cache.store(session: Data([0x01, 0x02]), for: address)
+        XCTAssertEqual(cache.session(for: address), Data([0x01, 0x02]))
+        XCTAssertFalse(SessionDAO.shared.sessionExists(address: address.name, device: address.deviceId))
+        XCTAssertTrue(cache.commit())
+        XCTAssertEqual(SessionDAO.shared.getSession(address: address.name, device: address.deviceId)?.record, Data([0x01, 0x02]))
+        XCTAssertTrue(cache.deleteSession(for: address))
+        XCTAssertNil(cache.session(for: address))
+        XCTAssertFalse(SessionDAO.shared.sessionExists(address: address.name, device: address.deviceId))
+        
+        let publicKey = Data([0x03, 0x04])
+        XCTAssertTrue(cache.save(identity: publicKey, for: address.name))
+        XCTAssertTrue(cache.commit())
+        let identity: Identity? = IdentityDAO.shared.db.select(where: Identity.column(of: .address) == address.name)
+        XCTAssertEqual(identity?.publicKey, publicKey)
+        
+        XCTAssertTrue(cache.store(preKeys: [PreKey(preKeyId: 7, record: Data([0x05]))]))
+        XCTAssertEqual(cache.preKey(with: 7), Data([0x05]))
+        XCTAssertTrue(cache.removePreKey(with: 7))
+        XCTAssertNil(cache.preKey(with: 7))
+        XCTAssertNotNil(PreKeyDAO.shared.getPreKey(with: 7))
+        XCTAssertTrue(cache.commit())
+        XCTAssertNil(PreKeyDAO.shared.getPreKey(with: 7))
+        
+        let other = SignalAddress(name: UUID().uuidString.lowercased(), deviceId: 1)
+        cache.store(session: Data([0x06]), for: other)
+        SignalDatabase.reloadCurrent(with: try SignalDatabase(url: url))
+        XCTAssertNil(cache.session(for: other))
+    }
+    
+    // Decrypts the same number of messages with and without SignalStoreCache,
+    // the cached run must end with the same committed session and be faster
+    func testDecryptLatencyWithStoreCache() throws {
+        let messageCount = 500
+        
+        // Both ends of the sessions live in this one store and only differ in address
+        let identityKeyPair = try Signal.generateIdentityKeyPair()
+        let registrationId = try Signal.generateRegistrationId()
+        let identity = Identity(address: "-1",
+                                registrationId: Int(registrationId),
+                                publicKey: identityKeyPair.publicKey,
+                                privateKey: identityKeyPair.privateKey,
+                                nextPreKeyId: nil,
+                                timestamp: Date().timeIntervalSince1970)
+        XCTAssertTrue(IdentityDAO.shared.db.save(identity))
+        let timestamp = UInt64(Date().timeIntervalSince1970 * 1000)
+        let signedPreKey = try Signal.generate(signedPreKey: 1, identity: identityKeyPair, timestamp: timestamp)
+        XCTAssertTrue(MixinSignedPreKeyStore().store(signedPreKey: try signedPreKey.data(), for: signedPreKey.id))
+        let preKeys = try Signal.generatePreKeys(start: 1, count: 2)
+        XCTAssertTrue(MixinPreKeyStore().store(preKeys: try preKeys.map { PreKey(preKeyId: Int($0.id), record: try $0.data()) }))
+        let store = try SignalStore(identityKeyStore: MixinIdentityKeyStore(),
+                                    preKeyStore: MixinPreKeyStore(),
+                                    sessionStore: MixinSessionStore(),
+                                    signedPreKeyStore: MixinSignedPreKeyStore(),
+                                    senderKeyStore: MixinSenderKeyStore())
+        
+        func averageDecryptionLatency(preKey: SessionPreKey) throws -> TimeInterval {
+            let sender = SignalAddress(name: UUID().uuidString.lowercased(), deviceId: 1)
+            let recipient = SignalAddress(name: UUID().uuidString.lowercased(), deviceId: 1)
+            let bundle = SessionPreKeyBundle(registrationId: registrationId,
+                                             deviceId: 1,
+                                             preKeyId: preKey.id,
+                                             preKey: preKey.keyPair.publicKey,
+                                             signedPreKeyId: signedPreKey.id,
+                                             signedPreKey: signedPreKey.keyPair.publicKey,
+                                             signature: signedPreKey.signature,
+                                             identityKey: identityKeyPair.publicKey)
+            try SessionBuilder(for: recipient, in: store).process(preKeyBundle: bundle)
+            let encryptingCipher = SessionCipher(for: recipient, in: store)
+            let plain = Data(repeating: 0x61, count: 256)
+            let messages = try (0..<messageCount).map { _ in
+                try encryptingCipher.encrypt(plain)
+            }
+            XCTAssertTrue(SignalStoreCache.shared.commit())
+            
+            // One perform around every message like SignalProtocol.decrypt
+            let decryptingCipher = SessionCipher(for: sender, in: store)
+            let start = CFAbsoluteTimeGetCurrent()
+            for message in messages {
+                let decrypted = try SignalStoreCache.shared.perform {
+                    try decryptingCipher.decrypt(message: message)
+                }
+                XCTAssertEqual(decrypted, plain)
+            }
+            let latency = (CFAbsoluteTimeGetCurrent() - start) / Double(messageCount)
+            
+            let committed = SessionDAO.shared.getSession(address: sender.name, device: sender.deviceId)?.record
+            XCTAssertNotNil(committed)
+            XCTAssertEqual(SignalStoreCache.shared.session(for: sender), committed)
+            return latency
+        }
+        
+        SignalStoreCache.shared.isEnabled = false
+        defer {
+            SignalStoreCache.shared.isEnabled = true
+        }
+        let uncached = try averageDecryptionLatency(preKey: preKeys[0])
+        SignalStoreCache.shared.isEnabled = true
+        let cached = try averageDecryptionLatency(preKey: preKeys[1])
+        XCTAssertLessThan(cached, uncached, "Decryption latency without cache: \(uncached * 1000)ms, with cache: \(cached * 1000)ms")
+    }
+
 }
@@ -0,0 +1,92 @@
+import XCTest
+import UIKit
+@testable import MixinServices
+
+class MarkdownTests: XCTestCase {
+    
+    private struct Snippet: MarkdownControlCodeRemovable {
+        let contentBeforeRemovingMarkdownControlCode: String?
+        let isPostContent = true
+    }
+    
+    func testPlainTextOfTabIndentedCode() {
+        // Tabs of the indentation are expanded, 7 bytes of markdown make 16 bytes of text
+        let markdown = "\t\t\t\tabc"
+        let expected = String(repeating: " ", count: 12) + "abc\n"
+        XCTAssertEqual(MarkdownConverter.plainText(from: markdown), expected)
+        XCTAssertEqual(MarkdownConverter.plainText(from: "\tabc\n\t\tdef"), "abc\n    def\n")
+    }
+    
+    func testRenderedPlainTextOfTabIndentedCode() {
+        let markdown = "\t\t\t\tabc"
+        let rendering = MarkdownConverter.render(from: markdown,
+                                                 outputs: [.html, .plainText],
+                                                 richFormat: false,
+                                                 maxNumberOfCharacters: .max,
+                                                 maxNumberOfLines: .max)
+        XCTAssertEqual(rendering.plainText, MarkdownConverter.plainText(from: markdown))
+    }
+    
+    func testSnippetCutsOnCharacters() {
+        func snippet(of content: String) -> String {
+            Snippet(contentBeforeRemovingMarkdownControlCode: content).makeMarkdownControlCodeRemovedContent()
+        }
+        let family = "👨‍👩‍👧‍👦"
+        XCTAssertEqual(snippet(of: String(repeating: family, count: 100)),
+                       String(repeating: family, count: 60) + "...")
+        XCTAssertEqual(snippet(of: String(repeating: "🇯🇵", count: 60)),
+                       String(repeating: "🇯🇵", count: 60))
+        // One character longer than what the renderer is asked for
+        XCTAssertEqual(snippet(of: "a" + String(repeating: "\u{301}", count: 2000)), "...")
+        XCTAssertEqual(snippet(of: "\u{3000}\n \u{a0}**Title**\nbody"), "Title")
+    }
+    
+    func testLayoutMeasuresImagesAsBoundingRect() {
+        // Post previews were sized with boundingRect, which keeps placeholders at 900x338
+        let markdown = "# Title\n\n![](https://example.com/a.png)\n\nbody"
+        let string = MarkdownConverter.attributedString(from: markdown,
+                                                        maxNumberOfCharacters: 120,
+                                                        maxNumberOfLines: 6)
+        let width: CGFloat = 280
+        let boundingRect = string.boundingRect(with: CGSize(width: width, height: .greatestFiniteMagnitude),
+                                               options: [.usesLineFragmentOrigin, .usesFontLeading],
+                                               context: nil)
+        let layout = MarkdownConverter.layout(of: string,
+                                              contentHash: UInt(bitPattern: markdown.hashValue),
+                                              width: width,
+                                              maxHeight: .greatestFiniteMagnitude)
+        XCTAssertGreaterThan(layout.size.height, 338)
+        XCTAssertEqual(layout.size.height, ceil(boundingRect.height), accuracy: 1)
+    }
+    
+    func testLayoutJoinsPreparation() {
+        let markdown = String(repeating: "Lorem ipsum dolor sit amet\n\n", count: 10)
+        let string = MarkdownConverter.attributedString(from: markdown,
+                                                        maxNumberOfCharacters: 120,
+                                                        maxNumberOfLines: 6)
+        let hash = UInt(bitPattern: markdown.hashValue)
+        MarkdownConverter.prepareLayout(of: string, contentHash: hash, width: 280, maxHeight: 210, completion: nil)
+        let layout = MarkdownConverter.layout(of: string, contentHash: hash, width: 280, maxHeight: 210)
+        XCTAssertTrue(layout === MarkdownConverter.cachedLayout(contentHash: hash, width: 280, maxHeight: 210))
+    }
+    
+    func testRenderingReturnsImagesWithOwnPlaceholders() {
+        let markdown = "![](https://example.com/a.png)\n\n![](https://example.com/b.png)"
+        let rendering = MarkdownConverter.render(from: markdown,
+                                                 outputs: [.html, .attributedString],
+                                                 richFormat: false,
+                                                 maxNumberOfCharacters: 120,
+                                                 maxNumberOfLines: 6)
+        let images = rendering.images ?? []
+        XCTAssertEqual(images.map(\.source), ["https://example.com/a.png", "https://example.com/b.png"])
+        guard let string = rendering.attributedString, images.count == 2 else {
+            return
+        }
+        let attachments = images.compactMap { image in
+            string.attribute(.attachment, at: image.location, effectiveRange: nil) as? MXSMarkdownImageAttachment
+        }
+        XCTAssertEqual(attachments.count, 2)
+        XCTAssertFalse(attachments[0] === attachments[1])
+    }
+    
+}
@@ -0,0 +1,120 @@
+import XCTest
+@testable import MixinServices
+
+class AddressLockTests: XCTestCase {
+
+    private let groupId = "2d1d8f6e-0c3a-4b0c-9d1c-9a3f2b7c6e41"
+    private let iterations = 20000
+
+    private var isInside = false
+    private var overlaps = 0
+
+    override func setUp() {
+        super.setUp()
+        _ = Signal.context // Sets up address_lock
+    }
+
+    // A SIGNAL_KEY message processes the sender key after decrypting with the 1:1
+    // session, while group messages from the same sender use the sender key directly
+    func testSenderKeyThroughSessionAndGroupPaths() {
+        let sender = SignalAddress(name: "a1ce5b8e-6f7d-4d2b-8f3e-0b6c1d9e2f47", deviceId: 1)
+        let senderKeyName = SignalSenderKeyName(groupId: groupId, sender: sender)
+        runConcurrently(
+            {
+                Signal.withLock(on: sender) {
+                    self.callIntoLibsignal { }
+                }
+                Signal.withLock(on: senderKeyName) {
+                    self.callIntoLibsignal(self.useSenderKey)
+                }
+            },
+            {
+                Signal.withLock(on: senderKeyName) {
+                    self.callIntoLibsignal(self.useSenderKey)
+                }
+            }
+        )
+        XCTAssertEqual(overlaps, 0)
+    }
+
+    // Scopes nested the other way round on another thread, e.g. a sender key
+    // processed from inside a session call while the group path calls into the
+    // session. Either order has to finish.
+    func testNestingInOppositeOrders() {
+        let (sender, senderKeyName) = senderInAnotherShard()
+        runConcurrently(
+            {
+                Signal.withLock(on: sender) {
+                    self.callIntoLibsignal {
+                        Signal.withLock(on: senderKeyName) {
+                            self.callIntoLibsignal(self.useSenderKey)
+                        }
+                    }
+                }
+            },
+            {
+                Signal.withLock(on: senderKeyName) {
+                    self.callIntoLibsignal {
+                        self.useSenderKey()
+                        Signal.withLock(on: sender) {
+                            self.callIntoLibsignal { }
+                        }
+                    }
+                }
+            }
+        )
+        XCTAssertEqual(overlaps, 0)
+    }
+
+    // What libsignal does around every session and group call
+    private func callIntoLibsignal(_ body: () -> Void) {
+        address_lock_acquire(nil)
+        body()
+        address_lock_release(nil)
+    }
+
+    private func useSenderKey() {
+        if isInside {
+            overlaps += 1
+        }
+        isInside = true
+        usleep(1)
+        isInside = false
+    }
+
+    private func runConcurrently(_ bodies: () -> Void...) {
+        DispatchQueue.concurrentPerform(iterations: bodies.count) { index in
+            for _ in 0..<iterations {
+                bodies[index]()
+            }
+        }
+    }
+
+    // A sender whose sender key is in another shard than its session, so the
+    // two scopes take different locks
+    private func senderInAnotherShard() -> (SignalAddress, SignalSenderKeyName) {
+        func shard(of body: () -> Void) -> Int32 {
+            body()
+            defer { address_lock_scope_leave(-1) }
+            return address_lock_scope_enter(nil, 0, "", 0, 0)
+        }
+        var deviceId: Int32 = 1
+        while true {
+            let sender = SignalAddress(name: "a1ce5b8e-6f7d-4d2b-8f3e-0b6c1d9e2f47", deviceId: deviceId)
+            let senderKeyName = SignalSenderKeyName(groupId: groupId, sender: sender)
+            let sessionShard = shard {
+                let pointee = sender.signalAddress.pointee
+                _ = address_lock_scope_enter(nil, 0, pointee.name, pointee.name_len, pointee.device_id)
+            }
+            let senderKeyShard = shard {
+                let pointee = senderKeyName.pointer.pointee
+                _ = address_lock_scope_enter(pointee.group_id, pointee.group_id_len, pointee.sender.name, pointee.sender.name_len, pointee.sender.device_id)
+            }
+            if senderKeyShard != sessionShard {
+                return (sender, senderKeyName)
+            }
+            deviceId += 1
+        }
+    }
+
+}